@@ -0,0 +1,507 @@
+#include "Simulation.h"
+#include "VehicleKernels.h"
+#include "ThreadPlacement.h"
+#include "BoundedQueue.h"
+#include "IntrusiveQueue.h"
+#include "ThreadSafeQueue.h"
+#include "MemoryTracking.h"
+#include "OutOfCoreFleet.h"
+#include "SimulationContext.h"
+#include "Tracing.h"
+#include "CohortSimulation.h"
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <cstdio>
+#include <algorithm>
+#include <string>
+#include <unistd.h>
+
+// ------------------------------------------
+// Shared helpers
+// ------------------------------------------
+using BenchClock = std::chrono::steady_clock;
+
+static double elapsedMs(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+/** @brief Per-process scratch file under /tmp, unlinked on construction and destruction. */
+struct TempPath {
+    std::string path;   ///< /tmp/vehicle_sim_bench_<pid>_<name>
+    explicit TempPath(const std::string& name)
+        : path("/tmp/vehicle_sim_bench_" + std::to_string(::getpid()) + "_" + name) { ::unlink(path.c_str()); }
+    ~TempPath() { ::unlink(path.c_str()); }
+    TempPath(const TempPath&) = delete;
+    TempPath& operator=(const TempPath&) = delete;
+};
+
+// ------------------------------------------
+// Worker placement benchmark: runner ticks over a large fleet on cpu0, with
+// the fleet first-touched on another NUMA node vs on cpu0's own node.
+// ------------------------------------------
+class PlacementBench {
+public:
+    /** @return A CPU on a different known NUMA node than @p cpu, or -1 on a single-node host. */
+    static int cpuOnOtherNode(int cpu) {
+        const int home = numaNodeOfCpu(cpu);
+        if (home < 0) return -1;
+        const int cpus = static_cast<int>(std::thread::hardware_concurrency());
+        for (int c = 0; c < cpus; ++c) {
+            const int node = numaNodeOfCpu(c);
+            if (node >= 0 && node != home) return c;
+        }
+        return -1;
+    }
+
+    /**
+     * @brief Deploys the fleet from a thread on @p allocCpu, then runs it from a thread on @p runCpu.
+     *
+     * Negative CPU ids leave that thread unpinned. @p pinned reports whether the runner's affinity applied.
+     */
+    static double runTicks(int allocCpu, int runCpu, int fleetSize, int ticks, bool& pinned) {
+        std::vector<std::unique_ptr<Vehicle>> fleet;
+        std::thread([&] {
+            pinCurrentThread(allocCpu);
+            // construction first-touches every vehicle, placing the fleet on this thread's node
+            VehicleRandomDeployment deploy(fleetSize);
+            fleet = deploy.deployVehicles();
+        }).join();
+
+        double ms = 0;
+        std::thread worker([&] {
+            pinned = pinCurrentThread(runCpu);
+            KindBatches batches;
+            for (auto& v : fleet) batches[static_cast<size_t>(v->getKind())].push_back(v.get());
+
+            auto start = BenchClock::now();
+            for (int t = 0; t < ticks; ++t) runKindBatches(batches);
+            ms = elapsedMs(start);
+        });
+        worker.join();
+        return ms;
+    }
+
+    static void run() {
+        const int fleetSize = 200000;
+        const int ticks = 200;
+        std::cout << "[BENCH] Worker placement (" << fleetSize << " vehicles x " << ticks << " ticks)" << std::endl;
+
+        bool canPin = false;
+        const int remoteCpu = cpuOnOtherNode(0);
+        if (remoteCpu < 0) {
+            // no remote node to place the fleet on: only scheduling differs between the runs
+            double unpinned = runTicks(-1, -1, fleetSize, ticks, canPin);
+            double pinned = runTicks(0, 0, fleetSize, ticks, canPin);
+            std::cout << "  single NUMA node host: no remote fleet layout to measure\n"
+                      << "  unpinned: " << unpinned << " ms\n"
+                      << "  pinned cpu0 (node " << numaNodeOfCpu(0) << "): " << pinned << " ms"
+                      << (canPin ? "" : " (affinity unsupported, no-op)") << "\n"
+                      << "  speedup: " << unpinned / pinned << "x\n";
+            return;
+        }
+
+        double remote = runTicks(remoteCpu, 0, fleetSize, ticks, canPin);
+        double local = runTicks(0, 0, fleetSize, ticks, canPin);
+        std::cout << "  fleet on node " << numaNodeOfCpu(remoteCpu) << " (cpu" << remoteCpu << "), runner cpu0: "
+                  << remote << " ms\n"
+                  << "  fleet on node " << numaNodeOfCpu(0) << " (cpu0), runner cpu0: " << local << " ms"
+                  << (canPin ? "" : " (affinity unsupported, no-op)") << "\n"
+                  << "  speedup: " << remote / local << "x\n";
+    }
+};
+
+// ------------------------------------------
+// Energy model benchmark: per-tick runner cost of the constant-rate model
+// (flat table) vs the speed/load tables, same kind and fleet size.
+// ------------------------------------------
+class EnergyKernelBench {
+public:
+    struct Fleet {
+        std::vector<std::unique_ptr<Vehicle>> vehicles;
+        std::vector<Vehicle*> batch;
+    };
+
+    static Fleet makeFleet(int fleetSize, bool flat) {
+        BravoFactory factory;
+        Fleet fleet;
+        for (int i = 0; i < fleetSize; ++i) {
+            fleet.vehicles.push_back(factory.createVehicle());
+            if (flat) fleet.vehicles.back()->setEnergyTable(EnergyTable::flat());
+            else fleet.vehicles.back()->setLoad(i % (specFor(VehicleKind::Bravo).passengers + 1));
+            fleet.batch.push_back(fleet.vehicles.back().get());
+        }
+        return fleet;
+    }
+
+    static double runTicks(const Fleet& fleet, int ticks) {
+        auto start = BenchClock::now();
+        for (int t = 0; t < ticks; ++t) TickKernel<VehicleKind::Bravo>::runBatch(fleet.batch);
+        return elapsedMs(start);
+    }
+
+    static void run() {
+        const int fleetSize = 200000;
+        const int ticks = 200;
+        std::cout << "[BENCH] Energy tables (" << fleetSize << " vehicles x " << ticks << " ticks)" << std::endl;
+
+        // both fleets stay allocated so neither reuses the other's freed memory
+        Fleet flatFleet = makeFleet(fleetSize, true);
+        Fleet tableFleet = makeFleet(fleetSize, false);
+        double flat = runTicks(flatFleet, ticks);
+        double tables = runTicks(tableFleet, ticks);
+        const double vehicleTicks = static_cast<double>(fleetSize) * ticks;
+        std::cout << "  constant rate: " << flat << " ms (" << flat * 1e6 / vehicleTicks << " ns/vehicle-tick)\n"
+                  << "  speed/load tables: " << tables << " ms (" << tables * 1e6 / vehicleTicks << " ns/vehicle-tick)\n";
+    }
+};
+
+// ------------------------------------------
+// Dispatch benchmark: a whole fleet depletes at once and every vehicle finds
+// a free station; per-vehicle hand-off vs one batch per dispatch.
+// ------------------------------------------
+class DispatchBench {
+public:
+    using Queue = BoundedQueue<Vehicle*>;
+
+    static double perVehicle(Queue& needCharge, Queue& charge, ChargeStationManager& stations) {
+        auto start = BenchClock::now();
+        while (stations.tryAcquire()) {
+            auto opt = needCharge.tryPop();
+            if (!opt) {
+                stations.release();
+                break;
+            }
+            VehicleStatsManager::getInstance().record((*opt)->getType(), **opt, StatType::TotalChargeCycle);
+            charge.push(*opt);
+        }
+        return elapsedMs(start);
+    }
+
+    static double batched(Queue& needCharge, Queue& charge, ChargeStationManager& stations,
+                          std::vector<Vehicle*>& batch, KindBatches& byKind) {
+        auto start = BenchClock::now();
+        const int got = stations.tryAcquireUpTo(static_cast<int>(needCharge.approxSize()));
+        batch.clear();
+        stations.release(got - static_cast<int>(needCharge.tryPopBatch(batch, got)));
+        for (Vehicle* v : batch) byKind[static_cast<size_t>(v->getKind())].push_back(v);
+        for (size_t k = 0; k < byKind.size(); ++k) {
+            if (byKind[k].empty()) continue;
+            if (static_cast<VehicleKind>(k) == VehicleKind::Custom) VehicleStatsManager::getInstance().recordBatch(byKind[k], StatType::TotalChargeCycle);
+            else VehicleStatsManager::getInstance().recordBatch(byKind[k].front()->getType(), byKind[k], StatType::TotalChargeCycle);
+        }
+        charge.pushBatch(batch);
+        return elapsedMs(start);
+    }
+
+    static void run() {
+        const int fleetSize = 100000;
+        std::cout << "[BENCH] Charge dispatch (" << fleetSize << " vehicles depleted together)" << std::endl;
+
+        VehicleRandomDeployment deploy(fleetSize);
+        auto owned = deploy.deployVehicles();
+        std::vector<Vehicle*> fleet;
+        for (auto& v : owned) fleet.push_back(v.get());
+
+        Queue needCharge(fleet.size()), charge(fleet.size());
+        std::vector<Vehicle*> batch;
+        KindBatches byKind;
+        batch.reserve(fleet.size());
+        for (auto& group : byKind) group.reserve(fleet.size());
+
+        auto refill = [&] {
+            charge.clear();
+            for (Vehicle* v : fleet) needCharge.push(v);
+        };
+
+        ChargeStationManager single(fleetSize);
+        refill();
+        double one = perVehicle(needCharge, charge, single);
+        ChargeStationManager pooled(fleetSize);
+        refill();
+        double many = batched(needCharge, charge, pooled, batch, byKind);
+
+        std::cout << "  per vehicle: " << one << " ms (" << one * 1e6 / fleetSize << " ns/charge)\n"
+                  << "  batched: " << many << " ms (" << many * 1e6 / fleetSize << " ns/charge)\n"
+                  << "  speedup: " << one / many << "x\n";
+    }
+};
+
+// ------------------------------------------
+// Stage queue benchmark: vehicles cycle run -> need-charge -> charge -> run
+// through a deque-backed queue, a preallocated ring and an intrusive list,
+// on one thread and handed off between two.
+// ------------------------------------------
+class IntrusiveQueueBench {
+public:
+    using DequeQueue = ThreadSafeQueue<Vehicle*, TrackingAllocator<Vehicle*>>;
+    using RingQueue = BoundedQueue<Vehicle*>;
+    using LinkedQueue = IntrusiveQueue<Vehicle, &Vehicle::queueLink>;
+
+    static Vehicle* popOne(DequeQueue& q) { auto v = q.tryPop(); return v ? *v : nullptr; }
+    static Vehicle* popOne(RingQueue& q) { auto v = q.tryPop(); return v ? *v : nullptr; }
+    static Vehicle* popOne(LinkedQueue& q) { return q.tryPop(); }
+
+    /** @brief Moves every vehicle through the three queues @p rounds times; returns ns per hop. */
+    template<typename Q>
+    static double cycle(Q& run, Q& needCharge, Q& charge, const std::vector<Vehicle*>& fleet, int rounds) {
+        for (Vehicle* v : fleet) run.push(v);
+        auto start = BenchClock::now();
+        for (int r = 0; r < rounds; ++r) {
+            while (Vehicle* v = popOne(run)) needCharge.push(v);
+            while (Vehicle* v = popOne(needCharge)) charge.push(v);
+            for (size_t i = 0; i < fleet.size(); ++i) run.push(popOne(charge));
+        }
+        const double ms = elapsedMs(start);
+        while (popOne(run)) {}
+        return ms * 1e6 / (3.0 * rounds * static_cast<double>(fleet.size()));
+    }
+
+    /** @brief One producer pushes the fleet @p rounds times while a consumer polls; returns ns per hand-off. */
+    template<typename Q>
+    static double handoff(Q& q, const std::vector<Vehicle*>& fleet, int rounds) {
+        const size_t total = fleet.size() * static_cast<size_t>(rounds);
+        auto start = BenchClock::now();
+        std::thread consumer([&] {
+            for (size_t got = 0; got < total; ) {
+                if (popOne(q)) ++got;
+                else std::this_thread::yield();
+            }
+        });
+        // keep the queue under half the fleet so a vehicle has been taken before it is pushed again
+        for (int r = 0; r < rounds; ++r) {
+            for (Vehicle* v : fleet) {
+                while (q.approxSize() > fleet.size() / 2) std::this_thread::yield();
+                q.push(v);
+            }
+        }
+        consumer.join();
+        return elapsedMs(start) * 1e6 / static_cast<double>(total);
+    }
+
+    static void run() {
+        const int fleetSize = 100000;
+        const int rounds = 10;
+        std::cout << "[BENCH] Stage queues (" << fleetSize << " vehicles, " << rounds << " cycles)" << std::endl;
+
+        VehicleRandomDeployment deploy(fleetSize);
+        auto owned = deploy.deployVehicles();
+        std::vector<Vehicle*> fleet;
+        for (auto& v : owned) fleet.push_back(v.get());
+
+        MemoryTracker::ScopedEnable tracking;
+        MemoryTracker& tracker = MemoryTracker::instance();
+        const auto allocsBefore = tracker.counts(MemSubsystem::Test).allocations;
+        double deque;
+        {
+            TrackingAllocator<Vehicle*> alloc(MemSubsystem::Test);
+            DequeQueue run{alloc}, needCharge{alloc}, charge{alloc};
+            deque = cycle(run, needCharge, charge, fleet, rounds);
+        }
+        const auto dequeAllocs = tracker.counts(MemSubsystem::Test).allocations - allocsBefore;
+
+        RingQueue ringRun(fleet.size()), ringNeed(fleet.size()), ringCharge(fleet.size());
+        const double ring = cycle(ringRun, ringNeed, ringCharge, fleet, rounds);
+
+        LinkedQueue run, needCharge, charge;
+        const double linked = cycle(run, needCharge, charge, fleet, rounds);
+
+        std::cout << "  deque: " << deque << " ns/hop (" << static_cast<double>(dequeAllocs) / (3.0 * rounds * fleetSize) << " allocations/hop)\n"
+                  << "  ring: " << ring << " ns/hop\n"
+                  << "  intrusive: " << linked << " ns/hop (0 allocations, no capacity)\n"
+                  << "  speedup vs deque: " << deque / linked << "x\n";
+
+        DequeQueue dq{TrackingAllocator<Vehicle*>(MemSubsystem::Test)};
+        RingQueue rq(fleet.size());
+        LinkedQueue lq;
+        const int handoffRounds = 2;
+        std::cout << "  two-thread hand-off: deque " << handoff(dq, fleet, handoffRounds)
+                  << " ns, ring " << handoff(rq, fleet, handoffRounds)
+                  << " ns, intrusive " << handoff(lq, fleet, handoffRounds) << " ns per vehicle\n";
+    }
+};
+
+// ------------------------------------------
+// Out-of-core benchmark: the same fleet simulated in memory (coroutine
+// agents) and streamed from a memory-mapped fleet file.
+// ------------------------------------------
+class OutOfCoreBench {
+public:
+    static void run() {
+        const int fleetSize = 1000000;
+        const int stations = 20000;
+        const std::chrono::seconds duration(20000);
+        std::cout << "[BENCH] Out-of-core fleet (" << fleetSize << " vehicles, " << stations << " stations, "
+                  << duration.count() << " ticks)" << std::endl;
+
+        Simulation sim(stations, 0);
+        sim.setQuiet(true);
+        sim.setExecutionMode(ExecutionMode::Coroutines);
+        sim.setDeployment(std::make_unique<VehicleRandomDeployment>(fleetSize));
+        auto start = BenchClock::now();
+        sim.runSimulation(duration);
+        const double inMemory = elapsedMs(start);
+
+        const TempPath fleetFile("fleet.bin");
+        OutOfCoreConfig config;
+        config.path = fleetFile.path;
+        config.fleetSize = fleetSize;
+        config.stations = stations;
+        config.duration = duration;
+        OutOfCoreSimulation outOfCore(config);
+        start = BenchClock::now();
+        outOfCore.run();
+        const double streamed = elapsedMs(start);
+
+        const OutOfCoreStats& s = outOfCore.stats();
+        const double vehicleTicks = static_cast<double>(fleetSize) * duration.count();
+        std::cout << "  in memory (coroutines): " << inMemory << " ms (" << inMemory * 1e6 / vehicleTicks << " ns/vehicle-tick)\n"
+                  << "  out of core: " << streamed << " ms (" << streamed * 1e6 / vehicleTicks << " ns/vehicle-tick), "
+                  << s.mappedBytes / (1024.0 * 1024.0) << " MiB file\n"
+                  << "  chunks scanned " << s.chunkScans << ", skipped " << s.chunkSkips << ", streamed "
+                  << (s.wallSeconds > 0 ? s.bytesScanned / (1024.0 * 1024.0) / s.wallSeconds : 0) << " MiB/s\n";
+    }
+};
+
+// ------------------------------------------
+// Cohort benchmark: a large homogeneous fleet streamed record by record
+// vs aggregated into weighted cohorts.
+// ------------------------------------------
+class CohortBench {
+public:
+    static void run() {
+        const std::uint64_t fleetSize = 1000000;
+        const int stations = 20000;
+        const std::chrono::seconds duration(20000);
+        std::cout << "[BENCH] Cohort aggregation (" << fleetSize << " Alpha vehicles, " << stations << " stations, "
+                  << duration.count() << " ticks)" << std::endl;
+        auto allAlpha = [](std::uint64_t) { return VehicleKind::Alpha; };
+
+        VehicleStatsManager streamedStats;
+        const TempPath fleetFile("cohort.bin");
+        OutOfCoreConfig streamedConfig;
+        streamedConfig.path = fleetFile.path;
+        streamedConfig.fleetSize = fleetSize;
+        streamedConfig.stations = stations;
+        streamedConfig.duration = duration;
+        streamedConfig.kindOf = allAlpha;
+        streamedConfig.stats = &streamedStats;
+        OutOfCoreSimulation outOfCore(streamedConfig);
+        auto start = BenchClock::now();
+        outOfCore.run();
+        const double streamed = elapsedMs(start);
+        ::unlink(fleetFile.path.c_str());
+
+        VehicleStatsManager cohortStats;
+        CohortConfig config;
+        config.fleetSize = fleetSize;
+        config.stations = stations;
+        config.duration = duration;
+        config.kindOf = allAlpha;
+        config.stats = &cohortStats;
+        CohortSimulation cohorts(config);
+        start = BenchClock::now();
+        cohorts.run();
+        const double aggregated = elapsedMs(start);
+
+        const CohortStats& s = cohorts.stats();
+        std::cout << "  out of core: " << streamed << " ms, " << outOfCore.stats().phaseChanges << " record updates\n"
+                  << "  cohorts: " << aggregated << " ms (" << s.wallSeconds * 1e3 << " ms ticking), " << s.cohortSteps
+                  << " cohort steps for " << s.vehicleSteps << " vehicle phase changes, peak " << s.peakCohorts
+                  << " cohorts\n"
+                  << "  speedup: " << (aggregated > 0 ? streamed / aggregated : 0) << "x; charges "
+                  << outOfCore.stationReport().charges << " vs " << cohorts.stationReport().charges << "\n";
+    }
+};
+
+// ------------------------------------------
+// Embedded sweep benchmark: many small scenarios run through a fresh
+// SimulationContext each vs one context reused across the sweep.
+// ------------------------------------------
+class ContextReuseBench {
+public:
+    static void run() {
+        const int scenarios = 200;
+        SimulationConfig config;
+        config.fleetSize = 50;
+        config.duration = std::chrono::seconds(500);
+        config.seed = 1;
+        std::cout << "[BENCH] Embedded sweep (" << scenarios << " scenarios, " << config.fleetSize << " vehicles, "
+                  << config.duration.count() << " ticks)" << std::endl;
+
+        double checksum = 0;
+        auto start = BenchClock::now();
+        for (int i = 0; i < scenarios; ++i) {
+            config.stations = 1 + i % 8;
+            SimulationContext fresh(config);
+            checksum += fresh.run().stationReport.charges;
+        }
+        const double freshMs = elapsedMs(start);
+
+        SimulationContext reused(config);
+        start = BenchClock::now();
+        for (int i = 0; i < scenarios; ++i) {
+            config.stations = 1 + i % 8;
+            reused.configure(config);
+            checksum -= reused.run().stationReport.charges;
+        }
+        const double reusedMs = elapsedMs(start);
+
+        std::cout << "  fresh context: " << freshMs * 1000 / scenarios << " us/scenario, reused context: "
+                  << reusedMs * 1000 / scenarios << " us/scenario" << (checksum == 0 ? "" : " (results differ!)") << "\n";
+    }
+};
+
+// ------------------------------------------
+// Tracing overhead benchmark: the same pipeline run with the timeline
+// recorder disabled and enabled.
+// ------------------------------------------
+class TracingBench {
+public:
+    static void run() {
+        const int fleetSize = 20000;
+        const std::chrono::seconds duration(2000);
+        std::cout << "[BENCH] Tracing overhead (" << fleetSize << " vehicles, " << duration.count() << " ticks)" << std::endl;
+
+        auto timedRun = [&] {
+            Simulation sim(fleetSize / 20, 0);
+            sim.setQuiet(true);
+            sim.setDeployment(std::make_unique<VehicleRandomDeployment>(fleetSize, 1));
+            auto start = BenchClock::now();
+            sim.runSimulation(duration);
+            return elapsedMs(start);
+        };
+        // best of two alternating runs each, so machine noise does not pass for overhead
+        TraceRecorder& trace = TraceRecorder::instance();
+        double off = 1e300, on = 1e300;
+        size_t events = 0;
+        for (int round = 0; round < 2; ++round) {
+            off = std::min(off, timedRun());
+            trace.enable();
+            on = std::min(on, timedRun());
+            trace.disable();
+            events = trace.eventCount();
+            trace.clear();
+        }
+
+        std::cout << "  disabled: " << off << " ms, enabled: " << on << " ms (" << (on - off) * 100 / off
+                  << "%), " << events << " events per run\n";
+    }
+};
+
+// ------------------------------------------
+// Bench Runner
+// ------------------------------------------
+int main() {
+    PlacementBench::run();
+    EnergyKernelBench::run();
+    DispatchBench::run();
+    IntrusiveQueueBench::run();
+    OutOfCoreBench::run();
+    CohortBench::run();
+    ContextReuseBench::run();
+    TracingBench::run();
+    return 0;
+}
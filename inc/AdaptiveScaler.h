@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Tuning of the adaptive worker controller.
+ */
+struct ScalerConfig {
+    size_t cpuBudget = 0;               ///< Most workers across all stages, counting the driving thread (0 = all cores)
+    std::uint64_t windowTicks = 8;      ///< Ticks per evaluation window
+    double targetTickMs = 1.0;          ///< Runner CPU per worker per tick to aim for
+    double shrinkBelow = 0.6;           ///< Shrink once demand fits in this share of one worker fewer
+    int shrinkWindows = 4;              ///< Consecutive low windows before a worker is given up
+    size_t minVehiclesPerWorker = 1024; ///< Smallest runner share worth its own worker
+};
+
+/**
+ * @brief One evaluation window of pipeline measurements.
+ */
+struct StageSample {
+    std::uint64_t ticks = 0;       ///< Ticks in the window
+    size_t vehiclesRun = 0;        ///< Runner work items processed in the window
+    double runnerCpuMs = 0;        ///< Runner CPU time spent in the window
+    size_t runDepth = 0;           ///< Vehicles in the run queue at the end of the window
+    size_t needChargeDepth = 0;    ///< Vehicles waiting for a station
+    size_t chargeDepth = 0;        ///< Vehicles handed to the charger or charging
+};
+
+/**
+ * @brief Workers assigned to each pipeline stage.
+ *
+ * The dispatcher and charger are serial stages, so they get one worker
+ * while they have vehicles and none otherwise; the runner splits into as
+ * many same-kind chunks as it has workers.
+ */
+struct WorkerAllocation {
+    size_t runner = 1;      ///< Runner tasks per tick
+    size_t dispatcher = 0;  ///< 0 or 1
+    size_t charger = 0;     ///< 0 or 1
+
+    /** @return Workers in use across all stages (at least one: the driving thread). */
+    size_t total() const { return runner + dispatcher + charger; }
+};
+
+/**
+ * @brief Sizes the pipeline's stage workers from queue depths and stage CPU time.
+ *
+ * Once per window the runner's demand is predicted as the run-queue depth
+ * times the measured CPU cost per vehicle, divided by the per-worker tick
+ * target, so a depletion wave that empties the run queue is seen at once
+ * rather than a window later. Demand above the current allocation grows it
+ * immediately, up to the CPU budget; demand must stay below shrinkBelow of
+ * one worker fewer for shrinkWindows windows in a row before a worker is
+ * released, one at a time. The gap between the two thresholds is the
+ * hysteresis that keeps the allocation from flapping.
+ *
+ * Pure bookkeeping: the caller applies the allocation (see
+ * WorkerPool::setActiveWorkers()).
+ */
+class AdaptiveScaler {
+public:
+    explicit AdaptiveScaler(const ScalerConfig& config = ScalerConfig());
+
+    /** @brief Resets to one runner worker and clears the measurements. */
+    void reset();
+
+    /**
+     * @brief Feeds one window and returns the allocation for the next one.
+     */
+    const WorkerAllocation& update(const StageSample& sample);
+
+    /** @return Allocation in force. */
+    const WorkerAllocation& current() const { return alloc; }
+
+    /** @return Effective CPU budget (cpuBudget, or the core count when 0). */
+    size_t budget() const { return cpuBudget; }
+
+    /** @return Largest total allocation since reset(). */
+    size_t peak() const { return peakTotal; }
+
+    /** @return Times the runner allocation changed since reset(). */
+    size_t changes() const { return changeCount; }
+
+    /** @return Latest runner CPU cost per vehicle (ns), smoothed. */
+    double nsPerVehicle() const { return costNs; }
+
+private:
+    ScalerConfig config;         ///< Tuning
+    size_t cpuBudget;            ///< Effective budget
+    WorkerAllocation alloc;      ///< Allocation in force
+    double costNs = 0;           ///< Smoothed runner CPU per vehicle
+    int lowWindows = 0;          ///< Consecutive windows below the shrink threshold
+    size_t peakTotal = 1;        ///< Largest total allocation
+    size_t changeCount = 0;      ///< Runner allocation changes
+};
@@ -1,6 +1,10 @@
 #pragma once
+#include <cstdint>
+#include <iostream>
 #include <string>
+#include <span>
 #include "Vehicle.h"
+#include "RunningSummary.h"
 
 /**
  * @brief Enumerates all statistical categories recorded during simulation.
@@ -11,9 +15,39 @@ enum class StatType {
     TotalTestVehicle,   /**< Counts vehicles participating in simulation. */
     TotalTime,          /**< Records running time accumulated by vehicles. */
     TotalChargeCycle,   /**< Counts the number of charge cycles completed. */
-    TotalChargeTime     /**< Records total time spent charging. */
+    TotalChargeTime,    /**< Records total time spent charging. */
+    PartialTime,        /**< Credits the running time of a run cut short by the end of the simulation; totals only. */
+    PartialChargeTime   /**< Credits the charging time of a charge cut short by the end of the simulation; totals only. */
 };
 
+/**
+ * @brief Point-in-time copy of one vehicle type's statistics, with all
+ *        derived metrics (averages, distance, faults) already computed.
+ */
+struct VehicleStatsSnapshot {
+    double totalTime = 0;            ///< Total accumulated running time (seconds)
+    double averageTime = 0;          ///< Average running time per test vehicle
+    double totalTestVehicle = 0;     ///< Number of vehicles that completed running
+    double totalDistance = 0;        ///< Total miles traveled by all vehicles
+    double averageDistance = 0;      ///< Mean miles per run
+    double totalChargedVehicle = 0;  ///< Number of vehicles that completed charging
+    double totalChargeTime = 0;      ///< Total charge time across all cycles
+    double averageChargeTime = 0;    ///< Average charge duration
+    double totalFaults = 0;          ///< Expected fault count
+    double totalPassengersMiles = 0; ///< Sum of (passengers × miles)
+
+    RunningSummary runTime;          ///< Per-run running time (seconds)
+    RunningSummary runDistance;      ///< Per-run distance (miles)
+    RunningSummary chargeTime;       ///< Per-charge charging time (seconds)
+};
+
+/**
+ * @brief Adds the totals of @p from into @p into, merges the summaries and recomputes the averages.
+ *
+ * Associative and commutative, so snapshots can be reduced in any order.
+ */
+void mergeSnapshot(VehicleStatsSnapshot& into, const VehicleStatsSnapshot& from);
+
 /**
  * @brief Abstract interface for collecting and reporting vehicle statistics.
  *
@@ -36,6 +70,56 @@ public:
      */
     virtual void record(const Vehicle& v, StatType type) = 0;
 
+    /**
+     * @brief Records the same metric for a batch of vehicles.
+     *
+     * The default records them one by one; implementations may apply the
+     * whole batch as one update.
+     *
+     * @param vehicles Vehicles generating the metric.
+     * @param type     Type of metric being updated.
+     */
+    virtual void recordBatch(std::span<Vehicle* const> vehicles, StatType type) {
+        for (const Vehicle* v : vehicles) record(*v, type);
+    }
+
+    /**
+     * @brief Records the same metric for @p count vehicles in the same state as @p v.
+     *
+     * The default records @p v @p count times; implementations may scale
+     * the update instead, so the cost does not grow with the count.
+     *
+     * @param v     Vehicle standing for all of them.
+     * @param type  Type of metric being updated.
+     * @param count Vehicles it stands for.
+     */
+    virtual void recordWeighted(const Vehicle& v, StatType type, std::uint64_t count) {
+        for (std::uint64_t i = 0; i < count; ++i) record(v, type);
+    }
+
+    /**
+     * @brief Folds the statistics recorded by @p other into this instance.
+     *
+     * The result matches recording every event of both into one instance,
+     * so per-thread, per-shard or per-replica stats can be reduced pairwise
+     * (e.g., as a tree). @p other must be of the same implementation.
+     * The default reports that merging is unsupported and changes nothing.
+     *
+     * @param other Stats of the same vehicle type; not modified.
+     */
+    virtual void merge(const BaseStats& other) {
+        (void)other;
+        std::cerr << "Stats merge is not supported by this collector; ignored\n";
+    }
+
+    /**
+     * @brief Clears everything recorded so far.
+     *
+     * Safe while readers take snapshots; the instance stays registered.
+     * The default does nothing, for collectors with no state to clear.
+     */
+    virtual void reset() {}
+
     /**
      * @brief Logs summary results for this vehicle type.
      *
@@ -44,5 +128,14 @@ public:
      * @param type  Vehicle type name associated with this statistics instance.
      */
     virtual void log(const std::string& type) const = 0;
+
+    /**
+     * @brief Returns a consistent copy of the stats with derived metrics.
+     *
+     * May be called from a monitoring thread while workers are recording,
+     * so implementations must not block writers. The default reports an
+     * empty snapshot for collectors that do not support live queries.
+     */
+    virtual VehicleStatsSnapshot snapshot() const { return {}; }
 };
 
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <atomic>
+#include <chrono>
+#include <span>
+#include <algorithm>
+
+/**
+ * @brief A thread-safe bounded FIFO queue backed by a preallocated ring.
+ *
+ * Storage is allocated once by the constructor or reserve(), so pushes and
+ * pops never allocate. When the ring is full, producers get explicit
+ * backpressure: push() blocks, tryPush() fails, and pushFor() waits up to a
+ * timeout. The deepest the queue has been is kept as a high-water mark.
+ *
+ * @tparam T     The type of elements stored in the queue.
+ * @tparam Alloc Allocator for the ring storage (e.g., TrackingAllocator).
+ */
+template<typename T, typename Alloc = std::allocator<T>>
+class BoundedQueue {
+public:
+    /**
+     * @brief Constructs an empty queue holding at most @p capacity elements.
+     */
+    explicit BoundedQueue(size_t capacity = 0, const Alloc& alloc = Alloc()) : ring(capacity, T{}, alloc) {}
+
+    /**
+     * @brief Grows the ring to hold at least @p capacity elements, keeping queued elements in order.
+     *
+     * Allocates; meant for setup (e.g., sizing from the fleet), not the steady state.
+     */
+    void reserve(size_t capacity) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (capacity <= ring.size()) return;
+            std::vector<T, Alloc> grown(capacity, T{}, ring.get_allocator());
+            for (size_t i = 0; i < count; ++i) grown[i] = std::move(ring[(head + i) % ring.size()]);
+            ring.swap(grown);
+            head = 0;
+            cap.store(capacity, std::memory_order_relaxed);
+        }
+        notFull.notify_all();
+    }
+
+    /**
+     * @brief Pushes an element, blocking while the queue is full.
+     *
+     * @param v The value to push into the queue.
+     */
+    void push(const T& v) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            notFull.wait(lock, [&]{ return count < ring.size(); });
+            enqueue(v);
+        }
+        notEmpty.notify_one();
+    }
+
+    /**
+     * @brief Pushes an element if there is room, without blocking.
+     *
+     * @return false if the queue was full.
+     */
+    bool tryPush(const T& v) {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (count == ring.size()) return false;
+            enqueue(v);
+        }
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pushes an element, waiting at most @p timeout for room.
+     *
+     * @return false if the queue was still full when the timeout expired.
+     */
+    template<typename Rep, typename Period>
+    bool pushFor(const T& v, std::chrono::duration<Rep, Period> timeout) {
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            if (!notFull.wait_for(lock, timeout, [&]{ return count < ring.size(); })) return false;
+            enqueue(v);
+        }
+        notEmpty.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Pushes a batch in order, taking the lock once per run of free slots.
+     *
+     * Blocks while the queue is full, like push().
+     */
+    void pushBatch(std::span<const T> values) {
+        size_t done = 0;
+        while (done < values.size()) {
+            {
+                std::unique_lock<std::mutex> lock(mtx);
+                notFull.wait(lock, [&]{ return count < ring.size(); });
+                const size_t n = std::min(values.size() - done, ring.size() - count);
+                for (size_t i = 0; i < n; ++i) enqueue(values[done + i]);
+                done += n;
+            }
+            notEmpty.notify_all();
+        }
+    }
+
+    /**
+     * @brief Pops an element from the queue, blocking if empty.
+     *
+     * @return The popped element.
+     */
+    T pop() {
+        T t;
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            notEmpty.wait(lock, [&]{ return count > 0; });
+            t = dequeue();
+        }
+        notFull.notify_one();
+        return t;
+    }
+
+    /**
+     * @brief Attempts to pop an element without blocking.
+     *
+     * @return std::optional<T> containing the element if available,
+     *         or std::nullopt if the queue is empty.
+     */
+    std::optional<T> tryPop() {
+        std::optional<T> t;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (count == 0) return std::nullopt;
+            t = dequeue();
+        }
+        notFull.notify_one();
+        return t;
+    }
+
+    /**
+     * @brief Pops up to @p max elements under one lock, appending them to @p out in FIFO order.
+     *
+     * @return Number of elements popped.
+     */
+    size_t tryPopBatch(std::vector<T>& out, size_t max) {
+        size_t n;
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            n = std::min(max, count);
+            for (size_t i = 0; i < n; ++i) out.push_back(dequeue());
+        }
+        if (n > 0) notFull.notify_all();
+        return n;
+    }
+
+    /**
+     * @brief Drops every queued element; capacity and the high-water mark are kept.
+     */
+    void clear() {
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            head = 0;
+            count = 0;
+            depth.store(0, std::memory_order_relaxed);
+        }
+        notFull.notify_all();
+    }
+
+    /**
+     * @brief Wakes all threads waiting in pop() or push().
+     *
+     * Used during shutdown to release blocked threads.
+     */
+    void notifyAll() {
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
+
+    /** @return true if the queue is empty. */
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count == 0;
+    }
+
+    /** @return Number of elements currently stored. */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx);
+        return count;
+    }
+
+    /**
+     * @brief Returns the last published queue depth without locking.
+     *
+     * @return Number of elements as of the most recent push or pop.
+     */
+    size_t approxSize() const { return depth.load(std::memory_order_relaxed); }
+
+    /** @return Maximum number of elements the ring holds (lock-free). */
+    size_t capacity() const { return cap.load(std::memory_order_relaxed); }
+
+    /** @return Largest depth reached since construction or resetHighWater() (lock-free). */
+    size_t highWaterMark() const { return highWater.load(std::memory_order_relaxed); }
+
+    /** @brief Restarts high-water tracking from the current depth. */
+    void resetHighWater() {
+        std::lock_guard<std::mutex> lock(mtx);
+        highWater.store(count, std::memory_order_relaxed);
+    }
+
+private:
+    void enqueue(const T& v) {
+        ring[(head + count) % ring.size()] = v;
+        ++count;
+        depth.store(count, std::memory_order_relaxed);
+        if (count > highWater.load(std::memory_order_relaxed)) highWater.store(count, std::memory_order_relaxed);
+    }
+
+    T dequeue() {
+        T t = std::move(ring[head]);
+        head = (head + 1) % ring.size();
+        --count;
+        depth.store(count, std::memory_order_relaxed);
+        return t;
+    }
+
+    mutable std::mutex mtx;              ///< Protects the ring, head and count
+    std::condition_variable notEmpty;    ///< Wakes consumers blocked in pop()
+    std::condition_variable notFull;     ///< Wakes producers blocked in push()/pushFor()
+    std::vector<T, Alloc> ring;          ///< Preallocated slots
+    size_t head = 0;                     ///< Index of the oldest element
+    size_t count = 0;                    ///< Elements currently queued
+    std::atomic<size_t> depth{0};        ///< Mirror of count for lock-free readers
+    std::atomic<size_t> cap{ring.size()}; ///< Mirror of ring.size() for lock-free readers
+    std::atomic<size_t> highWater{0};    ///< Largest count seen
+};
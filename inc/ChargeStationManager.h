@@ -11,6 +11,10 @@
  * It implements a blocking acquire/release model using a mutex and
  * condition variable, ensuring that no more than the configured number of
  * vehicles may charge simultaneously.
+ *
+ * The free-station counter itself is a lock-free atomic, so it can live in
+ * memory shared with other processes (see attachShared()); tryAcquire() and
+ * release() never take the mutex.
  */
 class ChargeStationManager {
 public:
@@ -33,19 +37,90 @@ public:
     void acquire(std::atomic<bool>& stopFlag);
 
     /**
-     * @brief Releases a previously acquired charging station slot.
+     * @brief Acquires a charging station slot only if one is free right now.
+     *
+     * @return true if a slot was acquired.
+     */
+    bool tryAcquire();
+
+    /**
+     * @brief Acquires as many free slots as possible, up to @p wanted, in one atomic step.
      *
-     * This operation wakes one waiting thread, if any.
+     * @return Number of slots acquired (0 if none was free).
+     */
+    int tryAcquireUpTo(int wanted);
+
+    /**
+     * @brief Blocks until at least one slot is free, then acquires up to @p wanted at once.
+     *
+     * @param wanted    Most slots to take.
+     * @param stopFlag  External termination flag monitored during blocking wait.
+     * @return Number of slots acquired; 0 only if stopFlag was raised.
      */
-    void release();
+    int acquireUpTo(int wanted, std::atomic<bool>& stopFlag);
+
+    /**
+     * @brief Releases previously acquired charging station slots.
+     *
+     * This operation wakes waiting threads, if any.
+     *
+     * @param count Number of slots to return.
+     */
+    void release(int count = 1);
 
     /**
      * @brief Returns the current number of unoccupied charging stations.
      *
+     * Lock-free, so monitoring readers never contend with acquire/release.
+     *
      * @return Count of available charging stations.
      */
     int getAvailable() const;
 
+    /**
+     * @brief Returns the fewest free stations any acquire left since the last reset().
+     *
+     * On a shared counter this is what this process's acquires saw; since the
+     * count only falls on an acquire, the pool-wide mark is the minimum over
+     * every process sharing it.
+     */
+    int getLowWater() const { return lowWater.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the configured number of charging stations.
+     */
+    int getTotal() const { return totalStations; }
+
+    /**
+     * @brief Changes the number of stations, e.g., for a what-if branch.
+     *
+     * Free stations change by the difference. Removing stations that are in
+     * use drives the free count negative, so nothing is acquired until
+     * enough of them are released. Call from the thread that drives the
+     * simulation while no stage is running.
+     *
+     * @param stations New total, at least 0.
+     */
+    void setTotal(int stations);
+
+    /**
+     * @brief Marks every station free again, e.g., for a new run.
+     *
+     * No-op on a shared counter, whose stations other processes may hold.
+     */
+    void reset();
+
+    /**
+     * @brief Counts stations in an external counter, e.g., one in shared memory.
+     *
+     * Other processes may acquire and release through the same counter.
+     * Their releases cannot signal this process's condition variable, so
+     * acquire() then polls. Call before any station is in use.
+     *
+     * @param available Lock-free counter of free stations; must outlive the manager.
+     */
+    void attachShared(std::atomic<int>* available);
+
     /**
      * @brief Notifies all waiting threads to terminate blocking waits.
      *
@@ -54,7 +129,11 @@ public:
     void stopAll();
 
 private:
-    int availableStations;                   ///< Number of unoccupied charging stations.
-    mutable std::mutex mtx;                  ///< Protects station counter.
+    int totalStations;                       ///< Number of configured stations.
+    std::atomic<int> availableStations;      ///< Number of unoccupied charging stations, unless shared.
+    std::atomic<int>* available = &availableStations; ///< Counter in use (own or shared).
+    std::atomic<int> lowWater;               ///< Fewest free stations left by an acquire.
+    bool shared = false;                     ///< true once attachShared() was called.
+    mutable std::mutex mtx;                  ///< Orders blocking waits against release() wakeups.
     std::condition_variable cv;              ///< Coordinates waiting and wakeup events.
 };
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "ChargeStationManager.h"
+#include "OutOfCoreFleet.h"
+#include "StationMetrics.h"
+#include "Vehicle.h"
+#include "VehicleSpecs.h"
+#include "VehicleStatsManager.h"
+
+/**
+ * @brief Vehicles of one built-in kind in exactly the same state, simulated as one entity.
+ *
+ * A running or charging cohort is due at the tick its phase ends; a
+ * waiting cohort shares the tick its batteries ran out.
+ */
+struct Cohort {
+    VehicleKind kind = VehicleKind::Alpha;      ///< Built-in type
+    FleetPhase phase = FleetPhase::Running;     ///< Current phase
+    std::uint64_t count = 0;                    ///< Vehicles it stands for
+    std::uint64_t depleted = 0;                 ///< Tick the batteries last ran out (Waiting)
+};
+
+/**
+ * @brief Configuration of a cohort run.
+ */
+struct CohortConfig {
+    std::uint64_t fleetSize = 20;               ///< Vehicles
+    int stations = 3;                           ///< Charging stations
+    std::chrono::seconds duration{2000};        ///< Simulated duration
+    unsigned seed = 1;                          ///< Seed of the default random type mix
+    VehicleStatsManager* stats = nullptr;       ///< Stats sink (nullptr = VehicleStatsManager::getInstance())
+
+    /** @brief Type of vehicle @p id (uniform random over the built-in kinds by default). */
+    std::function<VehicleKind(std::uint64_t id)> kindOf;
+};
+
+/**
+ * @brief Counters of a cohort run.
+ */
+struct CohortStats {
+    std::uint64_t ticks = 0;            ///< Ticks simulated
+    std::uint64_t eventTicks = 0;       ///< Ticks on which some cohort changed phase
+    std::uint64_t cohortSteps = 0;      ///< Cohort phase changes applied (the per-tick work)
+    std::uint64_t vehicleSteps = 0;     ///< Vehicle phase changes those stood for
+    std::uint64_t splits = 0;           ///< Waiting cohorts only partly admitted to stations
+    std::uint64_t merges = 0;           ///< Cohorts folded into one already in the same state
+    size_t peakCohorts = 0;             ///< Most cohorts alive at once
+    double wallSeconds = 0;             ///< Wall time of the tick loop
+};
+
+/**
+ * @brief Runs a fleet of built-in vehicles as cohorts of identical vehicles with a count.
+ *
+ * Every vehicle of a kind starts fully charged and follows the same
+ * deterministic rules, so until station contention splits them thousands
+ * of vehicles share one state. A cohort splits only when a station
+ * acquire admits part of it; cohorts merge again whenever they reach the
+ * same kind, phase and due tick. Stats and station metrics are recorded
+ * once per cohort, weighted by its count (BaseStats::recordWeighted()).
+ *
+ * Cohorts wait for stations in FIFO order of depletion; vehicles of
+ * different kinds depleting on the same tick queue in cohort order rather
+ * than vehicle order, so under contention which kind gets a station first
+ * on such a tick can differ from OutOfCoreSimulation. Otherwise lifecycles
+ * and recorded stats match it (and coroutine mode). Between ticks on which
+ * a phase ends nothing can change, so those ticks are sampled in one step.
+ * Runs are unpaced.
+ */
+class CohortSimulation {
+public:
+    explicit CohortSimulation(const CohortConfig& config);
+
+    /** @brief Deploys the fleet and simulates the configured duration. */
+    void run();
+
+    /** @return Counters of the last run. */
+    const CohortStats& stats() const { return counters; }
+
+    /** @return Station utilization, waits and throughput of the last run. */
+    StationReport stationReport() const { return stationMetrics.report(); }
+
+    /** @brief Prints the run counters and the station report. */
+    void printResults(std::ostream& os) const;
+
+private:
+    /** @brief Per-kind constants of one lifecycle. */
+    struct Profile {
+        std::uint64_t driveTicks = 1;       ///< Running ticks from full to empty
+        std::uint64_t chargeTicks = 1;      ///< Charging ticks from empty to full
+        std::unique_ptr<Vehicle> cycle;     ///< Vehicle holding one full run and one full charge, for recording
+        std::unique_ptr<Vehicle> idle;      ///< Vehicle with nothing run or charged this cycle
+        std::unique_ptr<Vehicle> partial;   ///< Scratch vehicle for a phase cut short by the end of the run
+    };
+
+    /** @brief Groups the fleet into one running cohort per kind. */
+    void deploy();
+
+    /** @brief Applies the phase changes of every cohort due at @p tick. */
+    void advance(std::uint64_t tick);
+
+    /** @brief Hands free stations to waiting cohorts in FIFO order, splitting the last one admitted. */
+    void dispatch(std::uint64_t tick);
+
+    /** @brief Schedules @p cohort to change phase at @p tick, merging it into a matching cohort. */
+    void schedule(std::uint64_t tick, const Cohort& cohort);
+
+    /** @brief Queues a depleted cohort, merging it into the last one if they match. */
+    void enqueue(const Cohort& cohort);
+
+    /** @return Manager the run records into. */
+    VehicleStatsManager& statsManager() const {
+        return config.stats ? *config.stats : VehicleStatsManager::getInstance();
+    }
+
+    /** @brief Records this tick's depletions, dispatches and completed charges per kind. */
+    void recordTick();
+
+    /** @brief Credits the partial phase of every cohort at the end of the run. */
+    void finish(std::uint64_t tick);
+
+    CohortConfig config;                                    ///< Run parameters
+    std::map<std::uint64_t, std::vector<Cohort>> due;       ///< Running and charging cohorts by due tick
+    std::deque<Cohort> waitQueue;                           ///< Cohorts waiting for a station, oldest first
+    std::uint64_t waiting = 0;                              ///< Vehicles in waitQueue
+    size_t live = 0;                                        ///< Cohorts alive
+    std::array<Profile, kBuiltinVehicleKinds> profiles;     ///< Lifecycle constants per kind
+    std::array<std::uint64_t, kBuiltinVehicleKinds> depletedNow{};   ///< Depletions this tick, per kind
+    std::array<std::uint64_t, kBuiltinVehicleKinds> dispatchedNow{}; ///< Stations acquired this tick, per kind
+    std::array<std::uint64_t, kBuiltinVehicleKinds> chargedNow{};    ///< Completed charges this tick, per kind
+    ChargeStationManager stationManager;                    ///< Station pool
+    StationMetrics stationMetrics;                          ///< Station utilization and waits
+    CohortStats counters;                                   ///< Run counters
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <coroutine>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <utility>
+#include "TimingWheel.h"
+#include "ChargeStationManager.h"
+
+/**
+ * @brief Owning handle to a vehicle agent coroutine.
+ *
+ * The coroutine starts suspended; the executor resumes it. Destroying the
+ * task destroys the frame, wherever it is suspended.
+ */
+class AgentTask {
+public:
+    struct promise_type {
+        AgentTask get_return_object() {
+            return AgentTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    AgentTask() = default;
+    explicit AgentTask(std::coroutine_handle<promise_type> h) : handle(h) {}
+    AgentTask(AgentTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    AgentTask& operator=(AgentTask&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    AgentTask(const AgentTask&) = delete;
+    AgentTask& operator=(const AgentTask&) = delete;
+    ~AgentTask() { if (handle) handle.destroy(); }
+
+    /** @return The underlying coroutine handle (not owned by the caller). */
+    std::coroutine_handle<> get() const { return handle; }
+
+private:
+    std::coroutine_handle<promise_type> handle;  ///< Owned coroutine frame
+};
+
+/**
+ * @brief Single-threaded executor that resumes coroutines on a virtual clock.
+ *
+ * Suspended agents live only in their coroutine frames plus one timer entry
+ * (or one waiter slot); nothing is pushed or popped per tick for an agent
+ * that is not due. Each tick() resumes the agents whose delay expired and
+ * anything they made ready in turn.
+ *
+ * Not thread-safe: all agents run on the thread calling tick().
+ */
+class SimExecutor {
+public:
+    /** @brief Awaitable returned by delay(). */
+    struct DelayAwaiter {
+        SimExecutor& exec;
+        std::uint64_t ticks;
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) { exec.timers.schedule(exec.now() + ticks, h); }
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief Suspends the awaiting coroutine for @p ticks simulated seconds.
+     *
+     * A delay of zero resumes on the next tick.
+     */
+    DelayAwaiter delay(std::uint64_t ticks) { return DelayAwaiter{*this, ticks}; }
+
+    /**
+     * @brief Queues a coroutine to be resumed during the current (or next) tick.
+     */
+    void post(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    /**
+     * @brief Advances the virtual clock by one tick and runs every coroutine due.
+     */
+    void tick() {
+        timers.advance([this](std::coroutine_handle<>& h) { ready.push_back(h); });
+        drain();
+    }
+
+    /**
+     * @brief Resumes everything posted so far (e.g., newly started agents).
+     */
+    void drain() {
+        while (!ready.empty()) {
+            auto h = ready.front();
+            ready.pop_front();
+            h.resume();
+        }
+    }
+
+    /** @return Current virtual tick. */
+    std::uint64_t now() const { return timers.currentTick(); }
+
+    /** @return Number of coroutines suspended on a delay. */
+    size_t sleeping() const { return timers.size(); }
+
+private:
+    HierarchicalTimingWheel<std::coroutine_handle<>> timers; ///< Delayed coroutines by wake tick
+    std::deque<std::coroutine_handle<>> ready;               ///< Coroutines runnable this tick
+};
+
+/**
+ * @brief Awaitable view of ChargeStationManager for coroutine agents.
+ *
+ * Uses the manager's non-blocking tryAcquire(), so station usage stays
+ * visible to snapshots. Agents that find no free station wait in FIFO order
+ * and are handed a station directly on release(), without it ever returning
+ * to the pool.
+ */
+class StationAwaitable {
+public:
+    StationAwaitable(ChargeStationManager& stations, SimExecutor& exec)
+        : stations(stations), exec(exec) {}
+
+    /** @brief Awaitable returned by acquire(). */
+    struct AcquireAwaiter {
+        StationAwaitable& pool;
+        bool await_ready() { return pool.stations.tryAcquire(); }
+        void await_suspend(std::coroutine_handle<> h) { pool.waiters.push_back(h); }
+        void await_resume() const noexcept {}
+    };
+
+    /** @brief Suspends until a station is held by the awaiting agent. */
+    AcquireAwaiter acquire() { return AcquireAwaiter{*this}; }
+
+    /** @brief Hands the station to the next waiter, or returns it to the pool. */
+    void release() {
+        if (waiters.empty()) {
+            stations.release();
+            return;
+        }
+        exec.post(waiters.front());
+        waiters.pop_front();
+    }
+
+    /** @return Number of agents waiting for a station. */
+    size_t waiting() const { return waiters.size(); }
+
+private:
+    ChargeStationManager& stations;               ///< Shared station counter
+    SimExecutor& exec;                            ///< Executor that resumes waiters
+    std::deque<std::coroutine_handle<>> waiters;  ///< Agents waiting, FIFO
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief One completed run/charge cycle of one vehicle.
+ */
+struct CycleRow {
+    std::uint32_t vehicleId = 0;   ///< Vehicle id within the run
+    std::string_view type;         ///< Vehicle type name
+    std::int64_t start = 0;        ///< Tick the run phase started
+    double duration = 0;           ///< Simulated seconds spent running
+    double distance = 0;           ///< Miles travelled in the run phase
+    std::int64_t chargeWait = 0;   ///< Ticks from depletion to acquiring a station
+    double chargeTime = 0;         ///< Simulated seconds spent charging
+};
+
+/**
+ * @brief Columns of a cycle file, in on-disk order.
+ */
+enum class CycleColumn {
+    VehicleId,    /**< uint32_t */
+    Type,         /**< uint16_t code into the file's type dictionary */
+    Start,        /**< int64_t */
+    Duration,     /**< double */
+    Distance,     /**< double */
+    ChargeWait,   /**< int64_t */
+    ChargeTime,   /**< double */
+    Count
+};
+
+/** @brief Number of columns in a cycle file. */
+inline constexpr std::size_t kCycleColumns = static_cast<std::size_t>(CycleColumn::Count);
+
+/**
+ * @brief Writes CycleRows to a simple columnar binary file.
+ *
+ * Layout: an 8-byte magic, then row groups. Each group stores every column
+ * as one contiguous, 8-byte aligned block. A footer holds the type
+ * dictionary and an index of (rows, column offsets) per group, followed by
+ * the footer's offset and the magic again.
+ *
+ * append() fills a buffer owned by the calling thread, column by column, and
+ * takes no lock in the common case. Full buffers are handed to a background
+ * thread that writes them as row groups. close() flushes every partial
+ * buffer; call it only once producers have stopped appending.
+ */
+class CycleExporter {
+public:
+    /**
+     * @brief Opens @p path for writing and starts the writer thread.
+     *
+     * @param path         Output file (truncated).
+     * @param rowsPerGroup Rows per per-thread buffer, i.e., per row group.
+     */
+    explicit CycleExporter(const std::string& path, std::size_t rowsPerGroup = 65536);
+
+    /** @brief Closes the file if still open. */
+    ~CycleExporter();
+
+    CycleExporter(const CycleExporter&) = delete;
+    CycleExporter& operator=(const CycleExporter&) = delete;
+
+    /** @return true if the file was opened. */
+    bool isOpen() const { return file != nullptr; }
+
+    /** @brief Appends one row to the calling thread's buffer; ignored once closed. */
+    void append(const CycleRow& row);
+
+    /** @brief Flushes all buffers, writes the footer and closes the file. */
+    void close();
+
+    /** @return Rows written to the file so far; the total once close() returns. */
+    std::uint64_t rowsWritten() const;
+
+private:
+    /** @brief Per-thread column buffers; becomes one row group when full. */
+    struct Buffer {
+        std::vector<std::uint32_t> vehicleId;
+        std::vector<std::uint16_t> type;
+        std::vector<std::int64_t> start;
+        std::vector<double> duration;
+        std::vector<double> distance;
+        std::vector<std::int64_t> chargeWait;
+        std::vector<double> chargeTime;
+        std::vector<std::pair<std::string, std::uint16_t>> typeCache; ///< Codes this thread has already looked up
+        std::size_t size() const { return vehicleId.size(); }
+        void reserve(std::size_t rows);
+        void clear();
+        void swapColumns(Buffer& other);
+    };
+
+    /** @brief Index entry of one written row group. */
+    struct GroupIndex {
+        std::uint64_t rows;
+        std::array<std::uint64_t, kCycleColumns> offsets;
+    };
+
+    Buffer& localBuffer();
+    std::uint16_t typeCode(Buffer& buf, std::string_view type);
+    std::unique_ptr<Buffer> takeSpare();
+    void submit(std::unique_ptr<Buffer> full);
+    void writerLoop();
+    void writeGroup(const Buffer& buf);
+    void writeBlock(const void* data, std::size_t bytes);
+
+    std::FILE* file = nullptr;             ///< Output file
+    std::size_t rowsPerGroup;              ///< Buffer capacity in rows
+    std::uint64_t id;                      ///< Distinguishes exporters in thread-local caches
+    std::atomic<bool> closed{false};       ///< Set by close(); later appends are dropped
+    std::uint64_t fileOffset = 0;          ///< Bytes written so far (writer thread)
+    std::vector<GroupIndex> index;         ///< Written groups (writer thread)
+
+    mutable std::mutex mtx;                              ///< Guards the members below
+    std::condition_variable cv;                          ///< Wakes the writer thread
+    std::vector<std::unique_ptr<Buffer>> active;         ///< Buffers owned by producer threads
+    std::deque<std::unique_ptr<Buffer>> fullBuffers;     ///< Buffers waiting to be written
+    std::vector<std::unique_ptr<Buffer>> spares;         ///< Written buffers for reuse
+    std::vector<std::string> typeNames;                  ///< Type dictionary, by code
+    std::unordered_map<std::string, std::uint16_t> typeCodes; ///< Type dictionary, by name
+    std::uint64_t written = 0;                           ///< Rows in row groups already written
+    bool closing = false;                                ///< Writer should exit after draining
+    std::thread writer;                                  ///< Background writer
+};
+
+/**
+ * @brief Read-only memory-mapped view of a cycle file.
+ *
+ * Columns are exposed as spans straight into the mapping, so scans touch
+ * only the columns they read and nothing is parsed or copied.
+ */
+class CycleFile {
+public:
+    /** @brief Maps @p path; check isOpen() afterwards. */
+    explicit CycleFile(const std::string& path);
+    ~CycleFile();
+
+    CycleFile(const CycleFile&) = delete;
+    CycleFile& operator=(const CycleFile&) = delete;
+
+    /** @return true if the file was mapped and its footer is valid. */
+    bool isOpen() const { return base != nullptr; }
+
+    /** @return Number of row groups. */
+    std::size_t groupCount() const { return groups.size(); }
+
+    /** @return Total rows across groups. */
+    std::uint64_t rowCount() const;
+
+    /**
+     * @brief Values of one column in one row group.
+     *
+     * @tparam T Element type matching the column (see CycleColumn).
+     */
+    template<typename T>
+    std::span<const T> column(std::size_t group, CycleColumn col) const {
+        const auto& g = groups[group];
+        return {reinterpret_cast<const T*>(base + g.offsets[static_cast<std::size_t>(col)]),
+                static_cast<std::size_t>(g.rows)};
+    }
+
+    /** @return Type name for a Type column code. */
+    const std::string& typeName(std::uint16_t code) const { return typeNames[code]; }
+
+private:
+    struct Group {
+        std::uint64_t rows;
+        std::array<std::uint64_t, kCycleColumns> offsets;
+    };
+
+    const unsigned char* base = nullptr;  ///< Mapping base
+    std::size_t length = 0;               ///< Mapping length
+    std::vector<Group> groups;            ///< Row-group index from the footer
+    std::vector<std::string> typeNames;   ///< Type dictionary from the footer
+};
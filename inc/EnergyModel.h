@@ -0,0 +1,99 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "VehicleSpecs.h"
+
+/**
+ * @brief Precomputed battery drain of one vehicle type at one passenger load.
+ *
+ * Covers one period of the type's drive-cycle speed profile, one entry per
+ * simulated second, as running totals. Units are cruise-equivalent seconds:
+ * the battery energy (resp. distance) one second at cruise speed and full
+ * load uses (resp. covers). A full battery therefore holds exactly
+ * VehicleSpec::driveSeconds() of drain, so thresholds stay unchanged, and a
+ * flat table reproduces the constant-rate model bit for bit.
+ *
+ * Reading a total is one table lookup, whatever the model behind it.
+ */
+struct EnergyTable {
+    static constexpr std::size_t kPeriod = 256;  ///< Ticks per profile period (power of two)
+
+    std::array<double, kPeriod + 1> drain{};   ///< drain[i]: drain over the first i ticks of a period
+    std::array<double, kPeriod + 1> travel{};  ///< travel[i]: distance over the first i ticks of a period
+
+    /** @brief Drain after @p ticks of running. */
+    double drainAt(std::uint64_t ticks) const {
+        return static_cast<double>(ticks / kPeriod) * drain[kPeriod] + drain[ticks % kPeriod];
+    }
+
+    /** @brief Distance after @p ticks of running, in cruise-equivalent seconds. */
+    double travelAt(std::uint64_t ticks) const {
+        return static_cast<double>(ticks / kPeriod) * travel[kPeriod] + travel[ticks % kPeriod];
+    }
+
+    /**
+     * @brief Fewest ticks of running after which drainAt() reaches @p target.
+     */
+    std::uint64_t ticksToDrain(double target) const;
+
+    /** @return Table for the constant-rate model (cruise speed, full load, every tick). */
+    static const EnergyTable& flat();
+};
+
+/** @brief Largest passenger count the model's load axis covers. */
+inline constexpr int kMaxEnergyLoad = 15;
+
+/**
+ * @brief Speed- and load-dependent consumption model of one vehicle type.
+ *
+ * Consumption per mile is split into a rolling part that scales with mass
+ * (vehicle plus passengers aboard) and an aerodynamic part that scales with
+ * the square of speed, calibrated so that cruise speed at full load matches
+ * the spec's energyUse. The model is sampled once into a speed x load grid;
+ * kwhPerMile() interpolates that grid bilinearly.
+ */
+class EnergyModel {
+public:
+    static constexpr std::size_t kSpeedBins = 31;        ///< Grid points from 0 to kMaxSpeedRatio x cruise (cruise is one)
+    static constexpr double kMaxSpeedRatio = 1.5;        ///< Highest speed on the grid, relative to cruise
+    static constexpr double kAeroShare = 0.4;            ///< Share of cruise consumption that is aerodynamic
+    static constexpr double kPassengerMassShare = 0.05;  ///< Mass each passenger adds, relative to the empty vehicle
+
+    /** @brief Samples the consumption grid for @p spec. */
+    explicit EnergyModel(const VehicleSpec& spec);
+
+    /**
+     * @brief Interpolated consumption.
+     *
+     * @param speed Miles per hour (clamped to the grid).
+     * @param load  Passengers aboard (clamped to 0..spec passengers).
+     * @return kWh per mile.
+     */
+    double kwhPerMile(double speed, double load) const;
+
+    /**
+     * @brief Integrates one period of @p profile into a drain table.
+     *
+     * @param profile Speed per tick, relative to cruise speed.
+     * @param load    Passengers aboard.
+     */
+    EnergyTable buildTable(const std::array<double, EnergyTable::kPeriod>& profile, double load) const;
+
+private:
+    VehicleSpec spec;                                          ///< Type being modelled
+    std::array<std::array<double, kMaxEnergyLoad + 1>, kSpeedBins> grid{}; ///< kWh/mile by speed bin and load
+};
+
+/**
+ * @brief Drive-cycle speed profile of a built-in kind, relative to cruise speed.
+ */
+const std::array<double, EnergyTable::kPeriod>& speedProfileFor(VehicleKind kind);
+
+/**
+ * @brief Drain table of a built-in kind carrying @p load passengers.
+ *
+ * All tables are built the first time any is requested and shared for the
+ * rest of the process. VehicleKind::Custom maps to EnergyTable::flat().
+ */
+const EnergyTable& energyTableFor(VehicleKind kind, int load);
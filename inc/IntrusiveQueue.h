@@ -0,0 +1,243 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "Tracing.h"
+
+/**
+ * @brief Link field an element embeds to be queued in an IntrusiveQueue.
+ *
+ * An element can sit in one queue per embedded link at a time.
+ */
+template<typename T>
+struct IntrusiveLink {
+    T* next = nullptr;  ///< Following element in the queue holding this one
+};
+
+/**
+ * @brief Test-and-test-and-set spinlock for very short critical sections.
+ *
+ * Spins on a plain load so waiters do not bounce the cache line, and yields
+ * after a while so a preempted holder can finish (e.g., more threads than cores).
+ */
+class SpinLock {
+public:
+    void lock() {
+        if (!flag.test_and_set(std::memory_order_acquire)) return;
+        // contended: the wait is a span on the timeline when tracing
+        TraceSpan wait("spin wait", "lock");
+        for (int spins = 0; flag.test_and_set(std::memory_order_acquire); ) {
+            while (flag.test(std::memory_order_relaxed)) {
+                if (++spins >= kSpinsBeforeYield) std::this_thread::yield();
+            }
+        }
+    }
+
+    bool try_lock() { return !flag.test_and_set(std::memory_order_acquire); }
+
+    void unlock() { flag.clear(std::memory_order_release); }
+
+private:
+    static constexpr int kSpinsBeforeYield = 64;  ///< Busy polls before yielding the core
+    std::atomic_flag flag;                        ///< Set while held
+};
+
+/**
+ * @brief Lock that does nothing, for queues only one thread touches.
+ */
+struct NullLock {
+    void lock() {}
+    bool try_lock() { return true; }
+    void unlock() {}
+};
+
+/**
+ * @brief FIFO queue threaded through a link field embedded in each element.
+ *
+ * Pushing and popping only rewrite link pointers: no node is allocated and
+ * there is no capacity to size, so moving an element from one queue to
+ * another is a pop and a push splice. Batches are linked outside the lock
+ * and spliced in with one pointer update. The queue does not own its
+ * elements.
+ *
+ * Lock defaults to SpinLock for cross-thread hand-off; NullLock gives the
+ * unsynchronized single-thread variant. Nothing blocks: consumers poll.
+ * When tracing (see TraceRecorder), batch operations record their lock
+ * hold as a span; single pushes and pops only show when the lock is contended.
+ *
+ * @tparam T    Element type.
+ * @tparam Link Pointer to the element's IntrusiveLink member.
+ * @tparam Lock Mutual exclusion for push/pop (SpinLock or NullLock).
+ */
+template<typename T, IntrusiveLink<T> T::*Link, typename Lock = SpinLock>
+class IntrusiveQueue {
+public:
+    IntrusiveQueue() = default;
+    IntrusiveQueue(const IntrusiveQueue&) = delete;
+    IntrusiveQueue& operator=(const IntrusiveQueue&) = delete;
+
+    /** @brief Appends @p item, which must not be in another queue through the same link. */
+    void push(T* item) {
+        (item->*Link).next = nullptr;
+        lock.lock();
+        append(item, item, 1);
+        lock.unlock();
+    }
+
+    /** @brief Appends a batch in order with one splice. */
+    void pushBatch(std::span<T* const> items) {
+        if (items.empty()) return;
+        for (size_t i = 0; i + 1 < items.size(); ++i) (items[i]->*Link).next = items[i + 1];
+        (items.back()->*Link).next = nullptr;
+        TraceSpan hold("queue splice", "lock", static_cast<std::int64_t>(items.size()));
+        lock.lock();
+        append(items.front(), items.back(), items.size());
+        lock.unlock();
+    }
+
+    /**
+     * @brief Removes the oldest element.
+     *
+     * @return The element, or nullptr if the queue is empty.
+     */
+    T* tryPop() {
+        lock.lock();
+        T* item = head;
+        if (item) {
+            head = (item->*Link).next;
+            if (!head) tail = nullptr;
+            (item->*Link).next = nullptr;
+            setCount(count - 1);
+        }
+        lock.unlock();
+        return item;
+    }
+
+    /**
+     * @brief Pops up to @p max elements, appending them to @p out in FIFO order.
+     *
+     * The elements are unlinked under the lock in one walk; @p out is filled after it is released.
+     *
+     * @return Number of elements popped.
+     */
+    template<typename Alloc>
+    size_t tryPopBatch(std::vector<T*, Alloc>& out, size_t max) {
+        TraceSpan hold("queue pop batch", "lock");
+        lock.lock();
+        const size_t n = max < count ? max : count;
+        T* first = head;
+        T* last = nullptr;
+        for (size_t i = 0; i < n; ++i) {
+            last = head;
+            head = (head->*Link).next;
+        }
+        if (!head) tail = nullptr;
+        setCount(count - n);
+        lock.unlock();
+        hold.setArg(static_cast<std::int64_t>(n));
+
+        for (T* item = first; n > 0; ) {
+            T* next = (item->*Link).next;
+            (item->*Link).next = nullptr;
+            out.push_back(item);
+            if (item == last) break;
+            item = next;
+        }
+        return n;
+    }
+
+    /**
+     * @brief Detaches every queued element at once and calls @p f on each, oldest first.
+     *
+     * Only the detach happens under the lock; @p f may push the element into any queue.
+     *
+     * @return Number of elements drained.
+     */
+    template<typename F>
+    size_t drain(F&& f) {
+        T* item;
+        size_t n;
+        {
+            TraceSpan hold("queue drain", "lock");
+            lock.lock();
+            item = head;
+            n = count;
+            head = tail = nullptr;
+            setCount(0);
+            lock.unlock();
+            hold.setArg(static_cast<std::int64_t>(n));
+        }
+
+        while (item) {
+            T* next = (item->*Link).next;
+            (item->*Link).next = nullptr;
+            f(item);
+            item = next;
+        }
+        return n;
+    }
+
+    /** @brief Forgets every queued element (their links are left as they are). */
+    void clear() {
+        lock.lock();
+        head = tail = nullptr;
+        setCount(0);
+        lock.unlock();
+    }
+
+    /** @return Number of elements currently queued. */
+    size_t size() {
+        lock.lock();
+        const size_t n = count;
+        lock.unlock();
+        return n;
+    }
+
+    /** @return true if the queue is empty. */
+    bool empty() { return size() == 0; }
+
+    /**
+     * @brief Returns the last published queue depth without locking.
+     *
+     * @return Number of elements as of the most recent push or pop.
+     */
+    size_t approxSize() const { return depth.load(std::memory_order_relaxed); }
+
+    /** @return Largest depth reached since construction or resetHighWater() (lock-free). */
+    size_t highWaterMark() const { return highWater.load(std::memory_order_relaxed); }
+
+    /** @brief Restarts high-water tracking from the current depth. */
+    void resetHighWater() {
+        lock.lock();
+        highWater.store(count, std::memory_order_relaxed);
+        lock.unlock();
+    }
+
+private:
+    /** @brief Links an already chained run [first, last] after the tail; caller holds the lock. */
+    void append(T* first, T* last, size_t n) {
+        if (tail) (tail->*Link).next = first;
+        else head = first;
+        tail = last;
+        setCount(count + n);
+        if (count > highWater.load(std::memory_order_relaxed)) highWater.store(count, std::memory_order_relaxed);
+    }
+
+    /** @brief Updates count and its lock-free mirror; caller holds the lock. */
+    void setCount(size_t n) {
+        count = n;
+        depth.store(n, std::memory_order_relaxed);
+    }
+
+    Lock lock;                          ///< Protects head, tail and count
+    T* head = nullptr;                  ///< Oldest element
+    T* tail = nullptr;                  ///< Newest element
+    size_t count = 0;                   ///< Elements currently queued
+    std::atomic<size_t> depth{0};       ///< Mirror of count for lock-free readers
+    std::atomic<size_t> highWater{0};   ///< Largest count seen
+};
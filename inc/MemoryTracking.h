@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <ostream>
+#include <type_traits>
+
+/**
+ * @brief Subsystems that memory is attributed to.
+ */
+enum class MemSubsystem {
+    Vehicles,          /**< Vehicle objects. */
+    RunnerScratch,     /**< Simulation::runnerBatches and runnerChunks, the runner stage's per-tick batches. */
+    DispatchScratch,   /**< Simulation::dispatchScratch and dispatchByKind, the dispatcher's batches. */
+    ChargeTimers,      /**< Simulation::chargeWheel buckets. */
+    StatsMap,          /**< VehicleStatsManager map nodes and stats objects. */
+    LogFormatting,     /**< Strings and streams built by BaseStats::log(). */
+    Test,              /**< Standalone containers of tests and benchmarks; never charged by a simulation. */
+    Count
+};
+
+/**
+ * @brief Opt-in, process-wide accounting of live bytes and allocation counts
+ *        per MemSubsystem.
+ *
+ * Disabled by default; while disabled each tracked allocation costs one
+ * relaxed load. Enable it at startup, before the simulation allocates, so
+ * every tracked block is seen both when allocated and when freed, or for a
+ * self-contained scope with ScopedEnable.
+ */
+class MemoryTracker {
+public:
+    /** @brief Counters of one subsystem at one point in time. */
+    struct Counts {
+        long long liveBytes = 0;     ///< Bytes currently allocated
+        long long peakBytes = 0;     ///< Highest liveBytes observed
+        long long allocations = 0;   ///< Allocations since tracking was enabled
+    };
+
+    /** @brief Returns the global tracker. */
+    static MemoryTracker& instance();
+
+    /** @brief Starts counting tracked allocations. */
+    void enable() { enabled.store(true, std::memory_order_relaxed); }
+
+    /** @brief Stops counting; blocks still live are not seen being freed. */
+    void disable() { enabled.store(false, std::memory_order_relaxed); }
+
+    /**
+     * @brief Counts allocations for its lifetime, then restores the previous state.
+     *
+     * For code that tracks after startup (tests, benchmarks): declare it
+     * before the objects it measures, so they are built and destroyed while
+     * counting and never free a block that was allocated untracked.
+     */
+    class ScopedEnable {
+    public:
+        ScopedEnable() : wasEnabled(instance().isEnabled()) { instance().enable(); }
+        ~ScopedEnable() { if (!wasEnabled) instance().disable(); }
+        ScopedEnable(const ScopedEnable&) = delete;
+        ScopedEnable& operator=(const ScopedEnable&) = delete;
+
+    private:
+        bool wasEnabled;  ///< State to restore
+    };
+
+    /** @return true if allocations are being counted. */
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /** @brief Records an allocation of @p bytes for @p sub. */
+    void onAlloc(MemSubsystem sub, std::size_t bytes) {
+        if (!isEnabled()) return;
+        Slot& s = slots[static_cast<std::size_t>(sub)];
+        long long live = s.liveBytes.fetch_add(static_cast<long long>(bytes), std::memory_order_relaxed)
+                       + static_cast<long long>(bytes);
+        s.allocations.fetch_add(1, std::memory_order_relaxed);
+        long long peak = s.peakBytes.load(std::memory_order_relaxed);
+        while (live > peak && !s.peakBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    }
+
+    /** @brief Records a deallocation of @p bytes for @p sub. */
+    void onFree(MemSubsystem sub, std::size_t bytes) {
+        if (!isEnabled()) return;
+        slots[static_cast<std::size_t>(sub)].liveBytes.fetch_sub(static_cast<long long>(bytes), std::memory_order_relaxed);
+    }
+
+    /** @return Current counters of @p sub. */
+    Counts counts(MemSubsystem sub) const;
+
+    /** @return Current counters of every subsystem, indexed by MemSubsystem. */
+    std::array<Counts, static_cast<std::size_t>(MemSubsystem::Count)> countsAll() const;
+
+    /** @return Printable name of @p sub. */
+    static const char* name(MemSubsystem sub);
+
+private:
+    MemoryTracker() = default;
+
+    /** @brief Counters of one subsystem, on its own cache line. */
+    struct alignas(64) Slot {
+        std::atomic<long long> liveBytes{0};
+        std::atomic<long long> peakBytes{0};
+        std::atomic<long long> allocations{0};
+    };
+
+    std::atomic<bool> enabled{false};                                    ///< Counting switch
+    std::array<Slot, static_cast<std::size_t>(MemSubsystem::Count)> slots; ///< Per-subsystem counters
+};
+
+/**
+ * @brief Standard-conforming allocator that attributes its memory to a subsystem.
+ *
+ * The subsystem travels with the allocator (and its rebinds), so containers
+ * such as std::deque account their internal chunk and map allocations too.
+ * It also follows a move or swap, so a container assigned a fresh tracked
+ * container takes over that one's subsystem.
+ */
+template<typename T>
+class TrackingAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    explicit TrackingAllocator(MemSubsystem sub = MemSubsystem::Count) noexcept : sub(sub) {}
+
+    template<typename U>
+    TrackingAllocator(const TrackingAllocator<U>& other) noexcept : sub(other.subsystem()) {}
+
+    T* allocate(std::size_t n) {
+        T* p = static_cast<T*>(::operator new(n * sizeof(T)));
+        if (sub != MemSubsystem::Count) MemoryTracker::instance().onAlloc(sub, n * sizeof(T));
+        return p;
+    }
+
+    void deallocate(T* p, std::size_t n) noexcept {
+        if (sub != MemSubsystem::Count) MemoryTracker::instance().onFree(sub, n * sizeof(T));
+        ::operator delete(p);
+    }
+
+    /** @return Subsystem this allocator charges. */
+    MemSubsystem subsystem() const noexcept { return sub; }
+
+    template<typename U>
+    bool operator==(const TrackingAllocator<U>& other) const noexcept { return sub == other.subsystem(); }
+
+private:
+    MemSubsystem sub;  ///< Subsystem charged; Count means untracked
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <thread>
+
+struct SimulationSnapshot;
+
+/**
+ * @brief Minimal HTTP/1.0 listener on loopback serving a metrics page.
+ *
+ * Every request (any path) is answered with the text produced by the render
+ * callback, typed as Prometheus text exposition format. Requests are served
+ * one at a time on the server's own thread, so a scrape never runs on, or
+ * waits for, a simulation worker.
+ */
+class MetricsServer {
+public:
+    /**
+     * @brief Creates a stopped server.
+     *
+     * @param render Produces the response body; called once per request.
+     */
+    explicit MetricsServer(std::function<std::string()> render);
+
+    /**
+     * @brief Stops the server if it is running.
+     */
+    ~MetricsServer();
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /**
+     * @brief Binds 127.0.0.1:@p port and starts serving.
+     *
+     * @param port TCP port; 0 picks a free ephemeral port (see port()).
+     * @return false if the socket could not be bound.
+     */
+    bool start(std::uint16_t port);
+
+    /**
+     * @brief Stops serving and closes the socket.
+     */
+    void stop();
+
+    /** @return Port actually bound, or 0 if not running. */
+    std::uint16_t port() const { return boundPort; }
+
+private:
+    /** @brief Accept loop, polling so stop() is noticed promptly. */
+    void serve();
+
+    /** @brief Reads one request from @p fd and writes the rendered response. */
+    void respond(int fd);
+
+    std::function<std::string()> render;  ///< Response body producer
+    std::thread worker;                   ///< Accept/respond thread
+    std::atomic<bool> running{false};     ///< Cleared by stop()
+    int listenFd = -1;                    ///< Listening socket
+    std::uint16_t boundPort = 0;          ///< Bound port
+};
+
+/**
+ * @brief Renders a snapshot in Prometheus text exposition format.
+ */
+std::string toPrometheus(const SimulationSnapshot& snap);
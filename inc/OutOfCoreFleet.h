@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "ChargeStationManager.h"
+#include "StationMetrics.h"
+#include "Vehicle.h"
+#include "VehicleSpecs.h"
+#include "VehicleStatsManager.h"
+
+/**
+ * @brief Where a vehicle is in its lifecycle, as stored in a FleetRecord.
+ */
+enum class FleetPhase : std::uint8_t {
+    Running,    /**< Driving; due at the tick the battery runs out. */
+    Waiting,    /**< Depleted and queued for a station; never due. */
+    Charging    /**< Holding a station; due at the tick the charge completes. */
+};
+
+/**
+ * @brief Fixed-size on-disk state of one vehicle in an out-of-core fleet.
+ *
+ * Plain data only: the type is a built-in VehicleKind, and everything a
+ * Vehicle would compute per tick follows from the kind and the phase's
+ * due tick, so a record is only written when its vehicle changes phase.
+ */
+struct FleetRecord {
+    static constexpr std::uint64_t kNever = std::numeric_limits<std::uint64_t>::max(); ///< Due tick of a waiting vehicle
+
+    std::uint64_t due = kNever;                ///< Tick of the next phase change
+    std::uint32_t depleted = 0;                ///< Tick the battery last ran out
+    VehicleKind kind = VehicleKind::Alpha;     ///< Built-in type
+    FleetPhase phase = FleetPhase::Running;    ///< Current phase
+    std::uint16_t reserved = 0;                ///< Padding, zero
+};
+static_assert(sizeof(FleetRecord) == 16, "FleetRecord is an on-disk format");
+
+/**
+ * @brief Fleet state in a memory-mapped file, split into fixed-size chunks.
+ *
+ * The file is a one-page header followed by the records, so chunks are
+ * page-aligned whenever the chunk size is a multiple of 256 records. The
+ * mapping is shared: the kernel pages chunks in on demand, evicts clean
+ * pages freely under memory pressure, and writes back only pages that were
+ * stored to, so a fleet may be much larger than RAM.
+ */
+class FleetFile {
+public:
+    /** @brief Creates (or truncates) @p path for @p count records; check isOpen() afterwards. */
+    static FleetFile create(const std::string& path, std::uint64_t count, std::size_t chunkRecords);
+
+    /** @brief Maps an existing fleet file; check isOpen() afterwards. */
+    static FleetFile open(const std::string& path);
+
+    FleetFile() = default;
+    ~FleetFile();
+    FleetFile(FleetFile&& other) noexcept;
+    FleetFile& operator=(FleetFile&& other) noexcept;
+    FleetFile(const FleetFile&) = delete;
+    FleetFile& operator=(const FleetFile&) = delete;
+
+    /** @return true if a valid file is mapped. */
+    bool isOpen() const { return base != nullptr; }
+
+    /** @return Records in the file. */
+    std::uint64_t size() const { return count; }
+
+    /** @return Records per chunk (the last chunk may be shorter). */
+    std::size_t chunkSize() const { return chunkRecords; }
+
+    /** @return Number of chunks. */
+    std::size_t chunkCount() const { return count == 0 ? 0 : static_cast<std::size_t>((count - 1) / chunkRecords + 1); }
+
+    /** @return Records of chunk @p index, straight from the mapping. */
+    std::span<FleetRecord> chunk(std::size_t index);
+
+    /** @return Record @p id. */
+    FleetRecord& operator[](std::uint64_t id) { return records[id]; }
+
+    /** @brief Asks the kernel to start reading chunk @p index in the background. */
+    void prefetch(std::size_t index);
+
+    /**
+     * @brief Done with chunk @p index for this pass.
+     *
+     * A chunk that was written is handed to writeback; either way its pages
+     * are marked as the first to reclaim, since a cyclic scan needs them last.
+     */
+    void retire(std::size_t index, bool dirty);
+
+    /** @brief Writes every dirty page back and waits for it. */
+    void flush();
+
+    /** @return Bytes mapped (header plus records). */
+    std::size_t mappedBytes() const { return length; }
+
+private:
+    /** @brief Byte range of chunk @p index within the mapping, widened to whole pages. */
+    std::pair<unsigned char*, std::size_t> pageRange(std::size_t index) const;
+
+    /** @brief Maps @p fd with @p bytes and validates the header. */
+    bool map(int fd, std::size_t bytes);
+
+    unsigned char* base = nullptr;       ///< Mapping base
+    std::size_t length = 0;              ///< Mapping length
+    FleetRecord* records = nullptr;      ///< First record (one page past base)
+    std::uint64_t count = 0;             ///< Records
+    std::size_t chunkRecords = 0;        ///< Records per chunk
+};
+
+/**
+ * @brief Configuration of an out-of-core run.
+ */
+struct OutOfCoreConfig {
+    std::string path;                           ///< Fleet file, created (or truncated) by run()
+    std::uint64_t fleetSize = 20;               ///< Vehicles
+    int stations = 3;                           ///< Charging stations
+    std::chrono::seconds duration{2000};        ///< Simulated duration
+    std::size_t chunkRecords = 65536;           ///< Records per chunk (1 MiB)
+    unsigned seed = 1;                          ///< Seed of the default random type mix
+    VehicleStatsManager* stats = nullptr;       ///< Stats sink (nullptr = VehicleStatsManager::getInstance())
+
+    /** @brief Type of vehicle @p id (uniform random over the built-in kinds by default). */
+    std::function<VehicleKind(std::uint64_t id)> kindOf;
+};
+
+/**
+ * @brief Counters of an out-of-core run.
+ */
+struct OutOfCoreStats {
+    std::uint64_t ticks = 0;            ///< Ticks simulated
+    std::uint64_t chunkScans = 0;       ///< Chunks streamed through the kernel
+    std::uint64_t chunkSkips = 0;       ///< Chunks skipped because nothing in them was due
+    std::uint64_t dirtyChunks = 0;      ///< Chunk scans that wrote at least one record
+    std::uint64_t phaseChanges = 0;     ///< Records rewritten (depletions, dispatches, charges)
+    std::uint64_t bytesScanned = 0;     ///< Record bytes streamed
+    std::size_t mappedBytes = 0;        ///< Size of the fleet file
+    size_t waitQueueHighWater = 0;      ///< Most vehicle ids queued for a station at once
+    double wallSeconds = 0;             ///< Wall time of the tick loop
+};
+
+/**
+ * @brief Runs a fleet whose state lives in a FleetFile rather than in Vehicle objects.
+ *
+ * Each tick streams the chunks through a tick kernel in file order,
+ * prefetching the next chunk due while the current one is processed. RAM
+ * holds only one due-tick summary per chunk, kept ordered by due tick, so
+ * finding the due chunks costs only the chunks that are due and the rest are
+ * skipped without being touched; the station queue of depleted vehicles
+ * holds 32-bit ids rather than pointers.
+ *
+ * Lifecycles match the coroutine mode of Simulation (run until depleted,
+ * wait FIFO for a station, charge until full), and stats go to the same
+ * VehicleStatsManager types. Runs are unpaced: they go as fast as the
+ * mapping can be streamed.
+ */
+class OutOfCoreSimulation {
+public:
+    explicit OutOfCoreSimulation(const OutOfCoreConfig& config);
+
+    /**
+     * @brief Creates the fleet file, simulates the configured duration and flushes the file.
+     *
+     * @return false if the file could not be created or the fleet does not fit 32-bit ids.
+     */
+    bool run();
+
+    /** @return Counters of the last run. */
+    const OutOfCoreStats& stats() const { return counters; }
+
+    /** @return Station utilization, waits and throughput of the last run. */
+    StationReport stationReport() const { return stationMetrics.report(); }
+
+    /** @brief Prints the run counters and the station report. */
+    void printResults(std::ostream& os) const;
+
+private:
+    /** @brief Per-kind constants of one lifecycle. */
+    struct Profile {
+        std::uint64_t driveTicks = 1;       ///< Running ticks from full to empty
+        std::uint64_t chargeTicks = 1;      ///< Charging ticks from empty to full
+        std::unique_ptr<Vehicle> cycle;     ///< Vehicle holding one full run and one full charge, for recording
+        std::unique_ptr<Vehicle> idle;      ///< Vehicle with nothing run or charged this cycle
+        std::unique_ptr<Vehicle> partial;   ///< Scratch vehicle for a phase cut short by the end of the run
+    };
+
+    /** @brief Writes the initial records and the chunk summaries. */
+    void deploy();
+
+    /** @brief Applies every phase change due at @p tick in chunk @p index; returns true if it wrote. */
+    bool runChunk(std::size_t index, std::uint64_t tick);
+
+    /** @brief Sets the earliest due tick of chunk @p index and reschedules it. */
+    void scheduleChunk(std::size_t index, std::uint64_t due);
+
+    /** @brief Hands free stations to queued vehicles in FIFO order. */
+    void dispatch(std::uint64_t tick);
+
+    /** @return Manager the run records into. */
+    VehicleStatsManager& statsManager() const {
+        return config.stats ? *config.stats : VehicleStatsManager::getInstance();
+    }
+
+    /** @brief Records @p v under @p stat @p count times, in bulk. */
+    void recordRepeated(Vehicle& v, StatType stat, std::uint64_t count);
+
+    /** @brief Records this tick's depletions, dispatches and completed charges per kind. */
+    void recordTick();
+
+    /** @brief Credits the partial phase of every vehicle at the end of the run. */
+    void finish(std::uint64_t tick);
+
+    OutOfCoreConfig config;                              ///< Run parameters
+    FleetFile file;                                      ///< Mapped fleet state
+    std::vector<std::uint64_t> nextDue;                  ///< Earliest due tick per chunk
+    std::set<std::pair<std::uint64_t, std::size_t>> dueChunks; ///< (due tick, chunk) of every chunk with a phase change ahead
+    std::vector<std::size_t> dueNow;                     ///< Chunks due this tick, in file order
+    std::deque<std::uint32_t> waitQueue;                 ///< Ids of vehicles waiting for a station
+    std::array<Profile, kBuiltinVehicleKinds> profiles;  ///< Lifecycle constants per kind
+    std::array<std::uint64_t, kBuiltinVehicleKinds> depletedNow{}; ///< Depletions this tick, per kind
+    std::array<std::uint64_t, kBuiltinVehicleKinds> dispatchedNow{}; ///< Stations acquired this tick, per kind
+    std::array<std::uint64_t, kBuiltinVehicleKinds> chargedNow{};  ///< Completed charges this tick, per kind
+    std::vector<Vehicle*> repeatScratch;                 ///< Repeated vehicle pointers for bulk records
+    ChargeStationManager stationManager;                 ///< Station pool
+    StationMetrics stationMetrics;                       ///< Station utilization and waits
+    OutOfCoreStats counters;                             ///< Run counters
+};
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "SimulationContext.h"
+#include "VehicleSpecs.h"
+
+/** @brief Bumped whenever a change to the simulation alters results, invalidating cached records. */
+inline constexpr int kSweepModelVersion = 1;
+
+/**
+ * @brief Relative share of each built-in vehicle kind in a fleet.
+ */
+struct TypeMix {
+    std::string name = "uniform";                                  ///< Label shown in the table
+    std::array<double, kBuiltinVehicleKinds> weights{1, 1, 1, 1, 1}; ///< Weight per built-in kind
+
+    /**
+     * @brief Parses "uniform" or "+"-separated Type:weight terms, e.g. "Alpha:3+Echo:1".
+     *
+     * Kinds not named get weight 0. The text becomes the mix's name.
+     *
+     * @return false if a type is unknown, a weight is negative or every weight is 0.
+     */
+    static bool parse(const std::string& text, TypeMix& out);
+};
+
+/**
+ * @brief One configuration of a sweep.
+ */
+struct SweepPoint {
+    int stations = 3;                       ///< Charging stations
+    int fleetSize = 20;                     ///< Vehicles deployed
+    TypeMix mix;                            ///< Type mix of the fleet
+    unsigned seed = 1;                      ///< Seed of the fleet draw
+    std::chrono::seconds duration{2000};    ///< Simulated duration
+
+    /** @return Every input of the result as text; equal texts give equal results. */
+    std::string canonical() const;
+
+    /** @return 64-bit FNV-1a hash of canonical(), the cache key. */
+    std::uint64_t key() const;
+
+    /** @return Relative cost used to schedule the largest points first. */
+    double cost() const { return static_cast<double>(fleetSize) * static_cast<double>(duration.count()); }
+};
+
+/**
+ * @brief Figures kept per point, in the cache and in the table.
+ */
+struct SweepMetrics {
+    double runs = 0;                    ///< Runs completed
+    double distance = 0;                ///< Miles driven
+    double passengerMiles = 0;          ///< Sum of passengers × miles
+    double faults = 0;                  ///< Expected faults
+    double charges = 0;                 ///< Charges completed
+    double utilizationPct = 0;          ///< Station utilization
+    double idleWhileQueuedPct = 0;      ///< Ticks ending with a free station and a vehicle waiting
+    double chargesPerStationHour = 0;   ///< Station throughput
+    double meanWaitSeconds = 0;         ///< Mean depletion-to-acquire wait
+    double p99WaitSeconds = 0;          ///< 99th percentile wait
+    double maxWaitSeconds = 0;          ///< Longest wait
+    double wallSeconds = 0;             ///< Time the computation took
+
+    /** @return Metrics of a finished run. */
+    static SweepMetrics from(const SimulationResult& result);
+};
+
+/**
+ * @brief A point with its metrics, as it appears in the table.
+ */
+struct SweepRow {
+    SweepPoint point;       ///< Configuration
+    SweepMetrics metrics;   ///< Its results
+    bool cached = false;    ///< Taken from the cache rather than computed by this sweep
+};
+
+/**
+ * @brief Cartesian grid of station counts × fleet sizes × type mixes × seeds.
+ */
+struct SweepGrid {
+    std::vector<int> stations{3};           ///< Station counts
+    std::vector<int> fleetSizes{20};        ///< Fleet sizes
+    std::vector<TypeMix> mixes{TypeMix()};  ///< Type mixes
+    std::vector<unsigned> seeds{1};         ///< Seeds; every point is run once per seed
+    std::chrono::seconds duration{2000};    ///< Simulated duration of every point
+
+    /**
+     * @brief Parses ";"-separated axes, e.g. "stations=1,2,4;fleet=20,50;mix=uniform|Alpha:3+Echo:1;seeds=1,2".
+     *
+     * Axes not given keep their defaults; duration is left unchanged.
+     *
+     * @return false on an unknown axis or a malformed value.
+     */
+    static bool parse(const std::string& text, SweepGrid& out);
+
+    /** @return Every point, stations varying slowest and seeds fastest. */
+    std::vector<SweepPoint> points() const;
+};
+
+/**
+ * @brief On-disk memo of sweep results keyed by SweepPoint::key().
+ *
+ * The store is a text file of one tab-separated record per point (key,
+ * canonical configuration, metrics), loaded whole on construction and
+ * appended to and flushed as each point finishes, so an interrupted sweep
+ * keeps the points it completed. A record whose canonical text differs from
+ * the point looked up (a hash collision) is a miss. Bumping
+ * kSweepModelVersion when simulation behaviour changes orphans old records.
+ */
+class SweepCache {
+public:
+    /**
+     * @brief Loads the records of @p path; an empty path keeps the cache in memory.
+     */
+    explicit SweepCache(const std::string& path = "");
+
+    /** @return true and the cached metrics in @p out if @p point has a record. */
+    bool find(const SweepPoint& point, SweepMetrics& out) const;
+
+    /** @brief Records @p metrics for @p point and appends it to the file. Thread-safe. */
+    void store(const SweepPoint& point, const SweepMetrics& metrics);
+
+    /** @return Points with a record. */
+    size_t size() const;
+
+    /** @return false if the file could not be appended to. */
+    bool writable() const { return fileOk; }
+
+private:
+    /** @brief A record: the canonical text guards against hash collisions. */
+    struct Entry {
+        std::string canonical;      ///< SweepPoint::canonical() of the point
+        SweepMetrics metrics;       ///< Its metrics
+    };
+
+    std::string path;                                       ///< Backing file (empty = in memory)
+    mutable std::mutex mtx;                                 ///< Guards entries and the file
+    std::unordered_map<std::uint64_t, Entry> entries;       ///< Records by key
+    bool fileOk = true;                                     ///< Last append succeeded
+};
+
+/**
+ * @brief Counts of a finished sweep.
+ */
+struct SweepSummary {
+    size_t points = 0;          ///< Points in the grid
+    size_t cached = 0;          ///< Served from the cache
+    size_t computed = 0;        ///< Simulated by this sweep
+    double wallSeconds = 0;     ///< Wall-clock duration of the sweep
+};
+
+/**
+ * @brief Runs every point of a grid that the cache does not hold, in parallel.
+ *
+ * Uncached points are handed out largest first (SweepPoint::cost()) to
+ * worker threads, so the longest runs start early and the short ones fill
+ * in at the end instead of leaving one core busy with a straggler. Each
+ * worker owns a SimulationContext with a CPU budget of one core, which
+ * keeps its runs deterministic and independent of the other workers;
+ * results are therefore reproducible from the configuration and the seed.
+ */
+class ParameterSweep {
+public:
+    /**
+     * @param grid  Points to cover.
+     * @param cache Results already known; new results are stored into it.
+     * @param jobs  Worker threads (0 = one per hardware thread).
+     */
+    ParameterSweep(const SweepGrid& grid, SweepCache& cache, size_t jobs = 0);
+
+    /** @return One row per grid point, in grid order. */
+    const std::vector<SweepRow>& run();
+
+    /** @return Rows of the last run(). */
+    const std::vector<SweepRow>& rows() const { return table; }
+
+    /** @return Counts of the last run(). */
+    const SweepSummary& summary() const { return totals; }
+
+    /** @return Metrics of @p point simulated in @p context. */
+    static SweepMetrics simulate(const SweepPoint& point, SimulationContext& context);
+
+private:
+    SweepGrid grid;                 ///< Points to cover
+    SweepCache& cache;              ///< Memo of results
+    size_t jobs;                    ///< Worker threads
+    std::vector<SweepRow> table;    ///< Rows of the last run
+    SweepSummary totals;            ///< Counts of the last run
+};
+
+/**
+ * @brief Writes the rows as one table, a line per point.
+ */
+void printSweepTable(std::ostream& os, const std::vector<SweepRow>& rows);
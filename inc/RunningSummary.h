@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Count, mean, variance, min and max of a stream of samples.
+ *
+ * add() updates the mean and the sum of squared deviations with Welford's
+ * method, so the variance stays accurate over long runs. merge() combines
+ * two summaries as if every sample had been added to one (Chan et al.), and
+ * is associative and commutative: partial summaries from threads, shards or
+ * replicas can be reduced in any order or as a tree.
+ *
+ * Plain data, so it can be copied into snapshots and shared memory as is.
+ */
+struct RunningSummary {
+    double count = 0;  ///< Samples seen
+    double mean = 0;   ///< Running mean
+    double m2 = 0;     ///< Sum of squared deviations from the mean
+    double min = 0;    ///< Smallest sample (0 while empty)
+    double max = 0;    ///< Largest sample (0 while empty)
+
+    /** @brief Adds one sample. */
+    void add(double x) {
+        if (count == 0) {
+            min = max = x;
+        } else {
+            min = std::min(min, x);
+            max = std::max(max, x);
+        }
+        count += 1;
+        const double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+    }
+
+    /** @brief Adds @p n samples equal to @p x in one step. */
+    void addRepeated(double x, double n) {
+        if (n > 0) merge(RunningSummary{n, x, 0, x, x});
+    }
+
+    /** @brief Folds @p other into this summary. */
+    void merge(const RunningSummary& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        const double n = count + other.count;
+        const double delta = other.mean - mean;
+        mean += delta * other.count / n;
+        m2 += other.m2 + delta * delta * count * other.count / n;
+        count = n;
+        min = std::min(min, other.min);
+        max = std::max(max, other.max);
+    }
+
+    /** @return Sample variance (0 with fewer than two samples). */
+    double variance() const { return count > 1 ? m2 / (count - 1) : 0; }
+
+    /** @return Sample standard deviation. */
+    double stddev() const { return std::sqrt(variance()); }
+};
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+#include "SharedStatsSlot.h"
+#include "Simulation.h"
+
+/**
+ * @brief Configuration of a multi-process sharded run.
+ */
+struct ShardConfig {
+    int shards = 2;                    ///< Worker processes
+    int fleetSize = 20;                ///< Vehicles across all shards
+    int stations = 3;                  ///< Charging stations shared by all shards
+    int timeSliceMs = 10;              ///< Real ms per simulated second in every shard
+    std::chrono::seconds duration{2000}; ///< Simulated duration of every shard
+
+    /** @brief Builds a shard's deployment for its share of the fleet (random mix by default). */
+    std::function<std::unique_ptr<VehicleDeployment>(int fleetSize)> deployment;
+};
+
+/**
+ * @brief Splits the fleet across local worker processes that share one station pool.
+ *
+ * The coordinator maps a POSIX shared-memory region, then forks one worker
+ * per shard. Each worker runs its slice of the fleet as an ordinary
+ * pipeline-mode Simulation whose ChargeStationManager counts stations in the
+ * region's lock-free counter, and publishes its per-type stats to its own
+ * SharedStatsSlot in the region, live and at the end. The coordinator
+ * merges the slots with mergeSnapshot(), summaries included; no sockets or
+ * other IPC are involved.
+ *
+ * Shards share wall-clock pacing only, so station contention between shards
+ * is meaningful when timeSliceMs > 0.
+ */
+class ShardedSimulation {
+public:
+    static constexpr int kMaxShards = 64;         ///< Slots in the shared region
+
+    /** @brief Lifecycle of one worker, as published in its slot. */
+    enum class ShardState : int { Starting, Running, Done, Failed };
+
+    /** @brief Live or final view of one shard. */
+    struct ShardStatus {
+        ShardState state = ShardState::Starting;  ///< Worker lifecycle
+        long simulatedSeconds = 0;                ///< Ticks the shard completed
+        int vehicles = 0;                         ///< Vehicles in the shard
+        int stationsLowWater = 0;                 ///< Fewest shared stations free after one of its acquires
+    };
+
+    explicit ShardedSimulation(const ShardConfig& config);
+    ~ShardedSimulation();
+
+    ShardedSimulation(const ShardedSimulation&) = delete;
+    ShardedSimulation& operator=(const ShardedSimulation&) = delete;
+
+    /**
+     * @brief Forks the workers, waits for all of them and merges their results.
+     *
+     * @return true if every worker finished normally.
+     */
+    bool run();
+
+    /**
+     * @brief Per-type stats summed over all shards.
+     *
+     * Safe to call while run() is in progress (e.g., from a monitoring
+     * thread); reads never block the workers.
+     */
+    std::map<std::string, VehicleStatsSnapshot> mergedStats() const;
+
+    /**
+     * @brief Per-type stats of shard @p index.
+     *
+     * A slot left torn by a worker that died mid-publish yields the last
+     * consistent copy read from it (empty if none was).
+     */
+    std::map<std::string, VehicleStatsSnapshot> shardStats(int index) const;
+
+    /** @return Status of shard @p index. */
+    ShardStatus shardStatus(int index) const;
+
+    /** @return Free stations in the shared pool. */
+    int stationsAvailable() const;
+
+    /** @brief Prints per-shard progress and the merged per-type stats. */
+    void printResults(std::ostream& os) const;
+
+private:
+    struct Region;
+
+    void runShard(int index);
+    int shardFleet(int index) const;
+
+    ShardConfig config;             ///< Run parameters
+    Region* region = nullptr;       ///< Mapped shared-memory region
+    std::vector<pid_t> workers;     ///< Worker pids, by shard
+
+    mutable std::mutex readMtx;     ///< Guards lastRead
+    mutable std::vector<std::map<std::string, VehicleStatsSnapshot>> lastRead; ///< Last consistent stats per shard
+};
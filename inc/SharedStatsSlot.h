@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <string>
+
+#include "BaseStats.h"
+
+class VehicleStatsManager;
+
+/**
+ * @brief Per-type stats one process publishes into shared memory for another to read.
+ *
+ * Holds only lock-free atomics and plain data written before it is
+ * published, so it is valid in every process that maps it (place it in a
+ * MAP_SHARED region). One writer publishes under a seqlock; readers copy
+ * a consistent view without blocking it.
+ */
+class SharedStatsSlot {
+public:
+    static constexpr int kMaxTypes = 16;          ///< Vehicle types per slot
+    static constexpr size_t kMaxTypeName = 32;    ///< Bytes per type name, including the terminator
+    static constexpr int kReadAttempts = 4096;    ///< Reads of a slot being published before giving up
+
+    /** @brief Publishes @p stats (types beyond kMaxTypes are dropped). Single writer. */
+    void publish(const std::map<std::string, VehicleStatsSnapshot>& stats);
+
+    /**
+     * @brief Copies the last published stats into @p out, averages recomputed.
+     *
+     * Retries while the writer is publishing, up to kReadAttempts times: a
+     * writer that died mid-publish leaves the slot torn for good.
+     *
+     * @return false, with @p out unchanged, if no consistent copy was seen.
+     */
+    bool read(std::map<std::string, VehicleStatsSnapshot>& out) const;
+
+    /**
+     * @brief Stats recorded into @p manager, for publishing.
+     *
+     * Types whose totals are all zero (e.g., registered by a parent process
+     * before fork() but never touched here) are left out.
+     */
+    static std::map<std::string, VehicleStatsSnapshot> recordedStats(const VehicleStatsManager& manager);
+
+private:
+    // snapshot totals in the order they are stored; averages are recomputed on read
+    static constexpr double VehicleStatsSnapshot::* kTotals[] = {
+        &VehicleStatsSnapshot::totalTime,
+        &VehicleStatsSnapshot::totalTestVehicle,
+        &VehicleStatsSnapshot::totalDistance,
+        &VehicleStatsSnapshot::totalChargedVehicle,
+        &VehicleStatsSnapshot::totalChargeTime,
+        &VehicleStatsSnapshot::totalFaults,
+        &VehicleStatsSnapshot::totalPassengersMiles,
+    };
+    // per-type summaries and their fields, stored after the totals
+    static constexpr RunningSummary VehicleStatsSnapshot::* kSummaries[] = {
+        &VehicleStatsSnapshot::runTime,
+        &VehicleStatsSnapshot::runDistance,
+        &VehicleStatsSnapshot::chargeTime,
+    };
+    static constexpr double RunningSummary::* kSummaryFields[] = {
+        &RunningSummary::count, &RunningSummary::mean, &RunningSummary::m2, &RunningSummary::min, &RunningSummary::max,
+    };
+    static constexpr size_t kTotalCount = std::size(kTotals);
+    static constexpr size_t kSummaryFieldCount = std::size(kSummaryFields);
+    static constexpr size_t kValueCount = kTotalCount + std::size(kSummaries) * kSummaryFieldCount;
+
+    /** @brief Value @p i of a snapshot flattened as totals, then summary fields. */
+    static double& valueAt(VehicleStatsSnapshot& snap, size_t i);
+
+    struct TypeRecord {
+        char name[kMaxTypeName];                  ///< Written once, before typeCount covers it
+        std::atomic<double> values[kValueCount];  ///< Totals, then summaries; written under the seqlock
+    };
+
+    std::atomic<unsigned> seq{0};                 ///< Seqlock; odd while the writer publishes
+    std::atomic<int> typeCount{0};                ///< Published TypeRecords
+    TypeRecord types[kMaxTypes];                  ///< Per-type values
+
+#ifdef UNIT_TESTING
+    friend class ShardedSimulationTest;           ///< Simulates a writer dying mid-publish
+#endif
+};
@@ -6,12 +6,29 @@
 #include <atomic>
 #include <chrono>
 #include <random>
+#include <map>
+#include <array>
+#include <span>
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <ostream>
 
-#include "ThreadSafeQueue.h"
+#include "IntrusiveQueue.h"
 #include "Vehicle.h"
 #include "ChargeStationManager.h"
 #include "VehicleStatsManager.h"
 #include "Factories.h"
+#include "VehicleKernels.h"
+#include "TimingWheel.h"
+#include "ThreadPlacement.h"
+#include "CoroutineExecutor.h"
+#include "WorkerPool.h"
+#include "MemoryTracking.h"
+#include "CycleExport.h"
+#include "TickPacer.h"
+#include "AdaptiveScaler.h"
+#include "StationMetrics.h"
 
 /**
  * @brief Strategy interface for defining how vehicles are created and deployed into the simulation.
@@ -42,8 +59,11 @@ class VehicleRandomDeployment : public VehicleDeployment {
 public:
     /**
      * @brief Constructs the randomized deployment strategy and initializes the factories.
+     *
+     * @param fleetSize Number of vehicles produced by deployVehicles().
+     * @param seed      Seed of the type mix, for reproducible fleets; 0 seeds from std::random_device.
      */
-    VehicleRandomDeployment();
+    explicit VehicleRandomDeployment(int fleetSize = 20, unsigned seed = 0);
 
     /**
      * @brief Creates a randomized set of vehicles from the available factories.
@@ -54,18 +74,109 @@ public:
 
 private:
     std::vector<std::unique_ptr<VehicleFactory>> factories; ///< Registered factories
-    std::mt19937 gen{std::random_device{}()};               ///< Random number generator
+    std::mt19937 gen;                                       ///< Random number generator
+    int fleetSize;                                          ///< Vehicles per deployment
+};
+
+/**
+ * @brief Pipeline stages, used to attribute CPU time.
+ */
+enum class Stage {
+    Runner,       /**< Running vehicles (and, in coroutine mode, the whole executor). */
+    Dispatcher,   /**< Assigning depleted vehicles to stations. */
+    Charger       /**< Charging vehicles. */
+};
+
+/**
+ * @brief Consistent live view of a running simulation.
+ *
+ * Produced by Simulation::snapshot() from lock-free mirrors, so building one
+ * costs the worker threads nothing.
+ */
+struct SimulationSnapshot {
+    long simulatedSeconds = 0;                          ///< Runner ticks completed so far
+    double wallSeconds = 0;                             ///< Wall-clock seconds since the run started
+    std::map<std::string, VehicleStatsSnapshot> stats;  ///< Per-type stats
+    size_t runQueueDepth = 0;                           ///< Vehicles waiting to run
+    size_t needChargeQueueDepth = 0;                    ///< Vehicles waiting for a station
+    size_t chargeQueueDepth = 0;                        ///< Vehicles charging
+    size_t runQueueHighWater = 0;                       ///< Deepest the run queue has been this run
+    size_t needChargeQueueHighWater = 0;                ///< Deepest the need-charge queue has been this run
+    size_t chargeQueueHighWater = 0;                    ///< Deepest the charge hand-off queue has been this run
+    int stationsAvailable = 0;                          ///< Free charging stations
+    int stationsTotal = 0;                              ///< Configured charging stations
+    int stationsLowWater = 0;                           ///< Fewest free stations an acquire left this run
+    std::array<double, 3> stageCpuMs{};                 ///< CPU time per Stage (completed work)
+    PacingStats pacing;                                 ///< Real-time pacing of the simulation clock
+    size_t workersInUse = 0;                            ///< Pipeline workers across all stages, driving thread included
+    size_t runnerWorkers = 0;                           ///< Pipeline workers given to the runner stage
+    StationReport stationReport;                        ///< Station utilization, waits and throughput this run
 };
 
+/**
+ * @brief Writes a short human-readable summary of a snapshot.
+ */
+std::ostream& operator<<(std::ostream& os, const SimulationSnapshot& snap);
+
+/**
+ * @brief Selects how vehicle lifecycles are executed.
+ */
+enum class ExecutionMode {
+    Pipeline,     /**< Stage work submitted as tasks to one shared worker pool each tick (default). */
+    Threads,      /**< One dedicated thread per stage handing vehicles through queues. */
+    Coroutines    /**< One coroutine per vehicle on a single-threaded virtual-clock executor. */
+};
+
+/**
+ * @brief Parameters one what-if branch changes at the branch point.
+ */
+struct BranchSpec {
+    std::string name;                                          ///< Label in the side-by-side report
+    int stations = -1;                                         ///< Station count from the branch point on (-1 = unchanged)
+    std::array<int, kBuiltinVehicleKinds> addVehicles{};       ///< Vehicles of each built-in kind joining the fleet
+
+    /**
+     * @brief Parses comma-separated changes, e.g. "stations=5,Alpha+10".
+     *
+     * "stations=N" sets the station count and "<Type>+N" adds N vehicles of a
+     * built-in type; an empty spec is the unchanged baseline. The spec text
+     * is the branch name.
+     *
+     * @return false if an item is malformed or names an unknown type.
+     */
+    static bool parse(const std::string& text, BranchSpec& out);
+};
+
+/**
+ * @brief Outcome of one what-if branch, covering the whole run (shared prefix included).
+ */
+struct BranchResult {
+    std::string name;                                   ///< BranchSpec::name
+    bool ok = false;                                    ///< The branch process finished normally
+    long simulatedSeconds = 0;                          ///< Ticks completed
+    int stations = 0;                                   ///< Stations at the end of the run
+    size_t vehicles = 0;                                ///< Fleet size at the end of the run
+    std::map<std::string, VehicleStatsSnapshot> stats;  ///< Per-type stats
+    StationReport stationReport;                        ///< Station utilization, waits and throughput
+};
+
+/**
+ * @brief Prints branch results as a table, one column per branch.
+ */
+void printBranchResults(std::ostream& os, const std::vector<BranchResult>& results);
+
 /**
  * @brief Central controller for the multi-threaded EV simulation.
  *
- * The Simulation class launches three worker threads:
- *  - **Runner thread:** run vehicle.
+ * The Simulation pipeline has three stages:
+ *  - **Runner:** run vehicle.
  *  - **Need-charge dispatcher:** acquire station and push them to chargers.
- *  - **Charger thread:** charge vehicle and reintroduces charged vehicles into the run queue.
+ *  - **Charger:** charge vehicle and reintroduces charged vehicles into the run queue.
  *
- * It coordinates these threads through several ThreadSafeQueue instances and synchronizes access
+ * By default (ExecutionMode::Pipeline) each tick's stage work is submitted to
+ * one shared WorkerPool, runner work split into chunks, so cores follow
+ * whichever stage is loaded. ExecutionMode::Threads keeps one dedicated
+ * thread per stage. It coordinates the stages through several IntrusiveQueue instances and synchronizes access
  * to limited charging-station resources via ChargeStationManager.
  */
 class Simulation {
@@ -85,37 +196,344 @@ public:
      */
     void setDeployment(std::unique_ptr<VehicleDeployment> deploy);
 
+    /**
+     * @brief Pins the worker stages to CPUs for subsequent runs in ExecutionMode::Threads.
+     *
+     * When the runner is pinned, the fleet is also deployed from a thread on
+     * the runner's CPU so its memory is first-touched on the runner's NUMA node.
+     * The other modes have no per-stage threads and ignore the placement.
+     *
+     * @param placement Per-stage CPU ids; negative ids leave a stage unpinned.
+     */
+    void setPlacement(const StagePlacement& placement) { this->placement = placement; }
+
+    /**
+     * @brief Chooses between stage threads and coroutine agents for subsequent runs.
+     *
+     * In ExecutionMode::Coroutines each vehicle is a coroutine that co_awaits
+     * simulated time and station availability; all agents run on the thread
+     * calling runSimulation(), paced at msTimeSlice per simulated second
+     * (a time slice of 0 runs as fast as possible).
+     */
+    void setExecutionMode(ExecutionMode mode) { this->mode = mode; }
+
+    /**
+     * @brief Writes one row per completed run/charge cycle to @p path in subsequent runs.
+     *
+     * The file is columnar (see CycleExporter) and can be scanned with
+     * CycleFile. Rows are buffered per worker thread and written in the
+     * background; the file is complete when runSimulation() returns.
+     *
+     * @param path Output file; empty disables the export (default).
+     */
+    void setCycleExport(const std::string& path) { cycleExportPath = path; }
+
+    /**
+     * @brief Suppresses the end-of-run console report and stats log (for shard workers).
+     */
+    void setQuiet(bool value) { quiet = value; }
+
+    /**
+     * @brief Chooses what the real-time clock does when a tick overruns its deadline.
+     *
+     * Ticks are paced against absolute deadlines (see TickPacer), so work
+     * time never accumulates as drift; this only matters for ticks whose
+     * work takes longer than the time slice.
+     */
+    void setOverrunPolicy(OverrunPolicy policy) { overrunPolicy = policy; }
+
+    /**
+     * @brief Caps the cores a pipeline-mode run may use.
+     *
+     * Within the cap, an AdaptiveScaler grows and shrinks the workers given
+     * to each stage from queue depths and stage CPU time, so a run only
+     * keeps busy the cores its current phase needs.
+     *
+     * @param cores Most workers, including the driving thread; 0 = all cores (default).
+     */
+    void setCpuBudget(size_t cores) { cpuBudget = cores; }
+
+    /**
+     * @brief Draws charging stations from a counter shared with other processes.
+     *
+     * @param available Lock-free free-station counter, e.g., in shared memory.
+     */
+    void attachSharedStations(std::atomic<int>* available) { stationManager.attachShared(available); }
+
+    /**
+     * @brief Records the stats of subsequent runs into @p manager instead of the default instance.
+     *
+     * @param manager Must outlive the simulation.
+     */
+    void setStatsManager(VehicleStatsManager& manager) { vehicleStats = &manager; }
+
+    /** @return Manager the simulation records stats into. */
+    VehicleStatsManager& statsManager() const { return *vehicleStats; }
+
+    /**
+     * @brief Changes the number of charging stations for subsequent runs.
+     *
+     * Every station is free again at the start of a run.
+     */
+    void setStations(int stations) { stationManager.setTotal(stations); }
+
+    /** @brief Changes the real-time milliseconds per simulated second for subsequent runs (0 = unpaced). */
+    void setTimeSliceMs(int timeSliceMs) { msTimeSlice = timeSliceMs; }
+
     /**
      * @brief Launches the simulation for a specified duration.
      *
      * This function:
      *  - Builds the initial vehicle list using the deployment strategy.
-     *  - Starts three worker threads.
+     *  - Runs the stages in the configured ExecutionMode.
      *  - Runs until the simulated time expires.
-     *  - Signals all threads to stop, joins them, and produces statistics.
+     *  - Stops the stages and produces statistics, including CPU time per stage.
      *
      * @param simulatedDuration How long the simulated world should run.
      */
     void runSimulation(std::chrono::seconds simulatedDuration);
 
+    /**
+     * @brief Returns a live view of per-type stats, queue depths and station usage.
+     *
+     * Safe to call from any thread while runSimulation() is in progress.
+     */
+    SimulationSnapshot snapshot() const;
+
+    /**
+     * @brief Returns the tracked allocations of @p sub since the last run entered its
+     *        steady-state window (its second half); 0 if it never did.
+     */
+    long long steadyStateAllocations(MemSubsystem sub) const;
+
+    /**
+     * @brief Prints a snapshot to the console every @p interval simulated seconds.
+     *
+     * @param interval Reporting period; zero disables periodic reports (default).
+     */
+    void setReportInterval(std::chrono::seconds interval) { reportInterval = interval; }
+
+    /**
+     * @brief Ends a running simulation early; runSimulation() then shuts down
+     *        the workers and prints the final statistics as usual.
+     *
+     * Safe to call from any thread.
+     */
+    void requestStop();
+
+    /**
+     * @brief Runs to @p branchAt, then finishes the run once per branch, each with its own changes.
+     *
+     * At the branch point the pipeline is quiesced (the tick is complete
+     * and the pool's threads are joined) and the process forks once per
+     * branch, so every branch starts from the same fleet, queues, timers and
+     * stats, shared copy-on-write: only pages a branch writes are copied.
+     * Each branch applies its BranchSpec and runs to @p duration in
+     * parallel with the others, on an equal share of the CPU budget; this
+     * process waits for them and does not simulate past the branch point.
+     *
+     * Runs in ExecutionMode::Pipeline whatever mode is set; the cycle export
+     * is not written. Output of the prefix and branches is quiet.
+     *
+     * @return One result per branch, in order.
+     */
+    std::vector<BranchResult> runBranches(std::chrono::seconds branchAt, std::chrono::seconds duration,
+                                          const std::vector<BranchSpec>& branches);
+
 private:
+    struct BranchSlot;
+
+    /**
+     * @brief Quiesces the pipeline and forks one process per pending branch.
+     *
+     * @return true in a branch process, with its spec applied and the pool restarted;
+     *         false in this process once every branch has exited.
+     */
+    bool forkBranches();
+
+    /** @brief Applies a branch's station count and added vehicles at the current tick. */
+    void applyBranch(const BranchSpec& spec);
+
+    /** @brief Sizes the stage worker pool from the CPU budget and activates the scaler's allocation. */
+    void startPipelinePool(const ScalerConfig& scalerConfig);
+
+    /** @brief Lifecycle phase of a coroutine agent. */
+    enum class AgentPhase { Running, Waiting, Charging, None };
+
+    /** @brief Per-vehicle bookkeeping for coroutine mode. */
+    struct AgentSlot {
+        explicit AgentSlot(Vehicle* v) : vehicle(v) {}
+
+        Vehicle* vehicle;                    ///< Vehicle driven by this agent
+        AgentPhase phase = AgentPhase::None; ///< Current lifecycle phase
+        std::uint64_t phaseStart = 0;        ///< Tick on which the phase began
+        AgentTask task;                      ///< Owning handle to the agent coroutine
+    };
+
+    /** @brief Runs the stages as pool tasks, tick by tick, until the duration elapses or a stop is requested. */
+    void runPipeline(std::chrono::seconds simulatedDuration);
+
+    /**
+     * @brief Ends a driver-paced tick: publishes the tick, prints a due report and waits for the tick's deadline.
+     *
+     * @return false if a stop was requested.
+     */
+    bool finishTick(std::uint64_t tick);
+
+    /** @brief Samples station occupancy and waiting vehicles at the end of a tick. */
+    void sampleStations();
+
+    /** @brief Activates the pool workers and runner share an allocation asks for. */
+    void applyAllocation(const WorkerAllocation& alloc);
+
+    /** @brief Sizes the dispatcher's batches for the deployed fleet and station pool. */
+    void reserveDispatchScratch();
+
+    /** @brief Drains this tick's run queue into runnerBatches, grouped by kind. */
+    void collectRunnerBatches();
+
+    /** @brief Runs one second for a same-kind chunk and routes each vehicle to the run or need-charge queue. */
+    void runChunk(std::span<Vehicle* const> chunk);
+
+    /** @brief Non-blocking dispatch: moves as many waiting vehicles to chargeQueue as stations are free, in one batch. */
+    void dispatchAvailable();
+
+    /**
+     * @brief Hands up to @p stations waiting vehicles to chargeQueue in one batch.
+     *
+     * The caller already holds @p stations slots; any it cannot use are released.
+     */
+    void dispatchBatch(int stations);
+
+    /** @brief One charger tick: schedules new arrivals and completes due charges. */
+    void chargerTick();
+
+    /** @brief Credits partial charging time to vehicles still on the wheel and clears it. */
+    void drainChargeWheel();
+
+    /** @brief Records a finished run phase and stamps the depletion tick. */
+    void onDepleted(Vehicle& v, long tick);
+
+    /** @brief Records a station acquisition and stamps its tick. */
+    void onStationAcquired(Vehicle& v, long tick);
+
+    /** @brief Batched onStationAcquired(): stamps every vehicle and records the stats in bulk. */
+    void onStationsAcquired(std::span<Vehicle* const> batch, long tick);
+
+    /** @brief Records a finished charge, exports the completed cycle and starts the next one. */
+    void onCharged(Vehicle& v, long tick);
+
+    /** @return Runner ticks completed so far in the current run. */
+    long currentTick() const { return simulatedSeconds.load(std::memory_order_relaxed); }
+
+    /** @brief Records memory counters at the start of the steady-state window (second half of the run). */
+    void markSteadyState();
+
+    /** @brief Prints per-subsystem live/peak bytes and allocations per tick for the finished run. */
+    void printMemoryReport(std::ostream& os) const;
+
+    /** @brief Prints tick lateness percentiles and overruns of the simulation clock. */
+    void printPacingReport(std::ostream& os) const;
+
+    /** @return CPU milliseconds attributed to @p stage in the current run. */
+    double stageCpuMs(Stage stage) const {
+        return stageCpuNs[static_cast<size_t>(stage)].load(std::memory_order_relaxed) / 1e6;
+    }
+
+    /** @brief Runs the three stage threads until the duration elapses or a stop is requested. */
+    void runThreads(std::chrono::seconds simulatedDuration);
+
+    /** @brief Runs the whole fleet as coroutine agents until the duration elapses or a stop is requested. */
+    void runCoroutines(std::chrono::seconds simulatedDuration);
+
+    /** @brief One vehicle's run / wait / charge lifecycle as a coroutine. */
+    AgentTask vehicleAgent(AgentSlot& slot, SimExecutor& exec, StationAwaitable& stations);
+
+    /** @brief Moves an agent to a new phase and updates the live phase counts. */
+    void enterPhase(AgentSlot& slot, AgentPhase phase, std::uint64_t tick);
+
+    /** @return Number of coroutine agents currently in @p phase. */
+    size_t agentCount(AgentPhase phase) const {
+        return agentPhaseCounts[static_cast<size_t>(phase)].load(std::memory_order_relaxed);
+    }
+
     /** @brief Worker thread that runs vehicles for each time slice and checks whether they require charging. */
     void runnerThreadFunc();
 
     /** @brief Worker thread that transfers depleted vehicles into the charging queue. */
     void needChargeDispatcherFunc();
 
-    /** @brief Worker thread that performs the charging simulation and returns vehicles to the run queue. */
+    /**
+     * @brief Worker thread that performs the charging simulation and returns vehicles to the run queue.
+     *
+     * Each vehicle popped from chargeQueue gets one timer on chargeWheel at its completion tick;
+     * per-tick work is proportional to the charges completing, not the vehicles charging.
+     */
     void chargerThreadFunc();
 
-    ThreadSafeQueue<Vehicle*> runQueue;          ///< Vehicles that are actively running
-    ThreadSafeQueue<Vehicle*> needChargeQueue;   ///< Vehicles that require charging
-    ThreadSafeQueue<Vehicle*> chargeQueue;       ///< Vehicles currently charging
+    /**
+     * @brief Vehicle hand-off queue linked through Vehicle::queueLink.
+     *
+     * A vehicle sits in at most one queue, so moving it between stages only
+     * rewrites link pointers: the queues own no storage and never allocate.
+     */
+    using VehicleQueue = IntrusiveQueue<Vehicle, &Vehicle::queueLink>;
+
+    VehicleQueue runQueue;          ///< Vehicles that are actively running
+    VehicleQueue needChargeQueue;   ///< Vehicles that require charging
+    VehicleQueue chargeQueue;       ///< Vehicles that just acquired a station
+
+    /** @brief Pending charge completion for one vehicle. */
+    struct ChargeTimer {
+        Vehicle* vehicle;          ///< Vehicle holding a station
+        std::uint64_t startTick;   ///< Charger tick on which charging began
+    };
+    /** @brief Completion timers whose buckets are charged to MemSubsystem::ChargeTimers. */
+    using ChargeWheel = HierarchicalTimingWheel<ChargeTimer, 6, 4, TrackingAllocator<ChargeTimer>>;
+    ChargeWheel chargeWheel{0, TrackingAllocator<ChargeTimer>(MemSubsystem::ChargeTimers)}; ///< Charger-owned completion timers
+    std::atomic<size_t> chargingVehicles{0};          ///< Mirror of chargeWheel.size() for snapshots
+
+    ExecutionMode mode = ExecutionMode::Pipeline;     ///< Execution mode for runSimulation()
+    std::unique_ptr<WorkerPool> pool;                 ///< Shared stage worker pool, created on first pipeline run
+    size_t cpuBudget = 0;                             ///< Pipeline core cap (0 = all cores)
+    AdaptiveScaler scaler;                            ///< Sizes the pipeline stage workers each window
+    std::atomic<size_t> workersInUse{0};              ///< Mirror of the allocation total for snapshots
+    std::atomic<size_t> runnerWorkers{0};             ///< Mirror of the runner allocation for snapshots
+    std::vector<std::span<Vehicle* const>, TrackingAllocator<std::span<Vehicle* const>>> runnerChunks{
+        TrackingAllocator<std::span<Vehicle* const>>(MemSubsystem::RunnerScratch)}; ///< This tick's runner tasks
+    std::array<std::atomic<long long>, 3> stageCpuNs{};  ///< CPU nanoseconds per Stage
+
+    using MemCounts = std::array<MemoryTracker::Counts, static_cast<size_t>(MemSubsystem::Count)>;
+    std::uint64_t runEndTick = 0;     ///< Duration of the current run in ticks
+    MemCounts memAtStart{};           ///< Tracked memory when the run started
+    MemCounts memAtSteady{};          ///< Tracked memory at the start of the steady-state window
+    long steadyTick = -1;             ///< Tick at which memAtSteady was taken (-1 = not yet)
+    std::vector<AgentSlot> agents;                    ///< Coroutine agents, one per vehicle
+    std::array<std::atomic<size_t>, 3> agentPhaseCounts{}; ///< Agents per phase, for snapshots
 
     std::vector<std::unique_ptr<Vehicle>> vehicles; ///< All vehicles created for the simulation
+    std::string cycleExportPath;                    ///< Per-cycle export file ("" = off)
+    std::unique_ptr<CycleExporter> cycleExporter;   ///< Open while a run with export is in progress
     ChargeStationManager stationManager;            ///< Manages access to limited charging stations
+    VehicleStatsManager* vehicleStats = &VehicleStatsManager::getInstance(); ///< Where runs record their stats
 
     std::atomic<bool> stopFlag{false};              ///< Global stop condition for all threads
+    std::atomic<long> simulatedSeconds{0};          ///< Runner ticks completed in the current run
+    std::atomic<long long> runStartNs{0};           ///< steady_clock time the current run started (0 = never)
+
+    std::chrono::seconds reportInterval{0};         ///< Periodic snapshot report period (0 = off)
+    bool quiet = false;                             ///< Skip the end-of-run report
+    OverrunPolicy overrunPolicy = OverrunPolicy::CatchUp; ///< Pacing reaction to overrunning ticks
+    TickPacer pacer;                                ///< Paces the simulation clock (runner / driver loop)
+    TickPacer chargerPacer;                         ///< Paces the charger thread in ExecutionMode::Threads
+    StationMetrics stationMetrics;                  ///< Station utilization, waits and idle time this run
+    const std::vector<BranchSpec>* pendingBranches = nullptr; ///< Branches to fork at branchTick (runBranches())
+    std::uint64_t branchTick = 0;                   ///< Tick after which the branches fork
+    BranchSlot* branchSlots = nullptr;              ///< Shared result slots, one per pending branch
+    int branchIndex = -1;                           ///< Branch this process runs (-1 = not a branch)
+    bool stopRequested = false;                     ///< Set by requestStop(), guarded by waitMutex
+    std::mutex waitMutex;                           ///< Guards stopRequested
+    std::condition_variable waitCv;                 ///< Wakes runSimulation() for reports or early stop
     std::unique_ptr<VehicleDeployment> deployment;  ///< Vehicle creation strategy
 
     std::thread runnerThread;        ///< Thread responsible for running vehicles
@@ -123,6 +541,15 @@ private:
     std::thread chargerThread;       ///< Thread responsible for charging vehicles
 
     int msTimeSlice;                 ///< Real-time milliseconds per simulated in-world second
+    StagePlacement placement;        ///< Per-stage CPU pinning (unpinned by default)
+
+    /** @brief Stage scratch batch whose storage is charged to one MemSubsystem. */
+    using ScratchBatch = std::vector<Vehicle*, TrackingAllocator<Vehicle*>>;
+    using ScratchKindBatches = std::array<ScratchBatch, kVehicleKindCount>;
+
+    ScratchKindBatches runnerBatches;   ///< Runner-stage per-kind scratch batches, reused every tick
+    ScratchBatch dispatchScratch{TrackingAllocator<Vehicle*>(MemSubsystem::DispatchScratch)}; ///< Dispatcher-stage batch, reused every dispatch
+    ScratchKindBatches dispatchByKind;  ///< dispatchScratch grouped by kind for bulk stats
 
 #ifdef UNIT_TESTING
     friend class RunnerLogicTest;    ///< For unit-test access to internals
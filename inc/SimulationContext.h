@@ -0,0 +1,98 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "Simulation.h"
+#include "StationMetrics.h"
+#include "TickPacer.h"
+#include "VehicleStatsManager.h"
+
+/**
+ * @brief Everything one batch run of the simulation depends on.
+ */
+struct SimulationConfig {
+    int stations = 3;                                   ///< Charging stations
+    int fleetSize = 20;                                 ///< Vehicles deployed
+    int timeSliceMs = 0;                                ///< Real ms per simulated second (0 = unpaced)
+    std::chrono::seconds duration{2000};                ///< Simulated duration
+    ExecutionMode mode = ExecutionMode::Pipeline;       ///< How lifecycles execute
+    size_t cpuBudget = 0;                               ///< Pipeline core cap (0 = all cores)
+    OverrunPolicy overrun = OverrunPolicy::CatchUp;     ///< Pacing reaction to overrunning ticks
+    unsigned seed = 0;                                  ///< Seed of the random type mix (0 = random)
+
+    /** @brief Builds the fleet (seeded random mix of fleetSize vehicles by default). */
+    std::function<std::unique_ptr<VehicleDeployment>(const SimulationConfig& config)> deployment;
+};
+
+/**
+ * @brief Outcome of one run of a SimulationContext.
+ */
+struct SimulationResult {
+    long simulatedSeconds = 0;                          ///< Ticks completed
+    double wallSeconds = 0;                             ///< Wall-clock duration of the run
+    std::map<std::string, VehicleStatsSnapshot> stats;  ///< Per-type stats of this run only
+    StationReport stationReport;                        ///< Station utilization, waits and throughput
+    std::array<double, 3> stageCpuMs{};                 ///< CPU time per Stage
+};
+
+/**
+ * @brief Instance-scoped entry point for embedding the simulation: configure, run, read, reset.
+ *
+ * A context owns its Simulation and its own VehicleStatsManager, so runs
+ * never read or write the process-wide stats, and any number of contexts
+ * can live in one process. Running again reuses the simulation's worker
+ * pool and scratch buffers, so a sweep over many small configurations
+ * pays for thread start-up once rather than per scenario.
+ *
+ * Runs are quiet (nothing is printed or logged); one context runs one
+ * configuration at a time.
+ */
+class SimulationContext {
+public:
+    explicit SimulationContext(const SimulationConfig& config = SimulationConfig());
+
+    SimulationContext(const SimulationContext&) = delete;
+    SimulationContext& operator=(const SimulationContext&) = delete;
+
+    /** @brief Replaces the configuration used by the next run(). */
+    void configure(const SimulationConfig& config) { settings = config; }
+
+    /** @return Configuration of the next run(). */
+    const SimulationConfig& config() const { return settings; }
+
+    /**
+     * @brief Runs the configured scenario from a clean slate and keeps its result.
+     *
+     * Stats of earlier runs are cleared first, so the result covers this run only.
+     *
+     * @return Result of this run, valid until the next run() or reset().
+     */
+    const SimulationResult& run();
+
+    /** @return Result of the last run() (empty if none since construction or reset()). */
+    const SimulationResult& result() const { return last; }
+
+    /** @brief Clears the stats and the last result; the pool and buffers stay warm. */
+    void reset();
+
+    /** @return Stats manager the context's runs record into. */
+    VehicleStatsManager& stats() { return statsManager; }
+
+    /** @return Underlying simulation, for settings SimulationConfig does not cover. */
+    Simulation& simulation() { return sim; }
+
+private:
+    /** @brief Pushes the configuration into the simulation. */
+    void apply();
+
+    SimulationConfig settings;          ///< Configuration of the next run
+    VehicleStatsManager statsManager;   ///< This context's stats; declared before sim, which records into it
+    Simulation sim;                     ///< Reused across runs
+    SimulationResult last;              ///< Result of the last run
+};
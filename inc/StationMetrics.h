@@ -0,0 +1,85 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include "TickPacer.h"
+
+/**
+ * @brief Charging-station capacity figures of a run, as of a snapshot.
+ *
+ * Times are simulated seconds (ticks).
+ */
+struct StationReport {
+    int stations = 0;                    ///< Configured stations (at the latest sample)
+    std::uint64_t ticks = 0;             ///< Ticks sampled
+    double utilizationPct = 0;           ///< Busy station-ticks over available station-ticks
+    double idleWhileQueuedPct = 0;       ///< Share of ticks ending with a free station and a vehicle waiting
+    std::uint64_t charges = 0;           ///< Charges completed
+    double chargesPerStationHour = 0;    ///< Charges completed per station per simulated hour
+    double meanChargeSeconds = 0;        ///< Mean station occupancy per completed charge
+    std::uint64_t waits = 0;             ///< Stations acquired
+    double meanWaitSeconds = 0;          ///< Mean time from depletion to acquiring a station
+    std::uint64_t p50WaitSeconds = 0;    ///< Median wait
+    std::uint64_t p90WaitSeconds = 0;    ///< 90th percentile wait
+    std::uint64_t p99WaitSeconds = 0;    ///< 99th percentile wait
+    std::uint64_t maxWaitSeconds = 0;    ///< Longest wait
+};
+
+/**
+ * @brief Writes the report as a few human-readable lines.
+ */
+std::ostream& operator<<(std::ostream& os, const StationReport& report);
+
+/**
+ * @brief Station-level instrumentation: utilization, queue wait and idle time.
+ *
+ * Fed from the simulation's existing tick stamps, so it adds no clock reads:
+ * a wait (depletion to acquire) is recorded by the dispatching stage, a
+ * completed charge by the charging stage, and once per tick the driving
+ * thread samples how many stations are busy and how many vehicles wait.
+ * Every counter is a relaxed atomic, so report() may run on any thread.
+ */
+class StationMetrics {
+public:
+    /** @brief Clears every measurement for a run over @p stations stations. */
+    void reset(int stations);
+
+    /** @brief Samples later ticks against @p stations stations, keeping the measurements so far. */
+    void setStations(int stations) { this->stations.store(stations, std::memory_order_relaxed); }
+
+    /** @brief Records @p count stations acquired @p ticks after their vehicles depleted. */
+    void recordWait(std::uint64_t ticks, std::uint64_t count = 1) {
+        waitHistogram.record(ticks, count);
+        waitTicks.fetch_add(ticks * count, std::memory_order_relaxed);
+    }
+
+    /** @brief Records @p count charges that each held their station for @p ticks. */
+    void recordCharge(std::uint64_t ticks, std::uint64_t count = 1) {
+        charges.fetch_add(count, std::memory_order_relaxed);
+        chargeTicks.fetch_add(ticks * count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Samples station occupancy at the end of a tick.
+     *
+     * @param busy    Stations occupied.
+     * @param waiting Vehicles waiting for a station.
+     * @param repeat  Consecutive ticks that ended in this same state.
+     */
+    void sampleTick(int busy, size_t waiting, std::uint64_t repeat = 1);
+
+    /** @return Figures so far. */
+    StationReport report() const;
+
+private:
+    std::atomic<int> stations{0};                 ///< Configured stations
+    LatencyHistogram waitHistogram;               ///< Depletion-to-acquire waits (ticks)
+    std::atomic<std::uint64_t> waitTicks{0};      ///< Sum of waits
+    std::atomic<std::uint64_t> charges{0};        ///< Charges completed
+    std::atomic<std::uint64_t> chargeTicks{0};    ///< Sum of station occupancy of completed charges
+    std::atomic<std::uint64_t> ticks{0};          ///< Ticks sampled
+    std::atomic<std::uint64_t> stationTicks{0};   ///< Sum of configured stations over sampled ticks
+    std::atomic<std::uint64_t> busyTicks{0};      ///< Sum of busy stations over sampled ticks
+    std::atomic<std::uint64_t> idleQueuedTicks{0};///< Ticks ending with a free station and a vehicle waiting
+};
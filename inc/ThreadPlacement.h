@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+
+/**
+ * @brief CPU placement for the simulation's worker stages.
+ *
+ * A negative CPU id leaves that stage unpinned. Pinning uses Linux thread
+ * affinity; on other platforms, or if the kernel rejects the CPU, it is a
+ * no-op and the thread keeps running wherever the scheduler puts it.
+ *
+ * Memory placement follows the kernel's first-touch policy: data a pinned
+ * stage allocates and first writes (its queue nodes, timer buckets, and for
+ * the runner the fleet itself) lands on that CPU's NUMA node.
+ */
+struct StagePlacement {
+    int runnerCpu = -1;       ///< CPU for the runner thread (and fleet allocation)
+    int dispatcherCpu = -1;   ///< CPU for the need-charge dispatcher thread
+    int chargerCpu = -1;      ///< CPU for the charger thread
+
+    /**
+     * @brief Parses "runner,dispatcher,charger" CPU ids, e.g. "0,2,4".
+     *
+     * Missing or malformed fields stay unpinned.
+     */
+    static StagePlacement parse(const std::string& spec);
+
+    /** @return true if any stage is pinned. */
+    bool any() const { return runnerCpu >= 0 || dispatcherCpu >= 0 || chargerCpu >= 0; }
+};
+
+/**
+ * @brief Pins the calling thread to one CPU.
+ *
+ * @param cpu CPU id; negative means leave the thread unpinned.
+ * @return true if the affinity was applied, false on no-op or failure.
+ */
+bool pinCurrentThread(int cpu);
+
+/**
+ * @brief Returns the NUMA node a CPU belongs to, or -1 if unknown.
+ */
+int numaNodeOfCpu(int cpu);
@@ -1,9 +1,12 @@
 #pragma once
 
 #include <queue>
+#include <deque>
+#include <memory>
 #include <mutex>
 #include <condition_variable>
 #include <optional>
+#include <atomic>
 
 /**
  * @brief A thread-safe FIFO queue with blocking and non-blocking pop operations.
@@ -11,9 +14,10 @@
  * This class provides a minimal thread-safe queue implementation suitable
  * for producer/consumer patterns used in runner, dispatcher,
  * and charger threads.
- * @tparam T The type of elements stored in the queue.
+ * @tparam T     The type of elements stored in the queue.
+ * @tparam Alloc Allocator for the underlying deque (e.g., TrackingAllocator).
  */
-template<typename T>
+template<typename T, typename Alloc = std::allocator<T>>
 class ThreadSafeQueue {
 public:
     /**
@@ -21,6 +25,11 @@ public:
      */
     ThreadSafeQueue() = default;
 
+    /**
+     * @brief Constructs an empty thread-safe queue using the given allocator.
+     */
+    explicit ThreadSafeQueue(const Alloc& alloc) : q(alloc) {}
+
     /**
      * @brief Pushes a new element into the queue.
      *
@@ -32,6 +41,7 @@ public:
         {
             std::lock_guard<std::mutex> lock(mtx);
             q.push(v);
+            depth.store(q.size(), std::memory_order_relaxed);
         }
         cv.notify_one();
     }
@@ -49,6 +59,7 @@ public:
         cv.wait(lock, [&]{ return !q.empty(); });
         T t = std::move(q.front());
         q.pop();
+        depth.store(q.size(), std::memory_order_relaxed);
         return t;
     }
 
@@ -63,6 +74,7 @@ public:
         if (q.empty()) return std::nullopt;
         T t = std::move(q.front());
         q.pop();
+        depth.store(q.size(), std::memory_order_relaxed);
         return t;
     }
 
@@ -95,8 +107,19 @@ public:
         return q.size();
     }
 
+    /**
+     * @brief Returns the last published queue depth without locking.
+     *
+     * Intended for monitoring readers: it never contends with producers or
+     * consumers, and may lag a concurrent push/pop by one operation.
+     *
+     * @return Number of elements as of the most recent push or pop.
+     */
+    size_t approxSize() const { return depth.load(std::memory_order_relaxed); }
+
 private:
     mutable std::mutex mtx;              ///< Protects access to the queue
     std::condition_variable cv;          ///< Used to block/wake waiting threads
-    std::queue<T> q;                     ///< The underlying standard queue
+    std::queue<T, std::deque<T, Alloc>> q; ///< The underlying standard queue
+    std::atomic<size_t> depth{0};        ///< Mirror of q.size() for lock-free readers
 };
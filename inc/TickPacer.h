@@ -0,0 +1,138 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief What a TickPacer does when a tick's work ends after its deadline.
+ */
+enum class OverrunPolicy {
+    CatchUp,   /**< Keep every deadline; late ticks run back to back until on schedule again (default). */
+    Skip,      /**< Drop the missed deadlines and wait for the next one: a SlowDown by whole periods. */
+    SlowDown   /**< Shift every later deadline by the overrun, stretching the timeline. */
+};
+
+/** @return Lower-case policy name ("catchup", "skip", "slowdown"). */
+const char* overrunPolicyName(OverrunPolicy policy);
+
+/**
+ * @brief Parses an overrun policy name; unknown names give OverrunPolicy::CatchUp.
+ */
+OverrunPolicy parseOverrunPolicy(const char* name);
+
+/**
+ * @brief Lock-free histogram of durations for percentile reports.
+ *
+ * Values are non-negative integers in whatever unit the caller records:
+ * microseconds for tick lateness, simulated seconds for station waits.
+ *
+ * Log-linear buckets: exact below 16, then 16 buckets per power of two,
+ * so any reported percentile is within about 6% of the true value. One
+ * writer and any number of concurrent readers.
+ */
+class LatencyHistogram {
+public:
+    static constexpr std::size_t kSubBuckets = 16;                        ///< Buckets per power of two
+    static constexpr std::size_t kBuckets = kSubBuckets * (64 - 4 + 1);   ///< Covers every 64-bit value
+
+    /** @brief Adds @p count samples of the same value. */
+    void record(std::uint64_t us, std::uint64_t count = 1);
+
+    /** @return Samples recorded. */
+    std::uint64_t count() const { return total.load(std::memory_order_relaxed); }
+
+    /** @return Largest sample recorded. */
+    std::uint64_t max() const { return largest.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Smallest bucket bound at or below which a fraction @p q of the samples lie.
+     *
+     * @param q Quantile in [0, 1], e.g. 0.99.
+     * @return Value in the recorded unit (0 while empty).
+     */
+    std::uint64_t percentile(double q) const;
+
+    /** @brief Drops every sample. */
+    void clear();
+
+private:
+    static std::size_t bucketOf(std::uint64_t us);
+    static std::uint64_t upperBound(std::size_t bucket);
+
+    std::array<std::atomic<std::uint64_t>, kBuckets> buckets{};  ///< Samples per bucket
+    std::atomic<std::uint64_t> total{0};                         ///< Samples overall
+    std::atomic<std::uint64_t> largest{0};                       ///< Largest sample
+};
+
+/**
+ * @brief Pacing quality of one real-time clock, as of a snapshot.
+ */
+struct PacingStats {
+    std::uint64_t ticks = 0;         ///< Deadlines waited for
+    std::uint64_t overruns = 0;      ///< Ticks whose work ended after their deadline
+    std::uint64_t skippedTicks = 0;  ///< Deadlines dropped by OverrunPolicy::Skip
+    double driftMs = 0;              ///< How far SlowDown/Skip moved the schedule behind the original grid
+    double p50LatenessMs = 0;        ///< Median lateness of tick starts against their deadline
+    double p99LatenessMs = 0;        ///< 99th percentile lateness
+    double maxLatenessMs = 0;        ///< Worst lateness
+};
+
+/**
+ * @brief Paces a simulation loop against absolute deadlines on the steady clock.
+ *
+ * Tick k is due at start + k * period (plus any shift applied by the overrun
+ * policy), and waitNext() sleeps until that deadline with sleep_until(), so
+ * time spent doing the tick's work is absorbed rather than added to the
+ * period: simulated time does not drift behind wall time as the load grows.
+ *
+ * Each waitNext() advances the simulation by exactly one tick, whatever the
+ * policy. Skip therefore does not drop simulated work: it drops the passed
+ * deadlines and moves the schedule behind by whole periods, so ticks keep
+ * the grid's phase while the timeline stretches like SlowDown.
+ *
+ * Every tick's lateness (how long after its deadline the next tick starts,
+ * from OS wake-up jitter or an overrun) is recorded in a histogram. The
+ * pacer is driven by one thread; stats() may be read from any thread.
+ */
+class TickPacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @param period Wall time per tick; zero disables pacing and measurement.
+     * @param policy Reaction to overruns.
+     */
+    explicit TickPacer(std::chrono::microseconds period = std::chrono::microseconds(0),
+                       OverrunPolicy policy = OverrunPolicy::CatchUp);
+
+    /** @brief Sets the period and policy; takes effect at the next start(). */
+    void configure(std::chrono::microseconds period, OverrunPolicy policy);
+
+    /** @brief Anchors tick 0 at now and clears the measurements. */
+    void start();
+
+    /**
+     * @brief Ends the current tick: waits for the next deadline, or applies the overrun policy if it has passed.
+     */
+    void waitNext();
+
+    /** @return Pacing quality so far (safe from any thread). */
+    PacingStats stats() const;
+
+    /** @return Configured overrun policy. */
+    OverrunPolicy policy() const { return overrunPolicy; }
+
+private:
+    std::chrono::microseconds period;           ///< Wall time per tick
+    OverrunPolicy overrunPolicy;                ///< Reaction to overruns
+    Clock::time_point origin;                   ///< Deadline of tick 0
+    Clock::duration shift{0};                   ///< Added to every later deadline by Skip/SlowDown
+    std::uint64_t tick = 0;                     ///< Ticks completed
+
+    LatencyHistogram lateness;                  ///< Per-tick lateness (us)
+    std::atomic<std::uint64_t> overruns{0};     ///< Ticks that missed their deadline
+    std::atomic<std::uint64_t> skipped{0};      ///< Deadlines dropped by Skip
+    std::atomic<std::int64_t> shiftUs{0};       ///< Mirror of shift for readers
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Hierarchical timing wheel keyed on absolute simulated ticks.
+ *
+ * Timers are placed on the level matching the most significant SlotBits-wide
+ * digit in which their due tick differs from the current tick. Each advance()
+ * moves the clock by one tick, cascades the higher-level bucket that just came
+ * into range down to finer levels, and expires only the level-0 bucket that is
+ * due. Cost per tick is proportional to the timers expiring (plus amortized
+ * cascading), not to the number of timers pending.
+ *
+ * Timers further out than the wheel's span wait in an overflow list that is
+ * re-examined once per full rotation of the top level.
+ *
+ * Not thread-safe; intended to be owned by a single worker thread.
+ *
+ * @tparam T        Payload carried by each timer.
+ * @tparam SlotBits log2 of the number of slots per level.
+ * @tparam Levels   Number of levels.
+ * @tparam Alloc    Allocator of the buckets, rebound to their entry type.
+ */
+template<typename T, unsigned SlotBits = 6, unsigned Levels = 4, typename Alloc = std::allocator<T>>
+class HierarchicalTimingWheel {
+    struct Entry {
+        std::uint64_t due;  ///< Absolute tick on which the timer expires
+        T item;             ///< Timer payload
+    };
+    using Bucket = std::vector<Entry, typename std::allocator_traits<Alloc>::template rebind_alloc<Entry>>;
+
+public:
+    static constexpr std::size_t kSlots = std::size_t{1} << SlotBits;  ///< Slots per level
+    static constexpr std::uint64_t kSpan = std::uint64_t{1} << (SlotBits * Levels); ///< Ticks covered by the wheel
+
+    /**
+     * @brief Constructs an empty wheel whose clock reads @p startTick; every bucket allocates through @p alloc.
+     */
+    explicit HierarchicalTimingWheel(std::uint64_t startTick = 0, const Alloc& alloc = Alloc())
+        : overflow(alloc), scratch(alloc), expiring(alloc), now(startTick) {
+        for (auto& level : wheel)
+            for (auto& bucket : level) bucket = Bucket(alloc);
+    }
+
+    /**
+     * @brief Schedules @p item to expire on tick @p due.
+     *
+     * A due tick at or before the current tick expires on the next advance().
+     */
+    void schedule(std::uint64_t due, T item) {
+        if (due <= now) due = now + 1;
+        place(Entry{due, std::move(item)});
+        ++pending;
+    }
+
+    /**
+     * @brief Advances the clock by one tick and expires the timers now due.
+     *
+     * @param onExpire Callable invoked as onExpire(T&) for each expired timer.
+     *                 It may schedule new timers.
+     */
+    template<typename F>
+    void advance(F&& onExpire) {
+        ++now;
+
+        // once per top-level rotation, pull in overflow timers now within span
+        if (lowBitsZero(Levels) && !overflow.empty()) {
+            scratch.swap(overflow);
+            for (auto& e : scratch) place(std::move(e));
+            scratch.clear();
+        }
+
+        // cascade, coarsest first, every level whose lower digits just rolled over
+        unsigned top = 0;
+        while (top + 1 < Levels && lowBitsZero(top + 1)) ++top;
+        for (unsigned level = top; level >= 1; --level) {
+            auto& bucket = wheel[level][slotOf(now, level)];
+            if (bucket.empty()) continue;
+            scratch.swap(bucket);
+            for (auto& e : scratch) place(std::move(e));
+            scratch.clear();
+        }
+
+        auto& due = wheel[0][slotOf(now, 0)];
+        if (due.empty()) return;
+        expiring.swap(due);
+        pending -= expiring.size();
+        for (auto& e : expiring) onExpire(e.item);
+        expiring.clear();
+    }
+
+    /**
+     * @brief Visits every pending timer (in no particular order).
+     *
+     * @param f Callable invoked as f(T&) for each pending timer.
+     */
+    template<typename F>
+    void forEach(F&& f) {
+        for (auto& level : wheel)
+            for (auto& bucket : level)
+                for (auto& e : bucket) f(e.item);
+        for (auto& e : overflow) f(e.item);
+    }
+
+    /**
+     * @brief Drops every pending timer, keeping bucket capacity for reuse.
+     */
+    void clear() {
+        for (auto& level : wheel)
+            for (auto& bucket : level) bucket.clear();
+        overflow.clear();
+        pending = 0;
+    }
+
+    /** @return Current tick of the wheel's clock. */
+    std::uint64_t currentTick() const { return now; }
+
+    /** @return Number of timers scheduled but not yet expired. */
+    std::size_t size() const { return pending; }
+
+    /** @return true if no timers are pending. */
+    bool empty() const { return pending == 0; }
+
+private:
+    static std::size_t slotOf(std::uint64_t tick, unsigned level) {
+        return static_cast<std::size_t>((tick >> (SlotBits * level)) & (kSlots - 1));
+    }
+
+    /** @brief true if the lowest @p level digits of the clock are all zero. */
+    bool lowBitsZero(unsigned level) const {
+        return (now & ((std::uint64_t{1} << (SlotBits * level)) - 1)) == 0;
+    }
+
+    /** @brief Files an entry on the level of its highest digit that differs from now. */
+    void place(Entry e) {
+        std::uint64_t diff = e.due ^ now;
+        if (diff >> (SlotBits * Levels)) {
+            overflow.push_back(std::move(e));
+            return;
+        }
+        unsigned level = 0;
+        while (level + 1 < Levels && (diff >> (SlotBits * (level + 1)))) ++level;
+        wheel[level][slotOf(e.due, level)].push_back(std::move(e));
+    }
+
+    std::array<std::array<Bucket, kSlots>, Levels> wheel; ///< Buckets per level
+    Bucket overflow;               ///< Timers beyond the wheel's span
+    Bucket scratch;                ///< Reused buffer for cascading
+    Bucket expiring;               ///< Reused buffer for the due bucket
+    std::uint64_t now;             ///< Current tick
+    std::size_t pending = 0;       ///< Timers not yet expired
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief One completed span on a thread's timeline.
+ *
+ * Names and categories must be string literals (or otherwise outlive the
+ * recorder): only the pointers are stored.
+ */
+struct TraceEvent {
+    const char* name = nullptr;       ///< Span name, e.g. "runner chunk"
+    const char* category = nullptr;   ///< Viewer category: "stage", "station", "lock" or "stats"
+    std::int64_t startNs = 0;         ///< steady_clock time the span began
+    std::int64_t durationNs = 0;      ///< Span length
+    std::int64_t arg = -1;            ///< Count shown with the span, e.g. vehicles in a batch (-1 = none)
+};
+
+/**
+ * @brief Opt-in, process-wide timeline of spans, written as Chrome trace-event JSON.
+ *
+ * Each thread appends to its own fixed-size ring, so recording takes no
+ * lock and no allocation after a thread's first event; a full ring
+ * overwrites its oldest events, keeping the end of the run. When a traced
+ * thread exits its ring is handed to the next thread that starts tracing,
+ * so memory follows the most threads traced at once rather than every
+ * thread ever started; the earlier owners' events stay on their own tracks
+ * until the new owner overwrites them. Disabled by default; while disabled
+ * a TraceSpan costs one relaxed load.
+ *
+ * Dump with writeChromeJson() once traced threads are idle (e.g., after
+ * runSimulation() returns). The output loads in chrome://tracing and in
+ * the Perfetto UI.
+ */
+class TraceRecorder {
+public:
+    static constexpr std::size_t kDefaultRingEvents = 1 << 16;  ///< Events kept per thread (2.5 MiB)
+
+    /** @brief Returns the global recorder. */
+    static TraceRecorder& instance();
+
+    /**
+     * @brief Starts recording.
+     *
+     * @param ringEvents Events kept per thread, rounded up to a power of two; applies to threads that start tracing later.
+     */
+    void enable(std::size_t ringEvents = kDefaultRingEvents);
+
+    /** @brief Stops recording; recorded events are kept. */
+    void disable() { on.store(false, std::memory_order_relaxed); }
+
+    /** @return true while recording. */
+    static bool enabled() { return on.load(std::memory_order_relaxed); }
+
+    /** @return steady_clock time in nanoseconds, the span time base. */
+    static std::int64_t nowNs();
+
+    /** @brief Appends a span to the calling thread's ring. */
+    void record(const char* name, const char* category, std::int64_t startNs, std::int64_t endNs, std::int64_t arg = -1);
+
+    /**
+     * @brief Names the calling thread's track in the viewer.
+     *
+     * @param name String literal; the latest name given before the dump is shown.
+     */
+    static void setThreadName(const char* name);
+
+    /** @brief Writes every kept event and the thread names as Chrome trace-event JSON. */
+    void writeChromeJson(std::ostream& os) const;
+
+    /** @return false if @p path cannot be written. */
+    bool writeChromeJson(const std::string& path) const;
+
+    /** @return Events currently kept across all threads. */
+    std::size_t eventCount() const;
+
+    /** @return Events overwritten because a thread's ring was full. */
+    std::size_t droppedCount() const;
+
+    /** @return Rings allocated so far, in use or waiting for a new thread. */
+    std::size_t ringCount() const;
+
+    /** @brief Forgets every event; call while no traced thread is running. */
+    void clear();
+
+private:
+    TraceRecorder() = default;
+
+    /** @brief Events of an earlier owner of a ring. */
+    struct PastTrack {
+        std::uint64_t from = 0;                   ///< First event of the owner (head when it took the ring)
+        int tid = 0;                              ///< Track id in the dump
+        const char* name = nullptr;               ///< Track name (nullptr = "thread <tid>")
+    };
+
+    /** @brief Ring of one thread; only that thread writes it. */
+    struct ThreadRing {
+        explicit ThreadRing(std::size_t capacity) : events(capacity) {}
+        std::vector<TraceEvent> events;           ///< Power-of-two ring
+        std::atomic<std::uint64_t> head{0};       ///< Events ever written
+        std::atomic<const char*> name{nullptr};   ///< Track name (nullptr = "thread <tid>")
+        int tid = 0;                              ///< Track id in the dump
+        std::uint64_t from = 0;                   ///< First event of the current owner
+        std::vector<PastTrack> past;              ///< Earlier owners with events still kept, oldest first
+        bool free = false;                        ///< Owner has exited; the next new thread takes it
+    };
+
+    /** @brief Hands the calling thread's ring back when the thread exits. */
+    struct RingReturn {
+        ThreadRing* ring = nullptr;               ///< Ring to return
+        ~RingReturn();
+    };
+
+    /** @return The calling thread's ring, taken from a free one or created on first use. */
+    ThreadRing& localRing();
+
+    /** @brief Writes the events of one track of @p ring, those in [@p from, @p to), with its name. */
+    void writeTrack(std::ostream& os, bool& first, const ThreadRing& ring, std::uint64_t from, std::uint64_t to,
+                    int tid, const char* name) const;
+
+    static inline std::atomic<bool> on{false};        ///< Recording switch
+    std::atomic<std::size_t> ringEvents{kDefaultRingEvents}; ///< Capacity of rings created from now on
+    mutable std::mutex mtx;                           ///< Guards rings (registration and dumps)
+    std::vector<std::unique_ptr<ThreadRing>> rings;   ///< Every ring allocated; never shrinks
+    int nextTid = 1;                                  ///< Track id of the next ring owner
+    static thread_local RingReturn ringReturn;        ///< Returns the ring at thread exit
+};
+
+/**
+ * @brief Records the scope it lives in as a span when tracing is enabled.
+ */
+class TraceSpan {
+public:
+    TraceSpan(const char* name, const char* category, std::int64_t arg = -1)
+        : name(name), category(category), arg(arg), startNs(TraceRecorder::enabled() ? TraceRecorder::nowNs() : 0) {}
+
+    ~TraceSpan() {
+        if (startNs != 0) TraceRecorder::instance().record(name, category, startNs, TraceRecorder::nowNs(), arg);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    /** @brief Sets the count shown with the span, e.g. once the batch size is known. */
+    void setArg(std::int64_t value) { arg = value; }
+
+private:
+    const char* name;         ///< Span name
+    const char* category;     ///< Viewer category
+    std::int64_t arg;         ///< Count shown with the span
+    std::int64_t startNs;     ///< Start time (0 = not recording)
+};
@@ -1,6 +1,12 @@
 #pragma once
 #include <string>
 #include <functional>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include "VehicleSpecs.h"
+#include "EnergyModel.h"
+#include "IntrusiveQueue.h"
 
 /**
  * @brief Represents a single electric vehicle in the simulation.
@@ -10,6 +16,10 @@
  * charging time, and fault probability. Concrete vehicle types (Alpha, Bravo,
  * etc.) may extend this class and override registerStats() for custom behavior.
  *
+ * Battery drain follows the EnergyTable of the vehicle's type and passenger
+ * load, so the state of charge falls continuously at a speed- and
+ * load-dependent rate.
+ *
  * A vehicle participates in a lifecycle of:
  * - Running for the time which battery can support
  * - Reducing battery
@@ -19,6 +29,20 @@
  */
 class Vehicle {
 public:
+    /**
+     * @brief Simulated ticks marking the current run/charge cycle, for per-cycle export.
+     */
+    struct CycleStamps {
+        long runStart = 0;       ///< Tick the run phase started
+        long depleted = 0;       ///< Tick the battery ran out
+        long acquired = 0;       ///< Tick a charging station was acquired
+        double runSeconds = 0;   ///< Running time of the completed run phase
+        double runMiles = 0;     ///< Distance of the completed run phase
+    };
+
+    /** @brief Hook threading the vehicle through the simulation's stage queues (one queue at a time). */
+    IntrusiveLink<Vehicle> queueLink;
+
     /**
      * @brief Constructs a vehicle with the given configuration parameters.
      *
@@ -38,19 +62,36 @@ public:
             int passenger,
             double fault);
 
+    /**
+     * @brief Constructs a built-in vehicle from its compile-time spec row.
+     *
+     * @param spec  Row of vehicleSpecs describing this vehicle type.
+     * @param kind  Built-in kind the spec row belongs to.
+     */
+    Vehicle(const VehicleSpec& spec, VehicleKind kind);
+
     /**
      * @brief Virtual destructor for safe inheritance.
      */
     virtual ~Vehicle() = default;
 
+    /** @brief Allocates vehicle storage, attributed to MemSubsystem::Vehicles. */
+    static void* operator new(std::size_t size);
+
+    /** @brief Frees vehicle storage (sized, so the dynamic type's size is credited back). */
+    static void operator delete(void* p, std::size_t size);
+
     /**
      * @brief Simulates one time slice of running.
      *
      * This updates:
      * - runningTime
      * - batteryRatio
+     *
+     * Uses the drive threshold precomputed at construction. Batches of
+     * built-in vehicles are normally advanced through TickKernel instead.
      */
-    void run();
+    void run() { advanceRun(driveThreshold); }
 
     /**
      * @brief Simulates one time slice of charging.
@@ -58,22 +99,93 @@ public:
      * This updates:
      * - chargingTime
      * - batteryRatio
+     *
+     * Uses the charge threshold precomputed at construction.
+     */
+    void charge() { advanceCharge(chargeThreshold); }
+
+    /**
+     * @brief Advances one running second against an explicit drive threshold.
+     *
+     * Drain comes from one lookup in the vehicle's EnergyTable, so the cost
+     * per tick is the same for every speed profile and load.
+     *
+     * @param driveSec Battery size in cruise-equivalent seconds (see EnergyTable).
+     */
+    void advanceRun(double driveSec) {
+        runningTime++;
+        updateDrain(driveSec);
+    }
+
+    /**
+     * @brief Adds a span of running time at once.
+     *
+     * Used when depletion is scheduled ahead of time instead of being
+     * advanced one second per tick.
+     *
+     * @param seconds Simulated seconds spent running.
+     */
+    void runFor(double seconds) {
+        runningTime += seconds;
+        updateDrain(driveThreshold);
+    }
+
+    /**
+     * @brief Whole ticks of running left before the battery is depleted.
+     *
+     * @return At least 1.
+     */
+    long ticksUntilDepleted() const {
+        long ticks = static_cast<long>(energy->ticksToDrain(driveThreshold)) - static_cast<long>(runningTime);
+        return ticks > 1 ? ticks : 1;
+    }
+
+    /**
+     * @brief Adds a span of charging time at once.
+     *
+     * Used when charging completion is scheduled ahead of time instead of
+     * being advanced one second per tick.
+     *
+     * @param seconds Simulated seconds spent charging.
+     */
+    void chargeFor(double seconds) {
+        chargingTime += seconds;
+        updateCharge(chargeThreshold);
+    }
+
+    /**
+     * @brief Whole ticks of charging still needed to reach a full battery.
+     *
+     * @return At least 1.
      */
-    void charge();
+    long ticksUntilCharged() const {
+        long ticks = static_cast<long>(std::ceil(chargeThreshold - chargingTime));
+        return ticks > 1 ? ticks : 1;
+    }
+
+    /**
+     * @brief Advances one charging second against an explicit charge threshold.
+     *
+     * @param chargeSec Simulated seconds a full charge takes.
+     */
+    void advanceCharge(double chargeSec) {
+        chargingTime++;
+        updateCharge(chargeSec);
+    }
 
     /**
      * @brief Checks if the battery is depleted enough to require charging.
      *
      * @return true if the vehicle should enter the charging queue.
      */
-    bool needsCharge() const;
+    bool needsCharge() const { return batteryRatio <= 0.0; }
 
     /**
      * @brief Checks if the vehicle is fully charged.
      *
      * @return true if charging is complete.
      */
-    bool isFullyCharged() const;
+    bool isFullyCharged() const { return batteryRatio >= 1.0; }
 
     // ----------------------------------------------------------------------
     // Getters
@@ -82,6 +194,9 @@ public:
     /** @return Vehicle type string. */
     const std::string& getType() const { return vehicleType; }
 
+    /** @return Built-in kind, or VehicleKind::Custom for runtime specs. */
+    VehicleKind getKind() const { return kind; }
+
     /** @return Cruise speed in mph. */
     int getCruiseSpeed() const { return cruiseSpeed; }
 
@@ -97,9 +212,42 @@ public:
     /** @return Number of passengers carried. */
     int getPassengers() const { return passengers; }
 
+    /** @return Passengers aboard, which selects the energy table (defaults to getPassengers()). */
+    int getLoad() const { return load; }
+
+    /**
+     * @brief Sets the passengers aboard; built-in kinds switch to the matching energy table.
+     */
+    void setLoad(int passengersAboard);
+
+    /**
+     * @brief Overrides the energy table, e.g., to give a runtime-specified vehicle a speed profile.
+     *
+     * @param table Must outlive the vehicle.
+     */
+    void setEnergyTable(const EnergyTable& table) { energy = &table; }
+
+    /** @return Battery state of charge, 0 (empty) to 1 (full). */
+    double getStateOfCharge() const { return batteryRatio; }
+
+    /** @return Miles driven in the current cycle. */
+    double getDistance() const { return getCruiseEquivalentTime() * cruiseSpeed / 3600.0; }
+
+    /** @return Seconds at cruise speed that cover the current cycle's distance. */
+    double getCruiseEquivalentTime() const { return energy->travelAt(static_cast<std::uint64_t>(runningTime)); }
+
     /** @return Probability of fault per running hour. */
     double getFaultPerHour() const { return faultPerHour; }
 
+    /** @return Id assigned by the simulation (position in its fleet). */
+    std::uint32_t getId() const { return id; }
+
+    /** @brief Assigns the vehicle's id within a simulation. */
+    void setId(std::uint32_t value) { id = value; }
+
+    /** @return Tick stamps of the current run/charge cycle. */
+    CycleStamps& cycleStamps() { return stamps; }
+
     /** @return Running time accumulated for current cycle. */
     double getRunningTime() const { return runningTime; }
 
@@ -116,7 +264,7 @@ public:
     /**
      * @brief Resets the running time at the beginning of a new cycle.
      */
-    void resetRunningTime() { runningTime = 0; }
+    void resetRunningTime() { runningTime = 0; drained = 0; }
 
     /**
      * @brief Resets the charging time at the beginning of a new cycle.
@@ -124,6 +272,16 @@ public:
     void resetChargingTime() { chargingTime = 0; }
 
 private:
+    /** @brief Recomputes drain and state of charge from the running time. */
+    void updateDrain(double driveSec) {
+        drained = energy->drainAt(static_cast<std::uint64_t>(runningTime));
+        batteryRatio = drained >= driveSec ? 0.0 : 1.0 - drained * (1.0 / driveSec);
+    }
+
+    /** @brief Recomputes state of charge from the charging time (charging starts from empty). */
+    void updateCharge(double chargeSec) {
+        batteryRatio = chargingTime >= chargeSec ? 1.0 : chargingTime * (1.0 / chargeSec);
+    }
 
     std::string vehicleType;     ///< Identifier: "Alpha", "Bravo", etc.
     int cruiseSpeed;             ///< Cruise speed (mph)
@@ -135,15 +293,27 @@ private:
 
     double runningTime = 0;      ///< Accumulated runtime for current cycle
     double chargingTime = 0;     ///< Accumulated charging time for current cycle
-    double batteryRatio = 1.0;   ///< Battery level ratio (1.0 = full)
+    double batteryRatio = 1.0;   ///< State of charge (1.0 = full)
+    double drained = 0;          ///< Drain this cycle, in cruise-equivalent seconds
+    int load;                    ///< Passengers aboard
     int timeSliceMs = 100;       ///< Real milliseconds per simulation-second
 
+    VehicleKind kind = VehicleKind::Custom; ///< Built-in kind selecting the tick kernel
+    double driveThreshold;       ///< Precomputed seconds of running per full battery
+    double chargeThreshold;      ///< Precomputed seconds of charging per full charge
+    const EnergyTable* energy = &EnergyTable::flat(); ///< Drain per tick for this type and load
+
+    std::uint32_t id = 0;        ///< Fleet position assigned by the simulation
+    CycleStamps stamps;          ///< Tick stamps of the current cycle
+
 protected:
     /**
      * @brief Registers runtime statistics for the vehicle.
      *
-     * Concrete vehicle types may override this to customize stat reporting.
-     * This is typically invoked from run() and charge().
+     * Concrete vehicle types may override this to install custom stats in
+     * the global VehicleStatsManager ahead of a run. The built-in types do
+     * not call it: the manager a simulation records into creates a type's
+     * stats the first time it is recorded.
      */
     virtual void registerStats();
 
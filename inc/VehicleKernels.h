@@ -0,0 +1,91 @@
+#pragma once
+#include <array>
+#include <vector>
+#include <span>
+#include <type_traits>
+#include "Vehicle.h"
+#include "VehicleSpecs.h"
+
+/**
+ * @brief Per-kind tick kernels with thresholds folded at compile time.
+ *
+ * For each built-in VehicleKind the drive and charge thresholds are computed
+ * from vehicleSpecs as constant expressions, so advancing a batch of vehicles
+ * of one kind is a tight loop with no per-vehicle virtual dispatch and no
+ * per-tick division. VehicleKind::Custom uses the thresholds each Vehicle
+ * precomputed at construction.
+ *
+ * @tparam K The vehicle kind this kernel is specialized for.
+ */
+template<VehicleKind K>
+struct TickKernel {
+    static constexpr double driveSec = specFor(K).driveSeconds();   ///< Seconds per full battery
+    static constexpr double chargeSec = specFor(K).chargeSeconds(); ///< Seconds per full charge
+
+    /** @brief Advances every vehicle in the batch by one running second. */
+    static void runBatch(std::span<Vehicle* const> batch) {
+        for (Vehicle* v : batch) v->advanceRun(driveSec);
+    }
+
+    /** @brief Advances every vehicle in the batch by one charging second. */
+    static void chargeBatch(std::span<Vehicle* const> batch) {
+        for (Vehicle* v : batch) v->advanceCharge(chargeSec);
+    }
+};
+
+/**
+ * @brief Fallback kernel for runtime-specified vehicles.
+ */
+template<>
+struct TickKernel<VehicleKind::Custom> {
+    static void runBatch(std::span<Vehicle* const> batch) {
+        for (Vehicle* v : batch) v->run();
+    }
+
+    static void chargeBatch(std::span<Vehicle* const> batch) {
+        for (Vehicle* v : batch) v->charge();
+    }
+};
+
+/**
+ * @brief Vehicles grouped by kind so each group is advanced by one kernel call.
+ */
+using KindBatches = std::array<std::vector<Vehicle*>, kVehicleKindCount>;
+
+/**
+ * @brief Invokes @p f with a std::integral_constant for the given kind.
+ *
+ * This is the single runtime switch that selects a compile-time kernel; it
+ * runs once per type-homogeneous batch rather than once per vehicle.
+ */
+template<typename F>
+void dispatchKind(VehicleKind kind, F&& f) {
+    switch (kind) {
+        case VehicleKind::Alpha:   f(std::integral_constant<VehicleKind, VehicleKind::Alpha>{}); break;
+        case VehicleKind::Bravo:   f(std::integral_constant<VehicleKind, VehicleKind::Bravo>{}); break;
+        case VehicleKind::Charlie: f(std::integral_constant<VehicleKind, VehicleKind::Charlie>{}); break;
+        case VehicleKind::Dela:    f(std::integral_constant<VehicleKind, VehicleKind::Dela>{}); break;
+        case VehicleKind::Echo:    f(std::integral_constant<VehicleKind, VehicleKind::Echo>{}); break;
+        default:                   f(std::integral_constant<VehicleKind, VehicleKind::Custom>{}); break;
+    }
+}
+
+/** @brief Runs one second for every batch, one kernel call per kind. */
+inline void runKindBatches(const KindBatches& batches) {
+    for (std::size_t k = 0; k < batches.size(); ++k) {
+        if (batches[k].empty()) continue;
+        dispatchKind(static_cast<VehicleKind>(k), [&](auto kind) {
+            TickKernel<decltype(kind)::value>::runBatch(batches[k]);
+        });
+    }
+}
+
+/** @brief Charges one second for every batch, one kernel call per kind. */
+inline void chargeKindBatches(const KindBatches& batches) {
+    for (std::size_t k = 0; k < batches.size(); ++k) {
+        if (batches[k].empty()) continue;
+        dispatchKind(static_cast<VehicleKind>(k), [&](auto kind) {
+            TickKernel<decltype(kind)::value>::chargeBatch(batches[k]);
+        });
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Identifies the built-in vehicle types known at compile time.
+ *
+ * Each built-in kind indexes one row of vehicleSpecs. Vehicles constructed
+ * from runtime parameters (e.g., in unit tests) use VehicleKind::Custom and
+ * fall back to thresholds precomputed in the Vehicle constructor.
+ */
+enum class VehicleKind : std::uint8_t {
+    Alpha,
+    Bravo,
+    Charlie,
+    Dela,
+    Echo,
+    Custom      /**< Runtime-specified vehicle; not backed by vehicleSpecs. */
+};
+
+/** @brief Number of built-in kinds, i.e., rows in vehicleSpecs. */
+inline constexpr std::size_t kBuiltinVehicleKinds = static_cast<std::size_t>(VehicleKind::Custom);
+
+/** @brief Number of kinds including VehicleKind::Custom; sizes per-kind arrays. */
+inline constexpr std::size_t kVehicleKindCount = kBuiltinVehicleKinds + 1;
+
+/**
+ * @brief Static configuration of one vehicle type.
+ */
+struct VehicleSpec {
+    const char* type;       ///< Identifier: "Alpha", "Bravo", etc.
+    int cruiseSpeed;        ///< Cruise speed (mph)
+    int batteryCapacity;    ///< Battery capacity (kWh)
+    double timeToCharge;    ///< Hours required for a full charge
+    double energyUse;       ///< Energy use (kWh per mile)
+    int passengers;         ///< Passenger count
+    double faultPerHour;    ///< Fault probability per hour
+
+    /**
+     * @brief Simulated seconds a full battery lasts at cruise speed.
+     */
+    constexpr double driveSeconds() const {
+        return 3600.0 * (batteryCapacity / energyUse) / cruiseSpeed;
+    }
+
+    /**
+     * @brief Simulated seconds a full charge takes (at least one tick).
+     */
+    constexpr double chargeSeconds() const {
+        return timeToCharge * 3600.0 > 1.0 ? timeToCharge * 3600.0 : 1.0;
+    }
+};
+
+/**
+ * @brief Compile-time table of built-in vehicle types, indexed by VehicleKind.
+ */
+inline constexpr VehicleSpec vehicleSpecs[kBuiltinVehicleKinds] = {
+    {"Alpha", 120, 320, 0.6, 1.6, 4, 0.25},
+    {"Bravo", 100, 100, 0.2, 1.5, 5, 0.10},
+    {"Charlie", 160, 220, 0.8, 2.2, 3, 0.05},
+    {"Dela", 90, 120, 0.62, 0.8, 2, 0.22},
+    {"Echo", 30, 150, 0.3, 5.8, 2, 0.61}
+};
+
+/**
+ * @brief Returns the compile-time spec row for a built-in kind.
+ */
+constexpr const VehicleSpec& specFor(VehicleKind kind) {
+    return vehicleSpecs[static_cast<std::size_t>(kind)];
+}
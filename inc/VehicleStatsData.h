@@ -1,6 +1,7 @@
 #pragma once
 #include "BaseStats.h"
 #include <mutex>
+#include <atomic>
 #include <iostream>
 /**
  * @brief Defines the VehicleStatsData class, which stores aggregated
@@ -12,67 +13,197 @@
  *   - Average charging time
  *   - Total vehicle faults
  *   - Total passenger-miles
+ *   - Mean, variance, min and max of per-run time and distance and of
+ *     per-charge time
  *
- * It is thread-safe and can be called concurrently by multiple worker threads.
+ * record() only updates raw accumulators; derived metrics are computed when
+ * read. Writers are serialized by a mutex and publish through a sequence
+ * counter (seqlock), so readers such as a monitoring thread never block
+ * writers: a read retries if it overlapped a write.
  */
 class VehicleStatsData : public BaseStats {
 public:
     /**
      * @brief Gets the average total running time of vehicles of this type.
      */
-    double getAverageTime() const { return averageTime; }
+    double getAverageTime() const { return snapshot().averageTime; }
 
     /**
      * @brief Gets the average distance traveled across all completed runs.
      */
-    double getAverageDistance() const { return averageDistance; }
+    double getAverageDistance() const { return snapshot().averageDistance; }
 
     /**
      * @brief Gets the average charging time for vehicles of this type.
      */
-    double getAverageChargeTime() const { return averageChargeTime; }
+    double getAverageChargeTime() const { return snapshot().averageChargeTime; }
 
     /**
      * @brief Gets the total number of fault events recorded.
      */
-    double getTotalFaults() const { return totalFaults; }
+    double getTotalFaults() const { return snapshot().totalFaults; }
 
     /**
      * @brief Gets the sum of (passengers × miles) across all completed runs.
      *        Useful for load efficiency statistics.
      */
-    double getTotalPassengersMiles() const { return totalPassengersMiles; }
+    double getTotalPassengersMiles() const { return snapshot().totalPassengersMiles; }
 
     /**
      * @brief Records a completed vehicle cycle (running or charging).
      * @param v    Vehicle whose stats are being recorded.
      * @param type Indicates whether this is a run cycle or charge event.
      *
-     * This function updates aggregated totals and recomputes averages.
-     * It is thread-safe and locks the internal mutex.
+     * This function only updates raw accumulators. It is thread-safe; it
+     * serializes with other writers but never waits for readers.
      */
     void record(const Vehicle& v, StatType type) override;
 
+    /**
+     * @brief Records a batch under one lock and one seqlock write section.
+     */
+    void recordBatch(std::span<Vehicle* const> vehicles, StatType type) override;
+
+    /**
+     * @brief Records @p count copies of @p v as one scaled update.
+     */
+    void recordWeighted(const Vehicle& v, StatType type, std::uint64_t count) override;
+
+    /**
+     * @brief Adds the accumulators of @p other (another VehicleStatsData; anything else is ignored).
+     *
+     * Reads @p other without blocking its writers, then applies the sum as one write.
+     */
+    void merge(const BaseStats& other) override;
+
+    /**
+     * @brief Zeroes every accumulator in one write section.
+     */
+    void reset() override;
+
+    /**
+     * @brief Returns a consistent copy of the stats with derived metrics.
+     *
+     * Wait-free for writers: the reader retries if a write was in progress.
+     */
+    VehicleStatsSnapshot snapshot() const override;
+
     /**
      * @brief Logs the final computed stats.
      * @param type The vehicle type.
      */
     void log(const std::string& type) const override;
 
+    /** @brief Allocates stats storage, attributed to MemSubsystem::StatsMap. */
+    static void* operator new(std::size_t size);
+
+    /** @brief Frees stats storage. */
+    static void operator delete(void* p, std::size_t size);
+
 private:
-    double totalTime = 0;        ///< Total accumulated running time (hours)
-    double averageTime = 0;      ///< Average running time (hours)
-    double totalTestVehicle = 0; ///< Number of vehicles that completed running
+    /** @brief Plain copy of every accumulator, as read under the seqlock. */
+    struct Accumulators {
+        double totalTime = 0;
+        double totalCruiseTime = 0;
+        double totalTestVehicle = 0;
+        double totalChargedVehicle = 0;
+        double totalChargeTime = 0;
+        double totalPassengerMiles = 0;
+        RunningSummary runTime;
+        RunningSummary runDistance;
+        RunningSummary chargeTime;
+        int cruiseSpeed = 0;
+        double faultPerHour = 0;
+    };
+
+    /** @brief A RunningSummary held in atomics so seqlock readers can copy it. */
+    struct AtomicSummary {
+        std::atomic<double> count{0}, mean{0}, m2{0}, min{0}, max{0};
+
+        RunningSummary load() const {
+            return {count.load(std::memory_order_relaxed), mean.load(std::memory_order_relaxed),
+                    m2.load(std::memory_order_relaxed), min.load(std::memory_order_relaxed),
+                    max.load(std::memory_order_relaxed)};
+        }
+
+        void store(const RunningSummary& s) {
+            count.store(s.count, std::memory_order_relaxed);
+            mean.store(s.mean, std::memory_order_relaxed);
+            m2.store(s.m2, std::memory_order_relaxed);
+            min.store(s.min, std::memory_order_relaxed);
+            max.store(s.max, std::memory_order_relaxed);
+        }
 
-    double totalDistance = 0;    ///< Total miles traveled by all vehicles
-    double averageDistance = 0;  ///< Mean miles per run
+        /** @brief Adds one sample (caller must hold statsMutex). */
+        void add(double x) {
+            RunningSummary s = load();
+            s.add(x);
+            store(s);
+        }
+
+        /** @brief Adds @p n samples equal to @p x (caller must hold statsMutex). */
+        void addRepeated(double x, double n) {
+            RunningSummary s = load();
+            s.addRepeated(x, n);
+            store(s);
+        }
+    };
+
+    /**
+     * @brief Consistent copy of the accumulators; retries while a write is in progress.
+     */
+    Accumulators read() const;
+
+    /**
+     * @brief Overwrites every accumulator; caller must be inside a write section.
+     */
+    void write(const Accumulators& a);
+
+    /**
+     * @brief Applies one record to the accumulators; caller must be inside a write section.
+     */
+    void apply(const Vehicle& v, StatType type);
+
+    /**
+     * @brief Applies @p count identical records; caller must be inside a write section.
+     */
+    void applyWeighted(const Vehicle& v, StatType type, double count);
+
+    /**
+     * @brief Begins a write section; caller must hold statsMutex.
+     */
+    void beginWrite() {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    /**
+     * @brief Ends a write section and publishes it to readers.
+     */
+    void endWrite() {
+        seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Adds to a writer-owned accumulator (caller must hold statsMutex).
+     */
+    static void add(std::atomic<double>& acc, double delta) {
+        acc.store(acc.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
 
-    double totalChargedVehicle = 0; ///< Number of vehicles that completed charging
-    double totalChargeTime = 0;     ///< Total charge time across all cycles
-    double averageChargeTime = 0;   ///< Average charge duration (hours)
+    std::atomic<double> totalTime{0};           ///< Total accumulated running time (seconds)
+    std::atomic<double> totalCruiseTime{0};     ///< Running time at cruise speed covering the same distance (seconds)
+    std::atomic<double> totalTestVehicle{0};    ///< Number of vehicles that completed running
+    std::atomic<double> totalChargedVehicle{0}; ///< Number of vehicles that completed charging
+    std::atomic<double> totalChargeTime{0};     ///< Total charge time across all cycles
+    std::atomic<double> totalPassengerMiles{0}; ///< Sum of passengers aboard × miles, per record
+    AtomicSummary runTime;                      ///< Per-run running time
+    AtomicSummary runDistance;                  ///< Per-run distance (miles)
+    AtomicSummary chargeTime;                   ///< Per-charge charging time
 
-    double totalFaults = 0;           ///< Sum of all faults encountered
-    double totalPassengersMiles = 0;  ///< Sum of (passengers × miles)
+    std::atomic<int> cruiseSpeed{0};            ///< Cruise speed of this type (mph)
+    std::atomic<double> faultPerHour{0};        ///< Fault probability per hour of this type
 
-    mutable std::mutex statsMutex; ///< Guards access to all stored statistics
+    std::atomic<unsigned> seq{0};  ///< Seqlock counter; odd while a write is in progress
+    mutable std::mutex statsMutex; ///< Serializes writers; readers never take it
 };
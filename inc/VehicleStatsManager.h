@@ -3,13 +3,21 @@
 #include <memory>
 #include <string>
 #include <mutex>
+#include <map>
+#include <vector>
+#include <span>
 #include "BaseStats.h"
+#include "MemoryTracking.h"
 
 class Vehicle;
 
 /**
- * @brief A singleton responsible for storing and updating statistical
- *        information for all vehicle types in the simulation.
+ * @brief Stores and updates statistical information for all vehicle types
+ *        in a simulation.
+ *
+ * getInstance() is the process-wide default that simulations record into
+ * unless given their own manager (see Simulation::setStatsManager()), so
+ * embedders can keep several runs' stats apart in one process.
  *
  * The manager uses a map of:
  *      vehicleType → BaseStats-derived object
@@ -19,15 +27,22 @@ class Vehicle;
  *
  * Thread safety:
  *   - All operations modifying the statsMap are protected by statsMutex.
+ *   - snapshotAll() never takes statsMutex. Whenever a type is added, an
+ *     immutable copy of the (type, stats) list is republished RCU-style;
+ *     readers pin the current version through its shared_ptr and the old
+ *     version is reclaimed when its last reader releases it.
  */
 class VehicleStatsManager {
 public:
 
     /**
-     * @brief Returns the global singleton instance.
+     * @brief Returns the process-wide default instance.
      */
     static VehicleStatsManager& getInstance();
 
+    VehicleStatsManager() = default;
+    ~VehicleStatsManager() = default;
+
     /**
      * @brief Records a statistic event for a specific vehicle type.
      *
@@ -43,6 +58,34 @@ public:
                 const Vehicle& v,
                 StatType statType);
 
+    /**
+     * @brief Records the same statistic for a batch of vehicles under one lock.
+     *
+     * Consecutive vehicles of the same type are applied to their stats
+     * object as one BaseStats::recordBatch() call, so callers get the most
+     * out of it by grouping the batch by type.
+     *
+     * @param vehicles Vehicles to record.
+     * @param statType Type of statistic event.
+     */
+    void recordBatch(std::span<Vehicle* const> vehicles, StatType statType);
+
+    /**
+     * @brief Records the same statistic for a batch of vehicles that all share @p type.
+     *
+     * Skips the per-vehicle type check of the overload above, so the batch is
+     * one BaseStats::recordBatch() call.
+     */
+    void recordBatch(const std::string& type, std::span<Vehicle* const> vehicles, StatType statType);
+
+    /**
+     * @brief Records the same statistic for @p count vehicles in the same state as @p v.
+     *
+     * One BaseStats::recordWeighted() call, so the cost does not grow with
+     * the count (see CohortSimulation).
+     */
+    void recordWeighted(const std::string& type, const Vehicle& v, StatType statType, std::uint64_t count);
+
     /**
      * @brief Registers (or overwrites) a BaseStats implementation for a vehicle type.
      *
@@ -56,6 +99,13 @@ public:
     void setStatData(const std::string& type,
                      std::unique_ptr<BaseStats> stats);
 
+    /**
+     * @brief Clears the stats of every registered type (see BaseStats::reset()).
+     *
+     * Types stay registered, so concurrent snapshotAll() calls remain safe.
+     */
+    void resetAll();
+
     /**
      * @brief Logs all stored statistics to the console and/or output file.
      *
@@ -65,24 +115,49 @@ public:
      */
     void printAll();
 
+    /**
+     * @brief Returns a consistent snapshot of every registered type's stats.
+     *
+     * Safe to call while workers are recording; it neither takes statsMutex
+     * nor blocks any writer.
+     *
+     * @return Map of vehicle type → stats snapshot, sorted by type.
+     */
+    std::map<std::string, VehicleStatsSnapshot> snapshotAll() const;
+
 protected:
     /**
      * @brief Mapping from vehicle type string to a statistics storage object.
      *
      * Each value is a BaseStats-derived instance, stored in a unique_ptr.
+     * Node memory is attributed to MemSubsystem::StatsMap.
      */
-    std::unordered_map<std::string, std::unique_ptr<BaseStats>> statsMap;
+    using StatsMapAllocator = TrackingAllocator<std::pair<const std::string, std::unique_ptr<BaseStats>>>;
+    std::unordered_map<std::string, std::unique_ptr<BaseStats>, std::hash<std::string>,
+                       std::equal_to<std::string>, StatsMapAllocator>
+        statsMap{StatsMapAllocator(MemSubsystem::StatsMap)};
 
     /**
      * @brief Mutex to protect statsMap for thread-safe operations.
      */
     std::mutex statsMutex;
 
-private:
-    VehicleStatsManager() = default;
-    ~VehicleStatsManager() = default;
+    /** @brief Immutable (type, stats) list published to lock-free readers. */
+    using StatsRegistry = std::vector<std::pair<std::string, const BaseStats*>>;
+
+    /**
+     * @brief Current registry version; replaced with std::atomic_store when
+     *        statsMap gains a type. Caller must hold statsMutex.
+     */
+    void publishRegistry();
+
+    /** @brief Stats object of @p type, created on first use. Caller must hold statsMutex. */
+    BaseStats& statsFor(const std::string& type);
 
-    // Disable copying and assignment to enforce singleton
+    std::shared_ptr<const StatsRegistry> registry = std::make_shared<const StatsRegistry>();
+
+private:
+    // stats objects are shared with lock-free readers by address, so a manager never moves
     VehicleStatsManager(const VehicleStatsManager&) = delete;
     VehicleStatsManager& operator=(const VehicleStatsManager&) = delete;
 
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+#include <atomic>
+
+/**
+ * @brief Fixed-size pool of worker threads shared by all pipeline stages.
+ *
+ * Stage work is submitted as small tasks each tick, so whichever stage is
+ * busy gets the cores. wait() blocks until every submitted task has finished,
+ * running queued tasks on the calling thread in the meantime.
+ *
+ * Only the first activeWorkers() threads take tasks; the rest stay parked
+ * on a condition variable and use no CPU until setActiveWorkers() wakes them.
+ */
+class WorkerPool {
+public:
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threads Number of workers; 0 sizes the pool to the machine.
+     */
+    explicit WorkerPool(size_t threads = 0);
+
+    /**
+     * @brief Finishes queued tasks and joins the workers.
+     */
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Queues a task for any worker.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until all submitted tasks have completed.
+     *
+     * The caller helps by running queued tasks instead of idling.
+     */
+    void wait();
+
+    /** @return Number of worker threads. */
+    size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Lets only the first @p count workers take tasks; the others park.
+     *
+     * Zero is allowed: wait() then runs every task on the calling thread.
+     *
+     * @param count Active workers, clamped to size().
+     */
+    void setActiveWorkers(size_t count);
+
+    /** @return Workers currently allowed to take tasks (lock-free). */
+    size_t activeWorkers() const { return activeMirror.load(std::memory_order_relaxed); }
+
+private:
+    /** @brief Worker loop: run tasks until the pool is destroyed; parks while @p index is inactive. */
+    void workerLoop(size_t index);
+
+    /** @brief Runs one task and marks it finished; caller must not hold mtx. */
+    void runTask(std::function<void()>& task);
+
+    std::vector<std::thread> workers;          ///< Worker threads
+    std::deque<std::function<void()>> tasks;   ///< Queued tasks
+    std::mutex mtx;                            ///< Guards tasks, unfinished and stopping
+    std::condition_variable taskCv;            ///< Signals queued tasks or shutdown
+    std::condition_variable doneCv;            ///< Signals that all tasks finished
+    std::condition_variable parkCv;            ///< Wakes parked workers when activated or stopping
+    size_t unfinished = 0;                     ///< Tasks submitted but not yet completed
+    size_t active = 0;                         ///< Workers with index < active take tasks
+    std::atomic<size_t> activeMirror{0};       ///< Mirror of active for lock-free readers
+    bool stopping = false;                     ///< Set by the destructor
+};
+
+/**
+ * @brief CPU time consumed so far by the calling thread.
+ *
+ * Returns zero where per-thread CPU clocks are unavailable.
+ */
+std::chrono::nanoseconds threadCpuTime();
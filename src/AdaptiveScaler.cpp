@@ -0,0 +1,57 @@
+#include "AdaptiveScaler.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+AdaptiveScaler::AdaptiveScaler(const ScalerConfig& cfg)
+    : config(cfg),
+      cpuBudget(cfg.cpuBudget > 0 ? cfg.cpuBudget : std::max(1u, std::thread::hardware_concurrency())) {}
+
+void AdaptiveScaler::reset() {
+    alloc = WorkerAllocation();
+    costNs = 0;
+    lowWindows = 0;
+    peakTotal = 1;
+    changeCount = 0;
+}
+
+const WorkerAllocation& AdaptiveScaler::update(const StageSample& sample) {
+    // serial stages get a worker only while they have vehicles and the budget has one beyond the runner's
+    size_t spare = cpuBudget - 1;
+    alloc.dispatcher = sample.needChargeDepth > 0 && spare > 0 ? 1 : 0;
+    spare -= alloc.dispatcher;
+    alloc.charger = sample.chargeDepth > 0 && spare > 0 ? 1 : 0;
+    spare -= alloc.charger;
+
+    // runner cost per vehicle, smoothed so one noisy window does not resize the pool
+    if (sample.vehiclesRun > 0 && sample.ticks > 0) {
+        const double ns = sample.runnerCpuMs * 1e6 / static_cast<double>(sample.vehiclesRun);
+        costNs = costNs > 0 ? 0.5 * costNs + 0.5 * ns : ns;
+    }
+
+    // workers the run queue would keep busy at the per-worker target, capped by how finely it splits
+    const double targetNs = std::max(config.targetTickMs, 1e-3) * 1e6;
+    const double demand = static_cast<double>(sample.runDepth) * costNs / targetNs;
+    const size_t splittable = std::max<size_t>(1, (sample.runDepth + config.minVehiclesPerWorker - 1) / config.minVehiclesPerWorker);
+    const size_t cap = std::min(splittable, spare + 1);
+
+    size_t runner = std::min(alloc.runner, cap);
+    if (demand > static_cast<double>(runner) && runner < cap) {
+        // grow at once
+        runner = std::min(cap, static_cast<size_t>(std::ceil(demand)));
+        lowWindows = 0;
+    } else if (runner > 1 && demand < config.shrinkBelow * static_cast<double>(runner - 1)) {
+        // shrink one worker at a time, only after a sustained lull
+        if (++lowWindows >= config.shrinkWindows) {
+            --runner;
+            lowWindows = 0;
+        }
+    } else {
+        lowWindows = 0;
+    }
+
+    if (runner != alloc.runner) ++changeCount;
+    alloc.runner = runner;
+    peakTotal = std::max(peakTotal, alloc.total());
+    return alloc;
+}
@@ -1,32 +1,85 @@
 #include "ChargeStationManager.h"
+#include "Tracing.h"
+#include <chrono>
 #include <iostream>
 
 ChargeStationManager::ChargeStationManager(int totalStations)
-    : availableStations(totalStations) {}
+    : totalStations(totalStations), availableStations(totalStations), lowWater(totalStations) {}
+
+void ChargeStationManager::attachShared(std::atomic<int>* counter) {
+    available = counter;
+    shared = true;
+    lowWater.store(counter->load());
+}
+
+void ChargeStationManager::setTotal(int stations) {
+    if (stations < 0) stations = 0;
+    const int added = stations - totalStations;
+    totalStations = stations;
+    if (added > 0) release(added);
+    else available->fetch_add(added);
+}
+
+void ChargeStationManager::reset() {
+    if (!shared) available->store(totalStations);
+    lowWater.store(available->load());
+}
 
 void ChargeStationManager::acquire(std::atomic<bool>& stopFlag) {
+    acquireUpTo(1, stopFlag);
+}
+
+int ChargeStationManager::acquireUpTo(int wanted, std::atomic<bool>& stopFlag) {
     std::unique_lock<std::mutex> lock(mtx);
-    
-    cv.wait(lock, [this, &stopFlag] {
-        return stopFlag.load() || availableStations > 0;
-    });
+    if (stopFlag.load()) return 0;
+    if (int got = tryAcquireUpTo(wanted)) return got;
+
+    // every station is busy: the wait is a span on the timeline when tracing
+    TraceSpan wait("station wait", "station", wanted);
+    for (;;) {
+        if (stopFlag.load()) return 0;
+        if (int got = tryAcquireUpTo(wanted)) return got;
+        if (shared) {
+            // releases from other processes do not notify cv
+            cv.wait_for(lock, std::chrono::milliseconds(1));
+        } else {
+            cv.wait(lock, [this, &stopFlag] {
+                return stopFlag.load() || available->load() > 0;
+            });
+        }
+    }
+}
 
-    if (stopFlag.load()) return;
-    
-    --availableStations;
+bool ChargeStationManager::tryAcquire() {
+    return tryAcquireUpTo(1) == 1;
+}
+
+int ChargeStationManager::tryAcquireUpTo(int wanted) {
+    int free = available->load();
+    while (free > 0 && wanted > 0) {
+        const int take = free < wanted ? free : wanted;
+        if (available->compare_exchange_weak(free, free - take)) {
+            int low = lowWater.load(std::memory_order_relaxed);
+            while (free - take < low && !lowWater.compare_exchange_weak(low, free - take, std::memory_order_relaxed)) {}
+            return take;
+        }
+    }
+    return 0;
 }
 
-void ChargeStationManager::release() {
+void ChargeStationManager::release(int count) {
+    if (count <= 0) return;
+    available->fetch_add(count);
     {
+        // a waiter either sees the new count or is already waiting when notified
         std::lock_guard<std::mutex> lock(mtx);
-        ++availableStations;
     }
-    cv.notify_one();
+    if (count == 1) cv.notify_one();
+    else cv.notify_all();
 }
 
 int ChargeStationManager::getAvailable() const {
-    std::lock_guard<std::mutex> lock(mtx);
-    return availableStations;
+    return available->load(std::memory_order_relaxed);
 }
 void ChargeStationManager::stopAll()
 {
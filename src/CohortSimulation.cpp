@@ -0,0 +1,192 @@
+#include "CohortSimulation.h"
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <utility>
+
+CohortSimulation::CohortSimulation(const CohortConfig& cfg)
+    : config(cfg), stationManager(cfg.stations) {
+    for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        const VehicleKind kind = static_cast<VehicleKind>(k);
+        Profile& p = profiles[k];
+        p.cycle = std::make_unique<Vehicle>(vehicleSpecs[k], kind);
+        p.idle = std::make_unique<Vehicle>(vehicleSpecs[k], kind);
+        p.partial = std::make_unique<Vehicle>(vehicleSpecs[k], kind);
+        // a cycle always starts from a full or an empty battery, so its length is a per-kind constant
+        p.driveTicks = static_cast<std::uint64_t>(p.cycle->ticksUntilDepleted());
+        p.chargeTicks = static_cast<std::uint64_t>(p.cycle->ticksUntilCharged());
+        p.cycle->runFor(static_cast<double>(p.driveTicks));
+        p.cycle->chargeFor(static_cast<double>(p.chargeTicks));
+    }
+}
+
+void CohortSimulation::run() {
+    counters = CohortStats();
+    due.clear();
+    waitQueue.clear();
+    waiting = 0;
+    live = 0;
+    stationManager.reset();
+    stationMetrics.reset(stationManager.getTotal());
+    deploy();
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::uint64_t endTick = static_cast<std::uint64_t>(config.duration.count());
+    for (std::uint64_t tick = 1; tick <= endTick; ) {
+        const std::uint64_t next = due.empty() ? endTick + 1 : std::min(due.begin()->first, endTick + 1);
+        const int busy = stationManager.getTotal() - stationManager.getAvailable();
+        if (next > tick) {
+            // nothing is due before next, and the last dispatch left no free station with a vehicle waiting
+            stationMetrics.sampleTick(busy, waiting, next - tick);
+            tick = next;
+            continue;
+        }
+        advance(tick);
+        dispatch(tick);
+        recordTick();
+        stationMetrics.sampleTick(stationManager.getTotal() - stationManager.getAvailable(), waiting);
+        counters.peakCohorts = std::max(counters.peakCohorts, live);
+        ++counters.eventTicks;
+        ++tick;
+    }
+    counters.ticks = endTick;
+    counters.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    finish(endTick);
+}
+
+void CohortSimulation::deploy() {
+    std::mt19937 gen(config.seed);
+    std::uniform_int_distribution<int> dis(0, static_cast<int>(kBuiltinVehicleKinds) - 1);
+    std::array<std::uint64_t, kBuiltinVehicleKinds> deployed{};
+    for (std::uint64_t id = 0; id < config.fleetSize; ++id) {
+        const VehicleKind kind = config.kindOf ? config.kindOf(id) : static_cast<VehicleKind>(dis(gen));
+        ++deployed[static_cast<std::size_t>(kind)];
+    }
+    // everyone of a kind starts full at tick 0: one cohort per kind
+    for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        if (deployed[k] == 0) continue;
+        schedule(profiles[k].driveTicks, Cohort{static_cast<VehicleKind>(k), FleetPhase::Running, deployed[k], 0});
+        statsManager().recordWeighted(profiles[k].idle->getType(), *profiles[k].idle, StatType::TotalTestVehicle,
+                                      deployed[k]);
+    }
+    counters.peakCohorts = live;
+}
+
+void CohortSimulation::schedule(std::uint64_t tick, const Cohort& cohort) {
+    std::vector<Cohort>& bucket = due[tick];
+    for (Cohort& c : bucket) {
+        if (c.kind == cohort.kind && c.phase == cohort.phase) {
+            c.count += cohort.count;
+            ++counters.merges;
+            return;
+        }
+    }
+    bucket.push_back(cohort);
+    ++live;
+}
+
+void CohortSimulation::enqueue(const Cohort& cohort) {
+    if (!waitQueue.empty() && waitQueue.back().kind == cohort.kind && waitQueue.back().depleted == cohort.depleted) {
+        waitQueue.back().count += cohort.count;
+        ++counters.merges;
+    } else {
+        waitQueue.push_back(cohort);
+        ++live;
+    }
+    waiting += cohort.count;
+}
+
+void CohortSimulation::advance(std::uint64_t tick) {
+    auto node = due.extract(due.begin());
+    for (Cohort& c : node.mapped()) {
+        const std::size_t k = static_cast<std::size_t>(c.kind);
+        --live;
+        ++counters.cohortSteps;
+        counters.vehicleSteps += c.count;
+        if (c.phase == FleetPhase::Running) {
+            depletedNow[k] += c.count;
+            enqueue(Cohort{c.kind, FleetPhase::Waiting, c.count, tick});
+        } else {
+            chargedNow[k] += c.count;
+            // a charging cohort holds one station per vehicle, so its count fits the station count
+            stationManager.release(static_cast<int>(c.count));
+            stationMetrics.recordCharge(profiles[k].chargeTicks, c.count);
+            schedule(tick + profiles[k].driveTicks, Cohort{c.kind, FleetPhase::Running, c.count, 0});
+        }
+    }
+}
+
+void CohortSimulation::dispatch(std::uint64_t tick) {
+    if (waitQueue.empty()) return;
+    std::uint64_t free = static_cast<std::uint64_t>(
+        stationManager.tryAcquireUpTo(static_cast<int>(std::min<std::uint64_t>(waiting, std::numeric_limits<int>::max()))));
+    while (free > 0) {
+        Cohort& front = waitQueue.front();
+        const std::size_t k = static_cast<std::size_t>(front.kind);
+        const std::uint64_t admitted = std::min(front.count, free);
+        stationMetrics.recordWait(tick - front.depleted, admitted);
+        dispatchedNow[k] += admitted;
+        ++counters.cohortSteps;
+        counters.vehicleSteps += admitted;
+        schedule(tick + profiles[k].chargeTicks, Cohort{front.kind, FleetPhase::Charging, admitted, 0});
+        waiting -= admitted;
+        free -= admitted;
+        if (admitted < front.count) {
+            // the rest keep their place at the head of the queue
+            front.count -= admitted;
+            ++counters.splits;
+        } else {
+            waitQueue.pop_front();
+            --live;
+        }
+    }
+}
+
+void CohortSimulation::recordTick() {
+    // every vehicle of a kind that changed phase this tick did the same full run or charge
+    for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        Vehicle& cycle = *profiles[k].cycle;
+        const std::string& type = cycle.getType();
+        statsManager().recordWeighted(type, cycle, StatType::TotalTime, std::exchange(depletedNow[k], 0));
+        statsManager().recordWeighted(type, cycle, StatType::TotalChargeCycle, std::exchange(dispatchedNow[k], 0));
+        const std::uint64_t charged = std::exchange(chargedNow[k], 0);
+        statsManager().recordWeighted(type, cycle, StatType::TotalChargeTime, charged);
+        statsManager().recordWeighted(type, cycle, StatType::TotalTestVehicle, charged);
+    }
+}
+
+void CohortSimulation::finish(std::uint64_t tick) {
+    // as Simulation does for a stopped run: credit the partial phase, then record every
+    // vehicle's running and charging time; a waiting vehicle has neither
+    for (const auto& [dueTick, bucket] : due) {
+        for (const Cohort& c : bucket) {
+            const std::size_t k = static_cast<std::size_t>(c.kind);
+            Vehicle& v = *profiles[k].partial;
+            v.resetRunningTime();
+            v.resetChargingTime();
+            if (c.phase == FleetPhase::Running) v.runFor(static_cast<double>(tick - (dueTick - profiles[k].driveTicks)));
+            else {
+                v.chargeFor(static_cast<double>(tick - (dueTick - profiles[k].chargeTicks)));
+                stationManager.release(static_cast<int>(c.count));
+            }
+            statsManager().recordWeighted(v.getType(), v, StatType::PartialChargeTime, c.count);
+            statsManager().recordWeighted(v.getType(), v, StatType::PartialTime, c.count);
+        }
+    }
+    for (const Cohort& c : waitQueue) {
+        Vehicle& idle = *profiles[static_cast<std::size_t>(c.kind)].idle;
+        statsManager().recordWeighted(idle.getType(), idle, StatType::PartialChargeTime, c.count);
+        statsManager().recordWeighted(idle.getType(), idle, StatType::PartialTime, c.count);
+    }
+}
+
+void CohortSimulation::printResults(std::ostream& os) const {
+    const CohortStats& s = counters;
+    os << "Cohort fleet: " << config.fleetSize << " vehicles, peak " << s.peakCohorts << " cohorts\n"
+       << "  ticks: " << s.ticks << " (" << s.eventTicks << " with phase changes) in " << s.wallSeconds << " s\n"
+       << "  cohort steps: " << s.cohortSteps << " for " << s.vehicleSteps << " vehicle phase changes ("
+       << (s.cohortSteps > 0 ? static_cast<double>(s.vehicleSteps) / static_cast<double>(s.cohortSteps) : 0)
+       << " per step); splits " << s.splits << ", merges " << s.merges << "\n"
+       << stationMetrics.report();
+}
@@ -0,0 +1,291 @@
+#include "CycleExport.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char kMagic[8] = {'V', 'S', 'C', 'Y', 'C', '0', '0', '1'};
+
+// every column block starts on an 8-byte boundary so mapped columns can be read in place
+constexpr std::uint64_t alignUp(std::uint64_t n) { return (n + 7) & ~std::uint64_t{7}; }
+
+std::atomic<std::uint64_t> nextExporterId{1};
+
+template<typename T>
+bool readAt(const unsigned char* base, std::size_t length, std::uint64_t& pos, T& out) {
+    if (pos + sizeof(T) > length) return false;
+    std::memcpy(&out, base + pos, sizeof(T));
+    pos += sizeof(T);
+    return true;
+}
+}
+
+void CycleExporter::Buffer::reserve(std::size_t rows) {
+    vehicleId.reserve(rows);
+    type.reserve(rows);
+    start.reserve(rows);
+    duration.reserve(rows);
+    distance.reserve(rows);
+    chargeWait.reserve(rows);
+    chargeTime.reserve(rows);
+}
+
+void CycleExporter::Buffer::clear() {
+    vehicleId.clear();
+    type.clear();
+    start.clear();
+    duration.clear();
+    distance.clear();
+    chargeWait.clear();
+    chargeTime.clear();
+}
+
+void CycleExporter::Buffer::swapColumns(Buffer& other) {
+    vehicleId.swap(other.vehicleId);
+    type.swap(other.type);
+    start.swap(other.start);
+    duration.swap(other.duration);
+    distance.swap(other.distance);
+    chargeWait.swap(other.chargeWait);
+    chargeTime.swap(other.chargeTime);
+}
+
+CycleExporter::CycleExporter(const std::string& path, std::size_t rowsPerGroup)
+    : file(std::fopen(path.c_str(), "wb")),
+      rowsPerGroup(std::max<std::size_t>(rowsPerGroup, 1)),
+      id(nextExporterId.fetch_add(1, std::memory_order_relaxed)) {
+    if (!file) {
+        closed = true;
+        return;
+    }
+    writeBlock(kMagic, sizeof(kMagic));
+    writer = std::thread([this] { writerLoop(); });
+}
+
+CycleExporter::~CycleExporter() {
+    close();
+}
+
+CycleExporter::Buffer& CycleExporter::localBuffer() {
+    // one buffer per (thread, exporter); the id check makes a stale cache from an earlier exporter miss
+    thread_local std::uint64_t cachedOwner = 0;
+    thread_local Buffer* cached = nullptr;
+    if (cachedOwner == id) return *cached;
+
+    std::unique_ptr<Buffer> buf = takeSpare();
+    cached = buf.get();
+    cachedOwner = id;
+    std::lock_guard<std::mutex> lock(mtx);
+    active.push_back(std::move(buf));
+    return *cached;
+}
+
+std::unique_ptr<CycleExporter::Buffer> CycleExporter::takeSpare() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (!spares.empty()) {
+            auto buf = std::move(spares.back());
+            spares.pop_back();
+            return buf;
+        }
+    }
+    auto buf = std::make_unique<Buffer>();
+    buf->reserve(rowsPerGroup);
+    return buf;
+}
+
+std::uint16_t CycleExporter::typeCode(Buffer& buf, std::string_view type) {
+    for (const auto& [name, code] : buf.typeCache) {
+        if (name == type) return code;
+    }
+    std::uint16_t code;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        auto [it, inserted] = typeCodes.try_emplace(std::string(type), static_cast<std::uint16_t>(typeNames.size()));
+        if (inserted) typeNames.emplace_back(type);
+        code = it->second;
+    }
+    buf.typeCache.emplace_back(std::string(type), code);
+    return code;
+}
+
+void CycleExporter::append(const CycleRow& row) {
+    if (closed.load(std::memory_order_relaxed)) return;
+    Buffer& buf = localBuffer();
+    buf.vehicleId.push_back(row.vehicleId);
+    buf.type.push_back(typeCode(buf, row.type));
+    buf.start.push_back(row.start);
+    buf.duration.push_back(row.duration);
+    buf.distance.push_back(row.distance);
+    buf.chargeWait.push_back(row.chargeWait);
+    buf.chargeTime.push_back(row.chargeTime);
+
+    if (buf.size() >= rowsPerGroup) {
+        // hand the full columns to the writer and keep appending into a spare's storage
+        std::unique_ptr<Buffer> full = takeSpare();
+        buf.swapColumns(*full);
+        submit(std::move(full));
+    }
+}
+
+void CycleExporter::submit(std::unique_ptr<Buffer> full) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        fullBuffers.push_back(std::move(full));
+    }
+    cv.notify_one();
+}
+
+void CycleExporter::writerLoop() {
+    TraceRecorder::setThreadName("cycle writer");
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        cv.wait(lock, [this] { return closing || !fullBuffers.empty(); });
+        if (fullBuffers.empty()) return;  // closing and drained
+
+        std::unique_ptr<Buffer> buf = std::move(fullBuffers.front());
+        fullBuffers.pop_front();
+        lock.unlock();
+        writeGroup(*buf);
+        buf->clear();
+        lock.lock();
+        written += index.back().rows;
+        spares.push_back(std::move(buf));
+    }
+}
+
+void CycleExporter::writeBlock(const void* data, std::size_t bytes) {
+    if (bytes > 0) std::fwrite(data, 1, bytes, file);
+    fileOffset += bytes;
+}
+
+void CycleExporter::writeGroup(const Buffer& buf) {
+    TraceSpan span("cycle flush", "stats", static_cast<std::int64_t>(buf.size()));
+    GroupIndex group{};
+    group.rows = buf.size();
+    auto column = [&](CycleColumn col, const auto& values) {
+        static const char zeros[8] = {};
+        writeBlock(zeros, alignUp(fileOffset) - fileOffset);
+        group.offsets[static_cast<std::size_t>(col)] = fileOffset;
+        writeBlock(values.data(), values.size() * sizeof(values[0]));
+    };
+    column(CycleColumn::VehicleId, buf.vehicleId);
+    column(CycleColumn::Type, buf.type);
+    column(CycleColumn::Start, buf.start);
+    column(CycleColumn::Duration, buf.duration);
+    column(CycleColumn::Distance, buf.distance);
+    column(CycleColumn::ChargeWait, buf.chargeWait);
+    column(CycleColumn::ChargeTime, buf.chargeTime);
+    index.push_back(group);
+}
+
+void CycleExporter::close() {
+    if (!file) return;
+    closed = true;
+    {
+        // partially filled buffers become the last row groups
+        std::lock_guard<std::mutex> lock(mtx);
+        for (auto& buf : active) {
+            if (buf->size() > 0) fullBuffers.push_back(std::move(buf));
+        }
+        active.clear();
+        closing = true;
+    }
+    cv.notify_one();
+    writer.join();
+
+    // footer: type dictionary, row-group index, footer offset, magic
+    const std::uint64_t footerStart = fileOffset;
+    const auto typeCount = static_cast<std::uint32_t>(typeNames.size());
+    writeBlock(&typeCount, sizeof(typeCount));
+    for (const auto& name : typeNames) {
+        const auto len = static_cast<std::uint16_t>(name.size());
+        writeBlock(&len, sizeof(len));
+        writeBlock(name.data(), name.size());
+    }
+    const auto groupCount = static_cast<std::uint32_t>(index.size());
+    writeBlock(&groupCount, sizeof(groupCount));
+    for (const auto& group : index) {
+        writeBlock(&group.rows, sizeof(group.rows));
+        writeBlock(group.offsets.data(), sizeof(group.offsets));
+    }
+    writeBlock(&footerStart, sizeof(footerStart));
+    writeBlock(kMagic, sizeof(kMagic));
+
+    std::fclose(file);
+    file = nullptr;
+}
+
+std::uint64_t CycleExporter::rowsWritten() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return written;
+}
+
+CycleFile::CycleFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st{};
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(2 * sizeof(kMagic) + sizeof(std::uint64_t))) {
+        ::close(fd);
+        return;
+    }
+    length = static_cast<std::size_t>(st.st_size);
+    void* map = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return;
+    base = static_cast<const unsigned char*>(map);
+    // analysis passes stream whole columns front to back
+    ::madvise(map, length, MADV_SEQUENTIAL);
+
+    auto fail = [this] {
+        ::munmap(const_cast<unsigned char*>(base), length);
+        base = nullptr;
+        groups.clear();
+        typeNames.clear();
+    };
+    if (std::memcmp(base, kMagic, sizeof(kMagic)) != 0 ||
+        std::memcmp(base + length - sizeof(kMagic), kMagic, sizeof(kMagic)) != 0) {
+        fail();
+        return;
+    }
+
+    std::uint64_t pos = length - sizeof(kMagic) - sizeof(std::uint64_t);
+    std::uint64_t footerStart = 0;
+    readAt(base, length, pos, footerStart);
+    pos = footerStart;
+
+    std::uint32_t typeCount = 0;
+    if (!readAt(base, length, pos, typeCount)) { fail(); return; }
+    for (std::uint32_t i = 0; i < typeCount; ++i) {
+        std::uint16_t len = 0;
+        if (!readAt(base, length, pos, len) || pos + len > length) { fail(); return; }
+        typeNames.emplace_back(reinterpret_cast<const char*>(base + pos), len);
+        pos += len;
+    }
+
+    static constexpr std::size_t widths[kCycleColumns] = {4, 2, 8, 8, 8, 8, 8};
+    std::uint32_t groupCount = 0;
+    if (!readAt(base, length, pos, groupCount)) { fail(); return; }
+    for (std::uint32_t i = 0; i < groupCount; ++i) {
+        Group g{};
+        if (!readAt(base, length, pos, g.rows) || !readAt(base, length, pos, g.offsets)) { fail(); return; }
+        for (std::size_t c = 0; c < kCycleColumns; ++c) {
+            if (g.offsets[c] + g.rows * widths[c] > footerStart) { fail(); return; }
+        }
+        groups.push_back(g);
+    }
+}
+
+CycleFile::~CycleFile() {
+    if (base) ::munmap(const_cast<unsigned char*>(base), length);
+}
+
+std::uint64_t CycleFile::rowCount() const {
+    std::uint64_t rows = 0;
+    for (const auto& g : groups) rows += g.rows;
+    return rows;
+}
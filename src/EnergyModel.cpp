@@ -0,0 +1,124 @@
+#include "EnergyModel.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+std::uint64_t EnergyTable::ticksToDrain(double target) const {
+    if (target <= 0) return 0;
+    // whole periods first, then a binary search within the last one
+    const std::uint64_t periods = static_cast<std::uint64_t>(target / drain[kPeriod]);
+    const double rest = target - static_cast<double>(periods) * drain[kPeriod];
+    const auto it = std::lower_bound(drain.begin(), drain.end(), rest);
+    std::uint64_t ticks = periods * kPeriod + static_cast<std::uint64_t>(it - drain.begin());
+    // settle rounding differences against drainAt(), the value the kernels compare
+    while (drainAt(ticks) < target) ++ticks;
+    while (ticks > 0 && drainAt(ticks - 1) >= target) --ticks;
+    return ticks;
+}
+
+const EnergyTable& EnergyTable::flat() {
+    static const EnergyTable table = [] {
+        EnergyTable t;
+        for (std::size_t i = 0; i <= kPeriod; ++i) {
+            t.drain[i] = static_cast<double>(i);
+            t.travel[i] = static_cast<double>(i);
+        }
+        return t;
+    }();
+    return table;
+}
+
+EnergyModel::EnergyModel(const VehicleSpec& spec) : spec(spec) {
+    const double fullMass = 1.0 + kPassengerMassShare * spec.passengers;
+    for (std::size_t s = 0; s < kSpeedBins; ++s) {
+        const double ratio = kMaxSpeedRatio * static_cast<double>(s) / (kSpeedBins - 1);
+        for (int load = 0; load <= kMaxEnergyLoad; ++load) {
+            const double mass = (1.0 + kPassengerMassShare * load) / fullMass;
+            grid[s][load] = spec.energyUse * ((1.0 - kAeroShare) * mass + kAeroShare * ratio * ratio);
+        }
+    }
+}
+
+double EnergyModel::kwhPerMile(double speed, double load) const {
+    const double sPos = std::clamp(speed / spec.cruiseSpeed / kMaxSpeedRatio, 0.0, 1.0) * (kSpeedBins - 1);
+    const double lPos = std::clamp(load, 0.0, static_cast<double>(std::min(spec.passengers, kMaxEnergyLoad)));
+    const std::size_t s0 = std::min(static_cast<std::size_t>(sPos), kSpeedBins - 2);
+    const std::size_t l0 = std::min(static_cast<std::size_t>(lPos), static_cast<std::size_t>(kMaxEnergyLoad - 1));
+    const double sf = sPos - s0;
+    const double lf = lPos - l0;
+    const double lo = grid[s0][l0] + (grid[s0][l0 + 1] - grid[s0][l0]) * lf;
+    const double hi = grid[s0 + 1][l0] + (grid[s0 + 1][l0 + 1] - grid[s0 + 1][l0]) * lf;
+    return lo + (hi - lo) * sf;
+}
+
+EnergyTable EnergyModel::buildTable(const std::array<double, EnergyTable::kPeriod>& profile, double load) const {
+    EnergyTable table;
+    for (std::size_t i = 0; i < EnergyTable::kPeriod; ++i) {
+        // one second at ratio r of cruise covers r cruise-seconds and uses r * (kWh/mile) / energyUse of them
+        const double ratio = profile[i];
+        const double use = ratio * kwhPerMile(ratio * spec.cruiseSpeed, load) / spec.energyUse;
+        table.drain[i + 1] = table.drain[i] + use;
+        table.travel[i + 1] = table.travel[i] + ratio;
+    }
+    return table;
+}
+
+namespace {
+// drive-cycle keyframes per built-in kind: (tick within the period, speed relative to cruise), linearly interpolated
+using Keyframes = std::vector<std::pair<std::size_t, double>>;
+
+const Keyframes& keyframesFor(VehicleKind kind) {
+    static const Keyframes cruiser = {{0, 0.5}, {24, 1.0}, {200, 1.0}, {232, 0.8}, {256, 0.5}};
+    static const Keyframes mixed = {{0, 0.4}, {32, 1.0}, {128, 1.0}, {160, 0.6}, {208, 0.9}, {256, 0.4}};
+    static const Keyframes urban = {{0, 0.2}, {40, 0.9}, {80, 0.5}, {120, 1.0}, {176, 0.3}, {216, 0.8}, {256, 0.2}};
+    switch (kind) {
+        case VehicleKind::Alpha:
+        case VehicleKind::Charlie: return cruiser;
+        case VehicleKind::Echo:    return urban;
+        default:                   return mixed;
+    }
+}
+
+std::array<double, EnergyTable::kPeriod> sampleProfile(const Keyframes& keys) {
+    std::array<double, EnergyTable::kPeriod> profile{};
+    for (std::size_t k = 0; k + 1 < keys.size(); ++k) {
+        const auto [t0, r0] = keys[k];
+        const auto [t1, r1] = keys[k + 1];
+        for (std::size_t t = t0; t < t1; ++t) {
+            profile[t] = r0 + (r1 - r0) * static_cast<double>(t - t0) / static_cast<double>(t1 - t0);
+        }
+    }
+    return profile;
+}
+
+// every built-in kind at every load, built once
+struct EnergyTables {
+    std::array<std::array<double, EnergyTable::kPeriod>, kBuiltinVehicleKinds> profiles;
+    std::array<std::array<EnergyTable, kMaxEnergyLoad + 1>, kBuiltinVehicleKinds> tables;
+
+    EnergyTables() {
+        for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+            profiles[k] = sampleProfile(keyframesFor(static_cast<VehicleKind>(k)));
+            const EnergyModel model(vehicleSpecs[k]);
+            for (int load = 0; load <= kMaxEnergyLoad; ++load) {
+                tables[k][load] = model.buildTable(profiles[k], load);
+            }
+        }
+    }
+
+    static const EnergyTables& instance() {
+        static const EnergyTables tables;
+        return tables;
+    }
+};
+}
+
+const std::array<double, EnergyTable::kPeriod>& speedProfileFor(VehicleKind kind) {
+    return EnergyTables::instance().profiles[static_cast<std::size_t>(kind)];
+}
+
+const EnergyTable& energyTableFor(VehicleKind kind, int load) {
+    if (kind == VehicleKind::Custom) return EnergyTable::flat();
+    return EnergyTables::instance().tables[static_cast<std::size_t>(kind)][std::clamp(load, 0, kMaxEnergyLoad)];
+}
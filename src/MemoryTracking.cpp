@@ -0,0 +1,34 @@
+#include "MemoryTracking.h"
+
+MemoryTracker& MemoryTracker::instance() {
+    static MemoryTracker tracker;
+    return tracker;
+}
+
+MemoryTracker::Counts MemoryTracker::counts(MemSubsystem sub) const {
+    const Slot& s = slots[static_cast<std::size_t>(sub)];
+    Counts c;
+    c.liveBytes = s.liveBytes.load(std::memory_order_relaxed);
+    c.peakBytes = s.peakBytes.load(std::memory_order_relaxed);
+    c.allocations = s.allocations.load(std::memory_order_relaxed);
+    return c;
+}
+
+std::array<MemoryTracker::Counts, static_cast<std::size_t>(MemSubsystem::Count)> MemoryTracker::countsAll() const {
+    std::array<Counts, static_cast<std::size_t>(MemSubsystem::Count)> all;
+    for (std::size_t i = 0; i < all.size(); ++i) all[i] = counts(static_cast<MemSubsystem>(i));
+    return all;
+}
+
+const char* MemoryTracker::name(MemSubsystem sub) {
+    switch (sub) {
+        case MemSubsystem::Vehicles:        return "Vehicles";
+        case MemSubsystem::RunnerScratch:   return "RunnerScratch";
+        case MemSubsystem::DispatchScratch: return "DispatchScratch";
+        case MemSubsystem::ChargeTimers:    return "ChargeTimers";
+        case MemSubsystem::StatsMap:        return "StatsMap";
+        case MemSubsystem::LogFormatting:   return "LogFormatting";
+        case MemSubsystem::Test:            return "Test";
+        default:                            return "Untracked";
+    }
+}
@@ -0,0 +1,177 @@
+#include "MetricsServer.h"
+#include "Simulation.h"
+#include <sstream>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+MetricsServer::MetricsServer(std::function<std::string()> render)
+    : render(std::move(render)) {}
+
+MetricsServer::~MetricsServer() {
+    stop();
+}
+
+bool MetricsServer::start(std::uint16_t port) {
+    if (running) return true;
+
+    listenFd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (listenFd < 0) return false;
+    int reuse = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(port);
+    socklen_t len = sizeof(addr);
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::listen(listenFd, 8) != 0 ||
+        ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    boundPort = ntohs(addr.sin_port);
+
+    running = true;
+    worker = std::thread(&MetricsServer::serve, this);
+    return true;
+}
+
+void MetricsServer::stop() {
+    running = false;
+    if (worker.joinable()) worker.join();
+    if (listenFd >= 0) ::close(listenFd);
+    listenFd = -1;
+    boundPort = 0;
+}
+
+void MetricsServer::serve() {
+    while (running) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        if (::poll(&pfd, 1, 100) <= 0) continue;
+        int fd = ::accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+        respond(fd);
+        ::close(fd);
+    }
+}
+
+void MetricsServer::respond(int fd) {
+    // read (and ignore) the request head; give slow clients a bounded wait
+    char buf[1024];
+    std::string request;
+    while (request.find("\r\n\r\n") == std::string::npos && request.size() < 8192) {
+        pollfd pfd{fd, POLLIN, 0};
+        if (::poll(&pfd, 1, 1000) <= 0) break;
+        ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n <= 0) break;
+        request.append(buf, static_cast<size_t>(n));
+    }
+
+    const std::string body = render();
+    std::ostringstream oss;
+    oss << "HTTP/1.0 200 OK\r\n"
+        << "Content-Type: text/plain; version=0.0.4\r\n"
+        << "Content-Length: " << body.size() << "\r\n"
+        << "Connection: close\r\n\r\n"
+        << body;
+    const std::string response = oss.str();
+
+    size_t sent = 0;
+    while (sent < response.size()) {
+        ssize_t n = ::send(fd, response.data() + sent, response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) break;
+        sent += static_cast<size_t>(n);
+    }
+}
+
+std::string toPrometheus(const SimulationSnapshot& snap) {
+    std::ostringstream os;
+    auto family = [&os](const char* name, const char* type, const char* help) {
+        os << "# HELP " << name << " " << help << "\n# TYPE " << name << " " << type << "\n";
+    };
+
+    family("vehiclesim_simulated_seconds", "counter", "Simulated seconds (ticks) completed.");
+    os << "vehiclesim_simulated_seconds " << snap.simulatedSeconds << "\n";
+    family("vehiclesim_ticks_per_second", "gauge", "Average simulated ticks per wall-clock second this run.");
+    os << "vehiclesim_ticks_per_second " << (snap.wallSeconds > 0 ? snap.simulatedSeconds / snap.wallSeconds : 0) << "\n";
+
+    family("vehiclesim_tick_lateness_seconds", "summary", "How late ticks started against their real-time deadline.");
+    os << "vehiclesim_tick_lateness_seconds{quantile=\"0.5\"} " << snap.pacing.p50LatenessMs / 1000 << "\n"
+       << "vehiclesim_tick_lateness_seconds{quantile=\"0.99\"} " << snap.pacing.p99LatenessMs / 1000 << "\n"
+       << "vehiclesim_tick_lateness_seconds_count " << snap.pacing.ticks << "\n";
+    family("vehiclesim_tick_overruns_total", "counter", "Ticks whose work ended after their deadline.");
+    os << "vehiclesim_tick_overruns_total " << snap.pacing.overruns << "\n";
+
+    family("vehiclesim_queue_depth", "gauge", "Vehicles in each lifecycle queue.");
+    os << "vehiclesim_queue_depth{queue=\"run\"} " << snap.runQueueDepth << "\n"
+       << "vehiclesim_queue_depth{queue=\"need_charge\"} " << snap.needChargeQueueDepth << "\n"
+       << "vehiclesim_queue_depth{queue=\"charging\"} " << snap.chargeQueueDepth << "\n";
+    family("vehiclesim_queue_high_water", "gauge", "Deepest each hand-off queue has been this run.");
+    os << "vehiclesim_queue_high_water{queue=\"run\"} " << snap.runQueueHighWater << "\n"
+       << "vehiclesim_queue_high_water{queue=\"need_charge\"} " << snap.needChargeQueueHighWater << "\n"
+       << "vehiclesim_queue_high_water{queue=\"charge\"} " << snap.chargeQueueHighWater << "\n";
+
+    family("vehiclesim_stations", "gauge", "Configured charging stations.");
+    os << "vehiclesim_stations " << snap.stationsTotal << "\n";
+    family("vehiclesim_stations_busy", "gauge", "Charging stations currently occupied.");
+    os << "vehiclesim_stations_busy " << (snap.stationsTotal - snap.stationsAvailable) << "\n";
+    const StationReport& st = snap.stationReport;
+    family("vehiclesim_station_utilization", "gauge", "Busy station-ticks over available station-ticks this run (0-1).");
+    os << "vehiclesim_station_utilization " << st.utilizationPct / 100 << "\n";
+    family("vehiclesim_station_idle_while_queued_ratio", "gauge", "Share of ticks ending with a free station while vehicles wait.");
+    os << "vehiclesim_station_idle_while_queued_ratio " << st.idleWhileQueuedPct / 100 << "\n";
+    family("vehiclesim_station_wait_seconds", "summary", "Simulated time from depletion to acquiring a station.");
+    os << "vehiclesim_station_wait_seconds{quantile=\"0.5\"} " << st.p50WaitSeconds << "\n"
+       << "vehiclesim_station_wait_seconds{quantile=\"0.9\"} " << st.p90WaitSeconds << "\n"
+       << "vehiclesim_station_wait_seconds{quantile=\"0.99\"} " << st.p99WaitSeconds << "\n"
+       << "vehiclesim_station_wait_seconds_sum " << st.meanWaitSeconds * static_cast<double>(st.waits) << "\n"
+       << "vehiclesim_station_wait_seconds_count " << st.waits << "\n";
+    family("vehiclesim_charges_completed_total", "counter", "Charges completed this run.");
+    os << "vehiclesim_charges_completed_total " << st.charges << "\n";
+    family("vehiclesim_charges_per_station_hour", "gauge", "Charges completed per station per simulated hour this run.");
+    os << "vehiclesim_charges_per_station_hour " << st.chargesPerStationHour << "\n";
+
+    family("vehiclesim_workers", "gauge", "Pipeline workers in use across all stages (adaptive, within the CPU budget).");
+    os << "vehiclesim_workers " << snap.workersInUse << "\n";
+    family("vehiclesim_runner_workers", "gauge", "Pipeline workers given to the runner stage.");
+    os << "vehiclesim_runner_workers " << snap.runnerWorkers << "\n";
+
+    static const char* stageNames[] = {"runner", "dispatcher", "charger"};
+    family("vehiclesim_stage_cpu_seconds_total", "counter", "CPU time spent in each pipeline stage.");
+    for (size_t i = 0; i < snap.stageCpuMs.size(); ++i) {
+        os << "vehiclesim_stage_cpu_seconds_total{stage=\"" << stageNames[i] << "\"} " << snap.stageCpuMs[i] / 1000 << "\n";
+    }
+    family("vehiclesim_stage_utilization", "gauge", "Stage CPU time divided by wall time this run (cores busy).");
+    for (size_t i = 0; i < snap.stageCpuMs.size(); ++i) {
+        os << "vehiclesim_stage_utilization{stage=\"" << stageNames[i] << "\"} "
+           << (snap.wallSeconds > 0 ? snap.stageCpuMs[i] / 1000 / snap.wallSeconds : 0) << "\n";
+    }
+
+    struct TypeMetric {
+        const char* name;
+        const char* help;
+        double VehicleStatsSnapshot::*field;
+    };
+    static const TypeMetric typeMetrics[] = {
+        {"vehiclesim_test_vehicles_total", "Run cycles started, per vehicle type.", &VehicleStatsSnapshot::totalTestVehicle},
+        {"vehiclesim_charge_cycles_total", "Charge cycles started, per vehicle type.", &VehicleStatsSnapshot::totalChargedVehicle},
+        {"vehiclesim_running_seconds_total", "Recorded running time, per vehicle type.", &VehicleStatsSnapshot::totalTime},
+        {"vehiclesim_charging_seconds_total", "Recorded charging time, per vehicle type.", &VehicleStatsSnapshot::totalChargeTime},
+        {"vehiclesim_distance_miles_total", "Distance travelled, per vehicle type.", &VehicleStatsSnapshot::totalDistance},
+        {"vehiclesim_faults_total", "Expected faults, per vehicle type.", &VehicleStatsSnapshot::totalFaults},
+        {"vehiclesim_passenger_miles_total", "Passenger-miles, per vehicle type.", &VehicleStatsSnapshot::totalPassengersMiles},
+    };
+    for (const auto& metric : typeMetrics) {
+        family(metric.name, "counter", metric.help);
+        for (const auto& kv : snap.stats) {
+            os << metric.name << "{type=\"" << kv.first << "\"} " << kv.second.*metric.field << "\n";
+        }
+    }
+    return os.str();
+}
@@ -0,0 +1,342 @@
+#include "OutOfCoreFleet.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <random>
+#include <utility>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+constexpr char kMagic[8] = {'V', 'S', 'F', 'L', 'E', 'E', 'T', '1'};
+constexpr std::size_t kHeaderBytes = 4096;   // records start one (4 KiB) page in
+constexpr std::size_t kRepeatBlock = 1024;   // vehicles per bulk stats record
+
+struct FileHeader {
+    char magic[8];
+    std::uint64_t count;
+    std::uint64_t chunkRecords;
+};
+
+std::size_t pageSize() {
+    static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+}
+
+// ------------------------------------------
+// FleetFile
+// ------------------------------------------
+FleetFile FleetFile::create(const std::string& path, std::uint64_t count, std::size_t chunkRecords) {
+    FleetFile file;
+    if (chunkRecords == 0) return file;
+    int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return file;
+    const std::size_t bytes = kHeaderBytes + static_cast<std::size_t>(count) * sizeof(FleetRecord);
+    // sparse until written: creating a fleet larger than RAM costs no I/O up front
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) == 0) {
+        FileHeader header{};
+        std::memcpy(header.magic, kMagic, sizeof(kMagic));
+        header.count = count;
+        header.chunkRecords = chunkRecords;
+        if (::pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header))) file.map(fd, bytes);
+    }
+    ::close(fd);
+    return file;
+}
+
+FleetFile FleetFile::open(const std::string& path) {
+    FleetFile file;
+    int fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0) return file;
+    struct stat st{};
+    if (::fstat(fd, &st) == 0 && st.st_size >= static_cast<off_t>(kHeaderBytes)) {
+        file.map(fd, static_cast<std::size_t>(st.st_size));
+    }
+    ::close(fd);
+    return file;
+}
+
+bool FleetFile::map(int fd, std::size_t bytes) {
+    void* m = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (m == MAP_FAILED) return false;
+    FileHeader header{};
+    std::memcpy(&header, m, sizeof(header));
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 || header.chunkRecords == 0 ||
+        kHeaderBytes + header.count * sizeof(FleetRecord) > bytes) {
+        ::munmap(m, bytes);
+        return false;
+    }
+    base = static_cast<unsigned char*>(m);
+    length = bytes;
+    records = reinterpret_cast<FleetRecord*>(base + kHeaderBytes);
+    count = header.count;
+    chunkRecords = static_cast<std::size_t>(header.chunkRecords);
+    return true;
+}
+
+FleetFile::~FleetFile() {
+    if (base) ::munmap(base, length);
+}
+
+FleetFile::FleetFile(FleetFile&& other) noexcept { *this = std::move(other); }
+
+FleetFile& FleetFile::operator=(FleetFile&& other) noexcept {
+    if (this != &other) {
+        if (base) ::munmap(base, length);
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+        records = std::exchange(other.records, nullptr);
+        count = std::exchange(other.count, 0);
+        chunkRecords = std::exchange(other.chunkRecords, 0);
+    }
+    return *this;
+}
+
+std::span<FleetRecord> FleetFile::chunk(std::size_t index) {
+    const std::uint64_t first = static_cast<std::uint64_t>(index) * chunkRecords;
+    const std::uint64_t n = std::min<std::uint64_t>(chunkRecords, count - first);
+    return {records + first, static_cast<std::size_t>(n)};
+}
+
+std::pair<unsigned char*, std::size_t> FleetFile::pageRange(std::size_t index) const {
+    const std::uint64_t first = static_cast<std::uint64_t>(index) * chunkRecords;
+    const std::uint64_t n = std::min<std::uint64_t>(chunkRecords, count - first);
+    const std::size_t begin = kHeaderBytes + static_cast<std::size_t>(first) * sizeof(FleetRecord);
+    const std::size_t end = begin + static_cast<std::size_t>(n) * sizeof(FleetRecord);
+    const std::size_t alignedBegin = begin & ~(pageSize() - 1);
+    return {base + alignedBegin, end - alignedBegin};
+}
+
+void FleetFile::prefetch(std::size_t index) {
+    auto [addr, bytes] = pageRange(index);
+    ::madvise(addr, bytes, MADV_WILLNEED);
+}
+
+void FleetFile::retire(std::size_t index, bool dirty) {
+    auto [addr, bytes] = pageRange(index);
+    // only chunks that were stored to have dirty pages to write back
+    if (dirty) ::msync(addr, bytes, MS_ASYNC);
+#ifdef MADV_COLD
+    ::madvise(addr, bytes, MADV_COLD);
+#endif
+}
+
+void FleetFile::flush() {
+    if (base) ::msync(base, length, MS_SYNC);
+}
+
+// ------------------------------------------
+// OutOfCoreSimulation
+// ------------------------------------------
+OutOfCoreSimulation::OutOfCoreSimulation(const OutOfCoreConfig& cfg)
+    : config(cfg), stationManager(cfg.stations) {
+    for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        const VehicleKind kind = static_cast<VehicleKind>(k);
+        Profile& p = profiles[k];
+        p.cycle = std::make_unique<Vehicle>(vehicleSpecs[k], kind);
+        p.idle = std::make_unique<Vehicle>(vehicleSpecs[k], kind);
+        p.partial = std::make_unique<Vehicle>(vehicleSpecs[k], kind);
+        // a cycle always starts from a full or an empty battery, so its length is a per-kind constant
+        p.driveTicks = static_cast<std::uint64_t>(p.cycle->ticksUntilDepleted());
+        p.chargeTicks = static_cast<std::uint64_t>(p.cycle->ticksUntilCharged());
+        p.cycle->runFor(static_cast<double>(p.driveTicks));
+        p.cycle->chargeFor(static_cast<double>(p.chargeTicks));
+    }
+    repeatScratch.reserve(kRepeatBlock);
+}
+
+bool OutOfCoreSimulation::run() {
+    if (config.fleetSize > std::numeric_limits<std::uint32_t>::max()) return false;
+    file = FleetFile::create(config.path, config.fleetSize, config.chunkRecords);
+    if (!file.isOpen()) return false;
+
+    counters = OutOfCoreStats();
+    counters.mappedBytes = file.mappedBytes();
+    waitQueue.clear();
+    stationMetrics.reset(stationManager.getTotal());
+    deploy();
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::uint64_t endTick = static_cast<std::uint64_t>(config.duration.count());
+    const std::size_t chunks = file.chunkCount();
+    for (std::uint64_t tick = 1; tick <= endTick; ++tick) {
+        // take the due chunks off the schedule; runChunk puts each back under its new due tick
+        dueNow.clear();
+        while (!dueChunks.empty() && dueChunks.begin()->first <= tick) {
+            dueNow.push_back(dueChunks.begin()->second);
+            dueChunks.erase(dueChunks.begin());
+        }
+        // stream them in file order, reading the next one ahead while this one runs
+        std::sort(dueNow.begin(), dueNow.end());
+        for (std::size_t i = 0; i < dueNow.size(); ++i) {
+            if (i + 1 < dueNow.size()) file.prefetch(dueNow[i + 1]);
+            file.retire(dueNow[i], runChunk(dueNow[i], tick));
+        }
+        counters.chunkScans += dueNow.size();
+        counters.chunkSkips += chunks - dueNow.size();
+
+        dispatch(tick);
+        recordTick();
+        stationMetrics.sampleTick(stationManager.getTotal() - stationManager.getAvailable(), waitQueue.size());
+        counters.ticks = tick;
+    }
+    counters.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    finish(endTick);
+    file.flush();
+    return true;
+}
+
+void OutOfCoreSimulation::deploy() {
+    std::mt19937 gen(config.seed);
+    std::uniform_int_distribution<int> dis(0, static_cast<int>(kBuiltinVehicleKinds) - 1);
+    std::array<std::uint64_t, kBuiltinVehicleKinds> deployed{};
+
+    nextDue.assign(file.chunkCount(), FleetRecord::kNever);
+    dueChunks.clear();
+    for (std::size_t c = 0; c < file.chunkCount(); ++c) {
+        const std::uint64_t first = static_cast<std::uint64_t>(c) * file.chunkSize();
+        auto records = file.chunk(c);
+        std::uint64_t earliest = FleetRecord::kNever;
+        for (std::size_t i = 0; i < records.size(); ++i) {
+            const VehicleKind kind = config.kindOf ? config.kindOf(first + i) : static_cast<VehicleKind>(dis(gen));
+            FleetRecord& r = records[i];
+            r = FleetRecord();
+            r.kind = kind;
+            r.phase = FleetPhase::Running;
+            r.due = profiles[static_cast<std::size_t>(kind)].driveTicks;
+            earliest = std::min(earliest, r.due);
+            ++deployed[static_cast<std::size_t>(kind)];
+        }
+        scheduleChunk(c, earliest);
+        file.retire(c, true);
+    }
+    for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        recordRepeated(*profiles[k].idle, StatType::TotalTestVehicle, deployed[k]);
+    }
+}
+
+bool OutOfCoreSimulation::runChunk(std::size_t index, std::uint64_t tick) {
+    const std::uint64_t first = static_cast<std::uint64_t>(index) * file.chunkSize();
+    auto records = file.chunk(index);
+    std::uint64_t earliest = FleetRecord::kNever;
+    bool wrote = false;
+    for (std::size_t i = 0; i < records.size(); ++i) {
+        FleetRecord& r = records[i];
+        // records with nothing due are only read, so their pages stay clean
+        if (r.due <= tick) {
+            const std::size_t k = static_cast<std::size_t>(r.kind);
+            if (r.phase == FleetPhase::Running) {
+                ++depletedNow[k];
+                r.phase = FleetPhase::Waiting;
+                r.due = FleetRecord::kNever;
+                r.depleted = static_cast<std::uint32_t>(tick);
+                waitQueue.push_back(static_cast<std::uint32_t>(first + i));
+            } else {
+                ++chargedNow[k];
+                stationManager.release();
+                stationMetrics.recordCharge(profiles[k].chargeTicks);
+                r.phase = FleetPhase::Running;
+                r.due = tick + profiles[k].driveTicks;
+            }
+            ++counters.phaseChanges;
+            wrote = true;
+        }
+        earliest = std::min(earliest, r.due);
+    }
+    scheduleChunk(index, earliest);
+    counters.bytesScanned += records.size_bytes();
+    if (wrote) ++counters.dirtyChunks;
+    counters.waitQueueHighWater = std::max(counters.waitQueueHighWater, waitQueue.size());
+    return wrote;
+}
+
+void OutOfCoreSimulation::scheduleChunk(std::size_t index, std::uint64_t due) {
+    dueChunks.erase({nextDue[index], index});
+    nextDue[index] = due;
+    if (due != FleetRecord::kNever) dueChunks.insert({due, index});
+}
+
+void OutOfCoreSimulation::dispatch(std::uint64_t tick) {
+    if (waitQueue.empty()) return;
+    const int got = stationManager.tryAcquireUpTo(static_cast<int>(std::min<size_t>(waitQueue.size(), std::numeric_limits<int>::max())));
+    for (int i = 0; i < got; ++i) {
+        const std::uint32_t id = waitQueue.front();
+        waitQueue.pop_front();
+        FleetRecord& r = file[id];
+        const std::size_t k = static_cast<std::size_t>(r.kind);
+        stationMetrics.recordWait(tick - r.depleted);
+        r.phase = FleetPhase::Charging;
+        r.due = tick + profiles[k].chargeTicks;
+        const std::size_t chunk = id / file.chunkSize();
+        if (r.due < nextDue[chunk]) scheduleChunk(chunk, r.due);
+        ++dispatchedNow[k];
+        ++counters.phaseChanges;
+    }
+}
+
+void OutOfCoreSimulation::recordTick() {
+    // every vehicle of a kind that changed phase this tick did the same full run or charge
+    for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        Vehicle& cycle = *profiles[k].cycle;
+        recordRepeated(cycle, StatType::TotalTime, std::exchange(depletedNow[k], 0));
+        recordRepeated(cycle, StatType::TotalChargeCycle, std::exchange(dispatchedNow[k], 0));
+        const std::uint64_t charged = std::exchange(chargedNow[k], 0);
+        recordRepeated(cycle, StatType::TotalChargeTime, charged);
+        recordRepeated(cycle, StatType::TotalTestVehicle, charged);
+    }
+}
+
+void OutOfCoreSimulation::recordRepeated(Vehicle& v, StatType stat, std::uint64_t count) {
+    while (count > 0) {
+        const std::size_t n = static_cast<std::size_t>(std::min<std::uint64_t>(count, kRepeatBlock));
+        repeatScratch.assign(n, &v);
+        statsManager().recordBatch(v.getType(), repeatScratch, stat);
+        count -= n;
+    }
+}
+
+void OutOfCoreSimulation::finish(std::uint64_t tick) {
+    // as Simulation does for a stopped run: credit the partial phase, then record every
+    // vehicle's running and charging time; a waiting vehicle has neither
+    std::array<std::uint64_t, kBuiltinVehicleKinds> waiting{};
+    for (std::size_t c = 0; c < file.chunkCount(); ++c) {
+        for (const FleetRecord& r : file.chunk(c)) {
+            const std::size_t k = static_cast<std::size_t>(r.kind);
+            if (r.phase == FleetPhase::Waiting) {
+                ++waiting[k];
+                continue;
+            }
+            Vehicle& v = *profiles[k].partial;
+            v.resetRunningTime();
+            v.resetChargingTime();
+            if (r.phase == FleetPhase::Running) v.runFor(static_cast<double>(tick - (r.due - profiles[k].driveTicks)));
+            else {
+                v.chargeFor(static_cast<double>(tick - (r.due - profiles[k].chargeTicks)));
+                stationManager.release();
+            }
+            statsManager().record(v.getType(), v, StatType::PartialChargeTime);
+            statsManager().record(v.getType(), v, StatType::PartialTime);
+        }
+        file.retire(c, false);
+    }
+    for (std::size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        recordRepeated(*profiles[k].idle, StatType::PartialChargeTime, waiting[k]);
+        recordRepeated(*profiles[k].idle, StatType::PartialTime, waiting[k]);
+    }
+}
+
+void OutOfCoreSimulation::printResults(std::ostream& os) const {
+    const OutOfCoreStats& s = counters;
+    const double mib = 1024.0 * 1024.0;
+    os << "Out-of-core fleet: " << config.fleetSize << " vehicles in " << file.chunkCount() << " chunks of "
+       << file.chunkSize() << " (" << s.mappedBytes / mib << " MiB mapped)\n"
+       << "  ticks: " << s.ticks << " in " << s.wallSeconds << " s; chunk scans " << s.chunkScans
+       << ", skipped " << s.chunkSkips << ", written " << s.dirtyChunks << "\n"
+       << "  phase changes: " << s.phaseChanges << "; streamed " << s.bytesScanned / mib << " MiB ("
+       << (s.wallSeconds > 0 ? s.bytesScanned / mib / s.wallSeconds : 0) << " MiB/s); station queue peak "
+       << s.waitQueueHighWater << " ids\n"
+       << stationMetrics.report();
+}
@@ -0,0 +1,367 @@
+#include "ParameterSweep.h"
+#include "Tracing.h"
+#include "Vehicle.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace {
+// serialization order of SweepMetrics in cache records; append new fields at the end
+constexpr double SweepMetrics::* kMetricFields[] = {
+    &SweepMetrics::runs,
+    &SweepMetrics::distance,
+    &SweepMetrics::passengerMiles,
+    &SweepMetrics::faults,
+    &SweepMetrics::charges,
+    &SweepMetrics::utilizationPct,
+    &SweepMetrics::idleWhileQueuedPct,
+    &SweepMetrics::chargesPerStationHour,
+    &SweepMetrics::meanWaitSeconds,
+    &SweepMetrics::p99WaitSeconds,
+    &SweepMetrics::maxWaitSeconds,
+    &SweepMetrics::wallSeconds,
+};
+
+// fleet drawn kind by kind from the mix's weights with a fixed seed
+class MixDeployment : public VehicleDeployment {
+public:
+    MixDeployment(int fleetSize, const TypeMix& mix, unsigned seed) : fleetSize(fleetSize), mix(mix), seed(seed) {}
+
+    std::vector<std::unique_ptr<Vehicle>> deployVehicles() override {
+        std::mt19937 gen(seed);
+        std::discrete_distribution<size_t> pick(mix.weights.begin(), mix.weights.end());
+        std::vector<std::unique_ptr<Vehicle>> result;
+        result.reserve(static_cast<size_t>(std::max(0, fleetSize)));
+        for (int i = 0; i < fleetSize; ++i) {
+            const size_t k = pick(gen);
+            result.push_back(std::make_unique<Vehicle>(vehicleSpecs[k], static_cast<VehicleKind>(k)));
+        }
+        return result;
+    }
+
+private:
+    int fleetSize;
+    TypeMix mix;
+    unsigned seed;
+};
+
+template<typename T>
+bool parseList(const std::string& text, std::vector<T>& out, long long minimum) {
+    std::vector<T> values;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        try {
+            size_t used = 0;
+            const long long value = std::stoll(item, &used);
+            if (used != item.size() || value < minimum) return false;
+            values.push_back(static_cast<T>(value));
+        } catch (...) {
+            return false;
+        }
+    }
+    if (values.empty()) return false;
+    out = values;
+    return true;
+}
+}
+
+bool TypeMix::parse(const std::string& text, TypeMix& out) {
+    TypeMix mix;
+    mix.name = text;
+    if (text == "uniform") {
+        out = mix;
+        return true;
+    }
+    mix.weights.fill(0);
+    std::istringstream in(text);
+    std::string term;
+    while (std::getline(in, term, '+')) {
+        const size_t colon = term.find(':');
+        if (colon == std::string::npos) return false;
+        const std::string type = term.substr(0, colon);
+        double weight = 0;
+        try {
+            size_t used = 0;
+            weight = std::stod(term.substr(colon + 1), &used);
+            if (used != term.size() - colon - 1) return false;
+        } catch (...) {
+            return false;
+        }
+        if (!(weight >= 0)) return false;
+        bool known = false;
+        for (size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+            if (type == vehicleSpecs[k].type) {
+                mix.weights[k] += weight;
+                known = true;
+            }
+        }
+        if (!known) return false;
+    }
+    if (std::none_of(mix.weights.begin(), mix.weights.end(), [](double w) { return w > 0; })) return false;
+    out = mix;
+    return true;
+}
+
+std::string SweepPoint::canonical() const {
+    // the mix's name is only a label: its weights are what the result depends on
+    std::ostringstream text;
+    text << "v" << kSweepModelVersion << " stations=" << stations << " fleet=" << fleetSize << " mix=";
+    text << std::setprecision(17);
+    for (size_t k = 0; k < kBuiltinVehicleKinds; ++k) text << (k ? "," : "") << mix.weights[k];
+    text << " seed=" << seed << " duration=" << duration.count();
+    return text.str();
+}
+
+std::uint64_t SweepPoint::key() const {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : canonical()) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+SweepMetrics SweepMetrics::from(const SimulationResult& result) {
+    SweepMetrics m;
+    for (const auto& kv : result.stats) {
+        m.runs += kv.second.totalTestVehicle;
+        m.distance += kv.second.totalDistance;
+        m.passengerMiles += kv.second.totalPassengersMiles;
+        m.faults += kv.second.totalFaults;
+    }
+    const StationReport& station = result.stationReport;
+    m.charges = static_cast<double>(station.charges);
+    m.utilizationPct = station.utilizationPct;
+    m.idleWhileQueuedPct = station.idleWhileQueuedPct;
+    m.chargesPerStationHour = station.chargesPerStationHour;
+    m.meanWaitSeconds = station.meanWaitSeconds;
+    m.p99WaitSeconds = static_cast<double>(station.p99WaitSeconds);
+    m.maxWaitSeconds = static_cast<double>(station.maxWaitSeconds);
+    m.wallSeconds = result.wallSeconds;
+    return m;
+}
+
+bool SweepGrid::parse(const std::string& text, SweepGrid& out) {
+    SweepGrid grid = out;
+    std::istringstream in(text);
+    std::string axis;
+    while (std::getline(in, axis, ';')) {
+        if (axis.empty()) continue;
+        const size_t eq = axis.find('=');
+        if (eq == std::string::npos) return false;
+        const std::string name = axis.substr(0, eq);
+        const std::string values = axis.substr(eq + 1);
+        if (name == "stations") {
+            if (!parseList(values, grid.stations, 1)) return false;
+        } else if (name == "fleet") {
+            if (!parseList(values, grid.fleetSizes, 0)) return false;
+        } else if (name == "seeds") {
+            // seed 0 draws from random_device, which no cache could key
+            if (!parseList(values, grid.seeds, 1)) return false;
+        } else if (name == "mix") {
+            std::vector<TypeMix> mixes;
+            std::istringstream mixIn(values);
+            std::string item;
+            while (std::getline(mixIn, item, '|')) {
+                TypeMix mix;
+                if (!TypeMix::parse(item, mix)) return false;
+                mixes.push_back(mix);
+            }
+            if (mixes.empty()) return false;
+            grid.mixes = mixes;
+        } else {
+            return false;
+        }
+    }
+    out = grid;
+    return true;
+}
+
+std::vector<SweepPoint> SweepGrid::points() const {
+    std::vector<SweepPoint> result;
+    result.reserve(stations.size() * fleetSizes.size() * mixes.size() * seeds.size());
+    for (int s : stations) {
+        for (int f : fleetSizes) {
+            for (const TypeMix& mix : mixes) {
+                for (unsigned seed : seeds) {
+                    SweepPoint point;
+                    point.stations = s;
+                    point.fleetSize = f;
+                    point.mix = mix;
+                    point.seed = seed;
+                    point.duration = duration;
+                    result.push_back(point);
+                }
+            }
+        }
+    }
+    return result;
+}
+
+SweepCache::SweepCache(const std::string& path) : path(path) {
+    if (path.empty()) return;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        // key, canonical, then one field per metric; a torn last line lacks fields and is skipped
+        std::istringstream fields(line);
+        std::string keyText;
+        Entry entry;
+        if (!std::getline(fields, keyText, '\t') || !std::getline(fields, entry.canonical, '\t')) continue;
+        bool complete = true;
+        for (auto field : kMetricFields) {
+            std::string value;
+            if (!std::getline(fields, value, '\t')) {
+                complete = false;
+                break;
+            }
+            try {
+                entry.metrics.*field = std::stod(value);
+            } catch (...) {
+                complete = false;
+                break;
+            }
+        }
+        if (!complete) continue;
+        try {
+            entries[std::stoull(keyText, nullptr, 16)] = std::move(entry);
+        } catch (...) {
+        }
+    }
+}
+
+bool SweepCache::find(const SweepPoint& point, SweepMetrics& out) const {
+    const std::string canonical = point.canonical();
+    std::lock_guard<std::mutex> lock(mtx);
+    auto it = entries.find(point.key());
+    if (it == entries.end() || it->second.canonical != canonical) return false;
+    out = it->second.metrics;
+    return true;
+}
+
+void SweepCache::store(const SweepPoint& point, const SweepMetrics& metrics) {
+    Entry entry{point.canonical(), metrics};
+    std::ostringstream line;
+    line << std::hex << point.key() << std::dec << '\t' << entry.canonical << std::setprecision(17);
+    for (auto field : kMetricFields) line << '\t' << metrics.*field;
+    line << '\n';
+
+    std::lock_guard<std::mutex> lock(mtx);
+    entries[point.key()] = std::move(entry);
+    if (path.empty()) return;
+    // a leading newline ends a line torn by an interrupted sweep, so this record parses
+    std::ifstream probe(path, std::ios::binary | std::ios::ate);
+    const bool fresh = !probe || probe.tellg() <= 0;
+    bool torn = false;
+    if (!fresh) {
+        probe.seekg(-1, std::ios::end);
+        torn = probe.get() != '\n';
+    }
+    std::ofstream out(path, std::ios::app);
+    if (fresh) out << "# vehicle_sim sweep cache: key\tconfiguration\tmetrics\n";
+    if (torn) out << '\n';
+    out << line.str();
+    out.flush();
+    fileOk = static_cast<bool>(out);
+}
+
+size_t SweepCache::size() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return entries.size();
+}
+
+ParameterSweep::ParameterSweep(const SweepGrid& grid, SweepCache& cache, size_t jobs)
+    : grid(grid), cache(cache), jobs(jobs != 0 ? jobs : std::max(1u, std::thread::hardware_concurrency())) {}
+
+SweepMetrics ParameterSweep::simulate(const SweepPoint& point, SimulationContext& context) {
+    SimulationConfig config;
+    config.stations = point.stations;
+    config.fleetSize = point.fleetSize;
+    config.duration = point.duration;
+    config.seed = point.seed;
+    config.mode = ExecutionMode::Pipeline;
+    config.cpuBudget = 1;
+    config.deployment = [mix = point.mix](const SimulationConfig& c) {
+        return std::make_unique<MixDeployment>(c.fleetSize, mix, c.seed);
+    };
+    context.configure(config);
+    return SweepMetrics::from(context.run());
+}
+
+const std::vector<SweepRow>& ParameterSweep::run() {
+    const auto start = std::chrono::steady_clock::now();
+    const std::vector<SweepPoint> points = grid.points();
+    table.assign(points.size(), SweepRow());
+    totals = SweepSummary();
+    totals.points = points.size();
+
+    // a point repeated in the grid is computed once and copied
+    std::vector<size_t> pending;
+    std::vector<std::pair<size_t, size_t>> repeats;
+    std::unordered_map<std::uint64_t, size_t> firstPending;
+    for (size_t i = 0; i < points.size(); ++i) {
+        table[i].point = points[i];
+        if (cache.find(points[i], table[i].metrics)) {
+            table[i].cached = true;
+            ++totals.cached;
+            continue;
+        }
+        auto [it, inserted] = firstPending.emplace(points[i].key(), i);
+        if (inserted) pending.push_back(i);
+        else repeats.emplace_back(i, it->second);
+    }
+    std::stable_sort(pending.begin(), pending.end(),
+                     [&](size_t a, size_t b) { return points[a].cost() > points[b].cost(); });
+
+    std::atomic<size_t> next{0};
+    auto worker = [&] {
+        TraceRecorder::setThreadName("sweep worker");
+        SimulationContext context;
+        for (size_t n = next.fetch_add(1); n < pending.size(); n = next.fetch_add(1)) {
+            SweepRow& row = table[pending[n]];
+            TraceSpan span("sweep point", "stage", row.point.fleetSize);
+            row.metrics = simulate(row.point, context);
+            cache.store(row.point, row.metrics);
+        }
+    };
+    std::vector<std::thread> workers;
+    const size_t threads = std::min(jobs, pending.size());
+    for (size_t t = 0; t < threads; ++t) workers.emplace_back(worker);
+    for (auto& t : workers) t.join();
+
+    for (auto [copy, source] : repeats) table[copy].metrics = table[source].metrics;
+    totals.computed = pending.size();
+    totals.cached += repeats.size();
+    totals.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return table;
+}
+
+void printSweepTable(std::ostream& os, const std::vector<SweepRow>& rows) {
+    const std::ios::fmtflags flags = os.flags();
+    const std::streamsize precision = os.precision();
+    os << "\n=== Parameter sweep ===\n";
+    os << std::right << std::setw(8) << "stations" << std::setw(7) << "fleet" << "  " << std::left << std::setw(18) << "mix"
+       << std::right << std::setw(6) << "seed" << std::setw(9) << "runs" << std::setw(9) << "charges"
+       << std::setw(8) << "util%" << std::setw(9) << "idleQ%" << std::setw(10) << "ch/st-h" << std::setw(10) << "wait s"
+       << std::setw(8) << "p99 s" << std::setw(13) << "pass-miles" << std::setw(10) << "wall s" << "  source\n";
+    for (const SweepRow& row : rows) {
+        const SweepMetrics& m = row.metrics;
+        os << std::right << std::setw(8) << row.point.stations << std::setw(7) << row.point.fleetSize << "  " << std::left
+           << std::setw(18) << row.point.mix.name.substr(0, 17) << std::right << std::setw(6) << row.point.seed
+           << std::fixed << std::setprecision(0) << std::setw(9) << m.runs << std::setw(9) << m.charges
+           << std::setprecision(1) << std::setw(8) << m.utilizationPct << std::setw(9) << m.idleWhileQueuedPct
+           << std::setprecision(2) << std::setw(10) << m.chargesPerStationHour << std::setprecision(1) << std::setw(10)
+           << m.meanWaitSeconds << std::setprecision(0) << std::setw(8) << m.p99WaitSeconds << std::setw(13)
+           << m.passengerMiles << std::setprecision(3) << std::setw(10) << m.wallSeconds << "  "
+           << (row.cached ? "cache" : "run") << "\n";
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
@@ -0,0 +1,184 @@
+#include "ShardedSimulation.h"
+#include <fcntl.h>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// counters in the region are used from several processes, which is only sound for address-free atomics
+static_assert(std::atomic<int>::is_always_lock_free, "shared station counter must be lock-free");
+static_assert(std::atomic<long>::is_always_lock_free, "shared tick counter must be lock-free");
+
+namespace {
+std::atomic<unsigned> regionCounter{0};
+}
+
+// Layout of the shared-memory region. Only lock-free atomics and plain data written
+// before being published, so it is valid in every process that maps it.
+struct ShardedSimulation::Region {
+    struct Slot {
+        std::atomic<int> state{static_cast<int>(ShardState::Starting)};
+        std::atomic<long> ticks{0};                   ///< Live progress
+        std::atomic<int> vehicles{0};                 ///< Vehicles in the shard
+        std::atomic<int> stationsLowWater{0};         ///< Fewest stations free after one of its acquires
+        SharedStatsSlot stats;                        ///< Per-type stats, live and final
+    };
+    std::atomic<int> stationsAvailable;               ///< Shared station pool
+    Slot slots[kMaxShards];
+
+    explicit Region(int stations) : stationsAvailable(stations) {}
+};
+
+ShardedSimulation::ShardedSimulation(const ShardConfig& cfg) : config(cfg) {
+    if (config.shards < 1) config.shards = 1;
+    if (config.shards > kMaxShards) config.shards = kMaxShards;
+    lastRead.resize(static_cast<size_t>(config.shards));
+
+    // the name is unlinked as soon as it is mapped; workers inherit the mapping across fork()
+    const std::string name = "/vehicle_sim_shards_" + std::to_string(::getpid()) + "_" + std::to_string(regionCounter++);
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) return;
+    void* map = MAP_FAILED;
+    if (::ftruncate(fd, sizeof(Region)) == 0) {
+        map = ::mmap(nullptr, sizeof(Region), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    ::shm_unlink(name.c_str());
+    if (map == MAP_FAILED) return;
+    region = new (map) Region(config.stations);
+}
+
+ShardedSimulation::~ShardedSimulation() {
+    if (region) {
+        region->~Region();
+        ::munmap(region, sizeof(Region));
+    }
+}
+
+int ShardedSimulation::shardFleet(int index) const {
+    return config.fleetSize / config.shards + (index < config.fleetSize % config.shards ? 1 : 0);
+}
+
+bool ShardedSimulation::run() {
+    if (!region) return false;
+    // buffered output would otherwise be written once per process
+    std::cout.flush();
+    std::cerr.flush();
+
+    workers.clear();
+    bool ok = true;
+    for (int i = 0; i < config.shards; ++i) {
+        pid_t pid = ::fork();
+        if (pid == 0) {
+            runShard(i);
+            // skip the coordinator's atexit handlers and static destructors
+            ::_exit(region->slots[i].state.load() == static_cast<int>(ShardState::Done) ? 0 : 1);
+        }
+        if (pid < 0) {
+            region->slots[i].state = static_cast<int>(ShardState::Failed);
+            ok = false;
+            continue;
+        }
+        workers.push_back(pid);
+    }
+
+    for (pid_t pid : workers) {
+        int status = 0;
+        if (::waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) ok = false;
+    }
+    return ok;
+}
+
+void ShardedSimulation::runShard(int index) {
+    auto& slot = region->slots[index];
+    const int vehicles = shardFleet(index);
+    slot.vehicles = vehicles;
+    // a forked worker inherits the coordinator's stats; it records and publishes only its own
+    VehicleStatsManager stats;
+    Simulation sim(config.stations, config.timeSliceMs);
+    sim.setStatsManager(stats);
+    sim.setQuiet(true);
+    sim.setExecutionMode(ExecutionMode::Pipeline);
+    sim.attachSharedStations(&region->stationsAvailable);
+    sim.setDeployment(config.deployment ? config.deployment(vehicles)
+                                        : std::make_unique<VehicleRandomDeployment>(vehicles));
+    slot.state = static_cast<int>(ShardState::Running);
+
+    // live progress for the coordinator, from the simulation's lock-free snapshot
+    std::atomic<bool> finished{false};
+    std::thread monitor([&] {
+        while (!finished.load()) {
+            const SimulationSnapshot snap = sim.snapshot();
+            slot.ticks = snap.simulatedSeconds;
+            slot.stationsLowWater = snap.stationsLowWater;
+            slot.stats.publish(SharedStatsSlot::recordedStats(stats));
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    });
+    sim.runSimulation(config.duration);
+    finished = true;
+    monitor.join();
+
+    const SimulationSnapshot snap = sim.snapshot();
+    slot.ticks = snap.simulatedSeconds;
+    slot.stationsLowWater = snap.stationsLowWater;
+    slot.stats.publish(SharedStatsSlot::recordedStats(stats));
+    slot.state = static_cast<int>(ShardState::Done);
+}
+
+std::map<std::string, VehicleStatsSnapshot> ShardedSimulation::mergedStats() const {
+    std::map<std::string, VehicleStatsSnapshot> merged;
+    if (!region) return merged;
+    for (int s = 0; s < config.shards; ++s) {
+        for (const auto& [type, snap] : shardStats(s)) mergeSnapshot(merged[type], snap);
+    }
+    return merged;
+}
+
+std::map<std::string, VehicleStatsSnapshot> ShardedSimulation::shardStats(int index) const {
+    if (!region || index < 0 || index >= config.shards) return {};
+    std::lock_guard<std::mutex> lock(readMtx);
+    auto& last = lastRead[static_cast<size_t>(index)];
+    // a worker killed mid-publish leaves its slot torn: keep what was read before
+    region->slots[index].stats.read(last);
+    return last;
+}
+
+ShardedSimulation::ShardStatus ShardedSimulation::shardStatus(int index) const {
+    ShardStatus status;
+    if (!region || index < 0 || index >= config.shards) return status;
+    const auto& slot = region->slots[index];
+    status.state = static_cast<ShardState>(slot.state.load());
+    status.simulatedSeconds = slot.ticks.load();
+    status.vehicles = slot.vehicles.load();
+    status.stationsLowWater = slot.stationsLowWater.load();
+    return status;
+}
+
+int ShardedSimulation::stationsAvailable() const {
+    return region ? region->stationsAvailable.load(std::memory_order_relaxed) : 0;
+}
+
+void ShardedSimulation::printResults(std::ostream& os) const {
+    static const char* stateNames[] = {"starting", "running", "done", "failed"};
+    os << "\n=== Sharded Simulation End (" << config.shards << " shards) ===\n";
+    for (int i = 0; i < config.shards; ++i) {
+        const ShardStatus status = shardStatus(i);
+        os << "Shard " << i << ": " << status.vehicles << " vehicles, " << status.simulatedSeconds
+           << " ticks, " << stateNames[static_cast<int>(status.state)] << "\n";
+    }
+    for (const auto& [type, snap] : mergedStats()) {
+        os << type << " → averageTime: " << snap.averageTime << " s"
+           << " totalTestVehicle: " << snap.totalTestVehicle
+           << " totalChargedVehicle: " << snap.totalChargedVehicle
+           << " averageDistance: " << snap.averageDistance << " miles"
+           << " averageChargeTime: " << snap.averageChargeTime << " s"
+           << " runTimeStdDev: " << snap.runTime.stddev() << " s"
+           << " chargeTimeStdDev: " << snap.chargeTime.stddev() << " s"
+           << " totalFaults: " << snap.totalFaults
+           << " totalPassengersMiles: " << snap.totalPassengersMiles << " miles\n";
+    }
+}
@@ -0,0 +1,80 @@
+#include "SharedStatsSlot.h"
+#include <cstring>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "Tracing.h"
+#include "VehicleStatsManager.h"
+
+// slots are used from several processes, which is only sound for address-free atomics
+static_assert(std::atomic<double>::is_always_lock_free, "shared stats must be lock-free");
+static_assert(std::atomic<unsigned>::is_always_lock_free, "shared seqlock must be lock-free");
+
+double& SharedStatsSlot::valueAt(VehicleStatsSnapshot& snap, size_t i) {
+    if (i < kTotalCount) return snap.*kTotals[i];
+    i -= kTotalCount;
+    return snap.*kSummaries[i / kSummaryFieldCount].*kSummaryFields[i % kSummaryFieldCount];
+}
+
+std::map<std::string, VehicleStatsSnapshot> SharedStatsSlot::recordedStats(const VehicleStatsManager& manager) {
+    auto now = manager.snapshotAll();
+    for (auto it = now.begin(); it != now.end(); ) {
+        bool touched = false;
+        for (auto field : kTotals) touched |= it->second.*field != 0;
+        it = touched ? std::next(it) : now.erase(it);
+    }
+    return now;
+}
+
+void SharedStatsSlot::publish(const std::map<std::string, VehicleStatsSnapshot>& stats) {
+    TraceSpan span("stats publish", "stats", static_cast<std::int64_t>(stats.size()));
+    seq.fetch_add(1, std::memory_order_acq_rel);
+    int count = typeCount.load(std::memory_order_relaxed);
+    for (const auto& [type, snap] : stats) {
+        int i = 0;
+        while (i < count && type != types[i].name) ++i;
+        if (i == count) {
+            if (count == kMaxTypes) continue;
+            std::strncpy(types[i].name, type.c_str(), kMaxTypeName - 1);
+            types[i].name[kMaxTypeName - 1] = '\0';
+            typeCount.store(++count, std::memory_order_release);
+        }
+        VehicleStatsSnapshot copy = snap;
+        for (size_t f = 0; f < kValueCount; ++f) {
+            types[i].values[f].store(valueAt(copy, f), std::memory_order_relaxed);
+        }
+    }
+    seq.fetch_add(1, std::memory_order_release);
+}
+
+bool SharedStatsSlot::read(std::map<std::string, VehicleStatsSnapshot>& out) const {
+    std::vector<std::pair<std::string, VehicleStatsSnapshot>> copy;
+    unsigned before = 1;
+    for (int attempt = 0; attempt < kReadAttempts; ++attempt) {
+        before = seq.load(std::memory_order_acquire);
+        if (before & 1) {
+            // writer publishing: let it finish
+            std::this_thread::yield();
+            continue;
+        }
+        copy.clear();
+        const int count = typeCount.load(std::memory_order_acquire);
+        for (int i = 0; i < count; ++i) {
+            VehicleStatsSnapshot snap;
+            for (size_t f = 0; f < kValueCount; ++f) {
+                valueAt(snap, f) = types[i].values[f].load(std::memory_order_relaxed);
+            }
+            copy.emplace_back(types[i].name, snap);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (seq.load(std::memory_order_relaxed) == before) break;
+        before = 1;
+    }
+    if (before & 1) return false;
+
+    // merging into an empty snapshot recomputes the averages from the totals
+    std::map<std::string, VehicleStatsSnapshot> result;
+    for (const auto& [type, snap] : copy) mergeSnapshot(result[type], snap);
+    out = std::move(result);
+    return true;
+}
@@ -1,12 +1,34 @@
 #include "Simulation.h"
+#include "SharedStatsSlot.h"
+#include "Tracing.h"
 #include <iostream>
+#include <iomanip>
+#include <new>
+#include <sstream>
 #include <thread>
 #include <chrono>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace std::chrono_literals;
 using namespace std;
 
-VehicleRandomDeployment::VehicleRandomDeployment() {
+namespace {
+// adds the calling thread's CPU time over the timer's scope to a per-stage counter
+class StageCpuTimer {
+public:
+    explicit StageCpuTimer(std::atomic<long long>& total) : total(total), begin(threadCpuTime()) {}
+    ~StageCpuTimer() { total.fetch_add((threadCpuTime() - begin).count(), std::memory_order_relaxed); }
+private:
+    std::atomic<long long>& total;
+    std::chrono::nanoseconds begin;
+};
+}
+
+VehicleRandomDeployment::VehicleRandomDeployment(int fleetSize, unsigned seed)
+    : gen(seed != 0 ? seed : std::random_device{}()), fleetSize(fleetSize) {
     factories.emplace_back(std::make_unique<AlphaFactory>());
     factories.emplace_back(std::make_unique<BravoFactory>());
     factories.emplace_back(std::make_unique<CharlieFactory>());
@@ -18,8 +40,8 @@ VehicleRandomDeployment::VehicleRandomDeployment() {
 std::vector<std::unique_ptr<Vehicle>> VehicleRandomDeployment::deployVehicles() {
     std::uniform_int_distribution<> dis(0, static_cast<int>(factories.size()) - 1);
     std::vector<std::unique_ptr<Vehicle>> result;
-    result.reserve(20);
-    for (int i = 0; i < 20; ++i) {
+    result.reserve(fleetSize);
+    for (int i = 0; i < fleetSize; ++i) {
         result.push_back(factories[dis(gen)]->createVehicle());
     }
     return result;
@@ -30,7 +52,10 @@ Simulation::Simulation(int stations, int timeSliceMs)
     : stationManager(stations),
       deployment(std::make_unique<VehicleRandomDeployment>()),
       msTimeSlice(timeSliceMs)
-{}
+{
+    for (auto& batch : runnerBatches) batch = ScratchBatch(TrackingAllocator<Vehicle*>(MemSubsystem::RunnerScratch));
+    for (auto& group : dispatchByKind) group = ScratchBatch(TrackingAllocator<Vehicle*>(MemSubsystem::DispatchScratch));
+}
 
 // if potential to change another one
 void Simulation::setDeployment(std::unique_ptr<VehicleDeployment> deploy) {
@@ -38,120 +63,803 @@ void Simulation::setDeployment(std::unique_ptr<VehicleDeployment> deploy) {
 }
 
 void Simulation::runSimulation(std::chrono::seconds simulatedDuration) {
-    // Create vehicles via deployment strategy
-    vehicles = deployment->deployVehicles();
+    memAtStart = MemoryTracker::instance().countsAll();
+    TraceRecorder::setThreadName("simulation");
+
+    // Create vehicles via deployment strategy and init run queue; when the runner is pinned this
+    // happens on its CPU so the fleet and run-queue nodes are first-touched on the runner's NUMA node
+    auto deployFleet = [this] {
+        if (mode == ExecutionMode::Threads) pinCurrentThread(placement.runnerCpu);
+        vehicles = deployment->deployVehicles();
+
+        // vehicles from an earlier run are gone; the queues link through the vehicles, so there is nothing to size
+        for (VehicleQueue* q : {&runQueue, &needChargeQueue, &chargeQueue}) {
+            q->clear();
+            q->resetHighWater();
+        }
+        reserveDispatchScratch();
 
-    // init run queue and set vehicle time-slice
-    for (auto& v : vehicles) {
-        v->setTimeSliceMs(msTimeSlice);
-        runQueue.push(v.get());
-        VehicleStatsManager::getInstance().record(v->getType(), *v,StatType::TotalTestVehicle);
+        // init run queue and set vehicle time-slice
+        for (size_t i = 0; i < vehicles.size(); ++i) {
+            auto& v = vehicles[i];
+            v->setId(static_cast<std::uint32_t>(i));
+            v->setTimeSliceMs(msTimeSlice);
+            if (mode != ExecutionMode::Coroutines) runQueue.push(v.get());
+            statsManager().record(v->getType(), *v,StatType::TotalTestVehicle);
+        }
+    };
+    if (mode == ExecutionMode::Threads && placement.runnerCpu >= 0) {
+        std::thread(deployFleet).join();
+    } else {
+        deployFleet();
     }
 
+    // stations still held when an earlier run stopped are free again
+    stationManager.reset();
     stopFlag = false;
+    simulatedSeconds = 0;
+    runStartNs = std::chrono::steady_clock::now().time_since_epoch().count();
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopRequested = false;
+    }
+
+    for (auto& ns : stageCpuNs) ns = 0;
+    stationMetrics.reset(stationManager.getTotal());
+    if (!cycleExportPath.empty()) {
+        cycleExporter = std::make_unique<CycleExporter>(cycleExportPath);
+        if (!cycleExporter->isOpen()) {
+            std::cerr << "Cannot open cycle export file " << cycleExportPath << "\n";
+            cycleExporter.reset();
+        }
+    }
+    runEndTick = static_cast<std::uint64_t>(simulatedDuration.count());
+    pacer.configure(std::chrono::milliseconds(msTimeSlice), overrunPolicy);
+    chargerPacer.configure(std::chrono::milliseconds(msTimeSlice), overrunPolicy);
+    steadyTick = -1;
+    if (mode == ExecutionMode::Coroutines) {
+        runCoroutines(simulatedDuration);
+    } else if (mode == ExecutionMode::Threads) {
+        runThreads(simulatedDuration);
+    } else {
+        runPipeline(simulatedDuration);
+    }
+    if (cycleExporter) {
+        // workers are stopped, so every per-thread buffer can be flushed
+        cycleExporter->close();
+        if (!quiet) std::cout << "Exported " << cycleExporter->rowsWritten() << " cycles to " << cycleExportPath << "\n";
+        cycleExporter.reset();
+    }
+
+    // for the vehicle not complete one running cycle or charging cycle,store the running/charging time.
+    // assume we should still store the data which not fully complete, in the totals only:
+    // a cut-short cycle is no sample of the per-run and per-charge summaries.
+    for (auto& v : vehicles){
+        statsManager().record(v->getType(), *v,StatType::PartialChargeTime);
+        statsManager().record(v->getType(), *v,StatType::PartialTime);
+    }
+    if (quiet) return;
+
+    std::cout << "\n=== Simulation End ===\n";
+    std::cout << "Stage CPU time: runner " << stageCpuMs(Stage::Runner) << " ms, dispatcher "
+              << stageCpuMs(Stage::Dispatcher) << " ms, charger " << stageCpuMs(Stage::Charger) << " ms\n";
+    if (msTimeSlice > 0) printPacingReport(std::cout);
+    std::cout << stationMetrics.report();
+    if (mode == ExecutionMode::Pipeline) {
+        std::cout << "Stage workers: peak " << scaler.peak() << " of budget " << scaler.budget() << ", "
+                  << scaler.changes() << " runner resizes\n";
+    }
+    statsManager().printAll();
+    if (MemoryTracker::instance().isEnabled()) printMemoryReport(std::cout);
+}
 
+void Simulation::runThreads(std::chrono::seconds simulatedDuration) {
     // start three threads
-    runnerThread = std::thread(&Simulation::runnerThreadFunc, this);
-    needChargeThread = std::thread(&Simulation::needChargeDispatcherFunc, this);
-    chargerThread = std::thread(&Simulation::chargerThreadFunc, this);
+    runnerThread = std::thread([this] {
+        TraceRecorder::setThreadName("runner");
+        pinCurrentThread(placement.runnerCpu);
+        runnerThreadFunc();
+    });
+    needChargeThread = std::thread([this] {
+        TraceRecorder::setThreadName("dispatcher");
+        pinCurrentThread(placement.dispatcherCpu);
+        needChargeDispatcherFunc();
+    });
+    chargerThread = std::thread([this] {
+        TraceRecorder::setThreadName("charger");
+        pinCurrentThread(placement.chargerCpu);
+        chargerThreadFunc();
+    });
 
-    // run for simulatedDuration seconds, scaled by msTimeSlice real ms per sim-second
+    // run for simulatedDuration seconds, scaled by msTimeSlice real ms per sim-second,
+    // waking for periodic reports or an early stop request
     auto totalMs = simulatedDuration.count() * msTimeSlice;
-    std::this_thread::sleep_for(std::chrono::milliseconds(totalMs));
+    auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(totalMs);
+    auto reportMs = std::chrono::milliseconds(reportInterval.count() * msTimeSlice);
+    auto nextReport = reportMs.count() > 0 ? std::chrono::steady_clock::now() + reportMs : end;
+    auto steadyAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(totalMs / 2);
+    {
+        std::unique_lock<std::mutex> lock(waitMutex);
+        while (!stopRequested && std::chrono::steady_clock::now() < end) {
+            auto wake = std::min(end, nextReport);
+            if (steadyTick < 0) wake = std::min(wake, steadyAt);
+            waitCv.wait_until(lock, wake, [this] { return stopRequested; });
+            if (steadyTick < 0 && std::chrono::steady_clock::now() >= steadyAt) {
+                markSteadyState();
+            }
+            if (reportMs.count() > 0 && std::chrono::steady_clock::now() >= nextReport) {
+                std::cout << snapshot() << std::flush;
+                nextReport += reportMs;
+            }
+        }
+    }
 
     // request stop
     stopFlag = true;
     // wake all threads blocked in acquire()
     stationManager.stopAll();
-    // wake threads
-    runQueue.notifyAll();
-    needChargeQueue.notifyAll();
-    chargeQueue.notifyAll();
 
     // join threads
     if (runnerThread.joinable()) runnerThread.join();
     if (needChargeThread.joinable()) needChargeThread.join();
     if (chargerThread.joinable()) chargerThread.join();
+}
 
-    std::cout << "\n=== Simulation End ===\n";
-    
-    // for the vehicle not complete one running cycle or charging cycle,store the running/charging time.
-    // assume we should still store the data which not fully complete.
-    for (auto& v : vehicles){
-        VehicleStatsManager::getInstance().record(v->getType(), *v,StatType::TotalChargeTime);
-        VehicleStatsManager::getInstance().record(v->getType(), *v,StatType::TotalTime);
+SimulationSnapshot Simulation::snapshot() const {
+    SimulationSnapshot snap;
+    snap.simulatedSeconds = simulatedSeconds.load(std::memory_order_relaxed);
+    if (long long startNs = runStartNs.load(std::memory_order_relaxed)) {
+        snap.wallSeconds = (std::chrono::steady_clock::now().time_since_epoch().count() - startNs) / 1e9;
+    }
+    snap.stats = statsManager().snapshotAll();
+    // queues are empty in coroutine mode and agent counts are zero in thread mode
+    snap.runQueueDepth = runQueue.approxSize() + agentCount(AgentPhase::Running);
+    snap.needChargeQueueDepth = needChargeQueue.approxSize() + agentCount(AgentPhase::Waiting);
+    snap.chargeQueueDepth = chargeQueue.approxSize() + chargingVehicles.load(std::memory_order_relaxed)
+                          + agentCount(AgentPhase::Charging);
+    snap.runQueueHighWater = runQueue.highWaterMark();
+    snap.needChargeQueueHighWater = needChargeQueue.highWaterMark();
+    snap.chargeQueueHighWater = chargeQueue.highWaterMark();
+    snap.stationsAvailable = stationManager.getAvailable();
+    snap.stationsTotal = stationManager.getTotal();
+    snap.stationsLowWater = stationManager.getLowWater();
+    for (size_t i = 0; i < snap.stageCpuMs.size(); ++i) snap.stageCpuMs[i] = stageCpuMs(static_cast<Stage>(i));
+    snap.pacing = pacer.stats();
+    snap.workersInUse = workersInUse.load(std::memory_order_relaxed);
+    snap.runnerWorkers = runnerWorkers.load(std::memory_order_relaxed);
+    snap.stationReport = stationMetrics.report();
+    return snap;
+}
+
+void Simulation::requestStop() {
+    {
+        std::lock_guard<std::mutex> lock(waitMutex);
+        stopRequested = true;
+    }
+    waitCv.notify_all();
+}
+
+std::ostream& operator<<(std::ostream& os, const SimulationSnapshot& snap) {
+    os << "[t=" << snap.simulatedSeconds << "s]"
+       << " run=" << snap.runQueueDepth
+       << " needCharge=" << snap.needChargeQueueDepth
+       << " charging=" << snap.chargeQueueDepth
+       << " stations=" << (snap.stationsTotal - snap.stationsAvailable) << "/" << snap.stationsTotal << " busy\n";
+    for (const auto& kv : snap.stats) {
+        os << "  " << kv.first
+           << " vehicles: " << kv.second.totalTestVehicle
+           << " charges: " << kv.second.totalChargedVehicle
+           << " averageTime: " << kv.second.averageTime << " s"
+           << " averageChargeTime: " << kv.second.averageChargeTime << " s\n";
+    }
+    return os;
+}
+
+void Simulation::runCoroutines(std::chrono::seconds simulatedDuration) {
+    SimExecutor exec;
+    StationAwaitable stations(stationManager, exec);
+
+    // one suspended coroutine per vehicle; slots must not move once agents hold references
+    agents.clear();
+    agents.reserve(vehicles.size());
+    for (auto& v : vehicles) agents.emplace_back(v.get());
+    for (auto& slot : agents) {
+        slot.task = vehicleAgent(slot, exec, stations);
+        exec.post(slot.task.get());
+    }
+    exec.drain();
+
+    pacer.start();
+    const std::uint64_t endTick = static_cast<std::uint64_t>(simulatedDuration.count());
+    while (exec.now() < endTick) {
+        {
+            StageCpuTimer timer(stageCpuNs[static_cast<size_t>(Stage::Runner)]);
+            TraceSpan span("tick", "stage", static_cast<std::int64_t>(exec.now()));
+            exec.tick();
+        }
+        if (!finishTick(exec.now())) break;
+    }
+
+    // stopped mid-phase: credit partial running/charging time so the final stats include it
+    const std::uint64_t now = exec.now();
+    for (auto& slot : agents) {
+        if (slot.phase == AgentPhase::Running) slot.vehicle->runFor(static_cast<double>(now - slot.phaseStart));
+        if (slot.phase == AgentPhase::Charging) slot.vehicle->chargeFor(static_cast<double>(now - slot.phaseStart));
+        enterPhase(slot, AgentPhase::None, now);
+    }
+    agents.clear();
+}
+
+AgentTask Simulation::vehicleAgent(AgentSlot& slot, SimExecutor& exec, StationAwaitable& stations) {
+    Vehicle& v = *slot.vehicle;
+    for (;;) {
+        // run until the battery is depleted
+        enterPhase(slot, AgentPhase::Running, exec.now());
+        const long driveTicks = v.ticksUntilDepleted();
+        co_await exec.delay(driveTicks);
+        v.runFor(static_cast<double>(driveTicks));
+        onDepleted(v, static_cast<long>(exec.now()));
+
+        // wait for a station
+        enterPhase(slot, AgentPhase::Waiting, exec.now());
+        co_await stations.acquire();
+        onStationAcquired(v, static_cast<long>(exec.now()));
+
+        // charge until full, then hand the station on
+        enterPhase(slot, AgentPhase::Charging, exec.now());
+        const long chargeTicks = v.ticksUntilCharged();
+        co_await exec.delay(chargeTicks);
+        v.chargeFor(static_cast<double>(chargeTicks));
+        stations.release();
+        onCharged(v, static_cast<long>(exec.now()));
+    }
+}
+
+void Simulation::onDepleted(Vehicle& v, long tick) {
+    statsManager().record(v.getType(), v, StatType::TotalTime);
+    auto& stamps = v.cycleStamps();
+    stamps.depleted = tick;
+    stamps.runSeconds = v.getRunningTime();
+    stamps.runMiles = v.getDistance();
+    v.resetRunningTime();
+}
+
+void Simulation::onStationAcquired(Vehicle& v, long tick) {
+    statsManager().record(v.getType(), v, StatType::TotalChargeCycle);
+    v.cycleStamps().acquired = tick;
+    stationMetrics.recordWait(static_cast<std::uint64_t>(tick - v.cycleStamps().depleted));
+}
+
+void Simulation::onStationsAcquired(std::span<Vehicle* const> batch, long tick) {
+    // one pass stamps the batch and groups it by kind; the charge queue keeps FIFO order
+    for (auto& group : dispatchByKind) group.clear();
+    for (Vehicle* v : batch) {
+        v->cycleStamps().acquired = tick;
+        stationMetrics.recordWait(static_cast<std::uint64_t>(tick - v->cycleStamps().depleted));
+        dispatchByKind[static_cast<size_t>(v->getKind())].push_back(v);
+    }
+    // a built-in kind is a single stats type, so its group is one bulk record
+    auto& stats = statsManager();
+    for (size_t k = 0; k < dispatchByKind.size(); ++k) {
+        const auto& group = dispatchByKind[k];
+        if (group.empty()) continue;
+        if (static_cast<VehicleKind>(k) == VehicleKind::Custom) stats.recordBatch(group, StatType::TotalChargeCycle);
+        else stats.recordBatch(group.front()->getType(), group, StatType::TotalChargeCycle);
+    }
+}
+
+void Simulation::onCharged(Vehicle& v, long tick) {
+    statsManager().record(v.getType(), v, StatType::TotalChargeTime);
+    statsManager().record(v.getType(), v, StatType::TotalTestVehicle);
+    auto& stamps = v.cycleStamps();
+    stationMetrics.recordCharge(static_cast<std::uint64_t>(v.getChargingTime()));
+    if (cycleExporter) {
+        CycleRow row;
+        row.vehicleId = v.getId();
+        row.type = v.getType();
+        row.start = stamps.runStart;
+        row.duration = stamps.runSeconds;
+        row.distance = stamps.runMiles;
+        row.chargeWait = stamps.acquired - stamps.depleted;
+        row.chargeTime = v.getChargingTime();
+        cycleExporter->append(row);
+    }
+    stamps.runStart = tick;
+    v.resetChargingTime();
+}
+
+void Simulation::enterPhase(AgentSlot& slot, AgentPhase phase, std::uint64_t tick) {
+    if (slot.phase != AgentPhase::None) {
+        agentPhaseCounts[static_cast<size_t>(slot.phase)].fetch_sub(1, std::memory_order_relaxed);
+    }
+    if (phase != AgentPhase::None) {
+        agentPhaseCounts[static_cast<size_t>(phase)].fetch_add(1, std::memory_order_relaxed);
+    }
+    slot.phase = phase;
+    slot.phaseStart = tick;
+}
+
+// Pipeline mode: per tick, stage work is submitted to the shared pool and the tick ends when all of it has run
+void Simulation::runPipeline(std::chrono::seconds simulatedDuration) {
+    ScalerConfig scalerConfig;
+    scalerConfig.cpuBudget = cpuBudget;
+    if (msTimeSlice > 0) scalerConfig.targetTickMs = msTimeSlice / 2.0;   // leave half the slice as headroom
+    startPipelinePool(scalerConfig);
+    StageSample window;
+    long long windowRunnerNs = stageCpuNs[static_cast<size_t>(Stage::Runner)].load();
+
+    pacer.start();
+    const std::uint64_t endTick = static_cast<std::uint64_t>(simulatedDuration.count());
+    for (std::uint64_t tick = 0; tick < endTick; ) {
+        if (pendingBranches && tick == branchTick) {
+            // this process stops at the branch point; each branch carries on with its own pool and window
+            if (!forkBranches()) break;
+            scalerConfig.cpuBudget = cpuBudget;
+            startPipelinePool(scalerConfig);
+            window = StageSample();
+            windowRunnerNs = stageCpuNs[static_cast<size_t>(Stage::Runner)].load();
+        }
+
+        // one span per tick on the driving thread, from collecting the run queue to the last stage task
+        TraceSpan tickSpan("tick", "stage", static_cast<std::int64_t>(tick));
+
+        // runner stage fans out as chunks of same-kind vehicles, one share per runner worker
+        collectRunnerBatches();
+        size_t running = 0;
+        for (const auto& batch : runnerBatches) running += batch.size();
+        const size_t runners = scaler.current().runner;
+        const size_t chunkSize = std::max<size_t>(1, (running + runners - 1) / runners);
+        runnerChunks.clear();
+        for (size_t k = 0; k < runnerBatches.size(); ++k) {
+            for (size_t first = 0; first < runnerBatches[k].size(); first += chunkSize) {
+                size_t count = std::min(chunkSize, runnerBatches[k].size() - first);
+                runnerChunks.push_back(std::span<Vehicle* const>(runnerBatches[k]).subspan(first, count));
+            }
+        }
+        for (auto& chunk : runnerChunks) {
+            pool->submit([this, &chunk] {
+                StageCpuTimer timer(stageCpuNs[static_cast<size_t>(Stage::Runner)]);
+                TraceSpan span("runner chunk", "stage", static_cast<std::int64_t>(chunk.size()));
+                runChunk(chunk);
+            });
+        }
+        pool->submit([this] {
+            StageCpuTimer timer(stageCpuNs[static_cast<size_t>(Stage::Dispatcher)]);
+            TraceSpan span("dispatch", "stage");
+            dispatchAvailable();
+        });
+        pool->submit([this] {
+            StageCpuTimer timer(stageCpuNs[static_cast<size_t>(Stage::Charger)]);
+            TraceSpan span("charger tick", "stage");
+            chargerTick();
+        });
+        pool->wait();
+
+        // resize the stage workers once per window
+        window.vehiclesRun += running;
+        if (++window.ticks == scalerConfig.windowTicks) {
+            const long long runnerNs = stageCpuNs[static_cast<size_t>(Stage::Runner)].load();
+            window.runnerCpuMs = (runnerNs - windowRunnerNs) / 1e6;
+            window.runDepth = runQueue.approxSize();
+            window.needChargeDepth = needChargeQueue.approxSize();
+            window.chargeDepth = chargeQueue.approxSize() + chargingVehicles.load(std::memory_order_relaxed);
+            applyAllocation(scaler.update(window));
+            window = StageSample();
+            windowRunnerNs = runnerNs;
+        }
+
+        ++tick;
+        if (!finishTick(tick)) break;
+    }
+    drainChargeWheel();
+}
+
+void Simulation::startPipelinePool(const ScalerConfig& scalerConfig) {
+    scaler = AdaptiveScaler(scalerConfig);
+    // the driving thread runs tasks in wait(), so it is one of the budgeted workers
+    const size_t poolThreads = std::max<size_t>(1, scaler.budget() - 1);
+    if (!pool || pool->size() != poolThreads) pool = std::make_unique<WorkerPool>(poolThreads);
+    applyAllocation(scaler.current());
+}
+
+void Simulation::applyAllocation(const WorkerAllocation& alloc) {
+    pool->setActiveWorkers(alloc.total() - 1);
+    runnerWorkers.store(alloc.runner, std::memory_order_relaxed);
+    workersInUse.store(alloc.total(), std::memory_order_relaxed);
+}
+
+void Simulation::sampleStations() {
+    // queues are empty in coroutine mode and agent counts are zero otherwise
+    stationMetrics.sampleTick(stationManager.getTotal() - stationManager.getAvailable(),
+                              needChargeQueue.approxSize() + agentCount(AgentPhase::Waiting));
+}
+
+bool Simulation::finishTick(std::uint64_t tick) {
+    simulatedSeconds.store(static_cast<long>(tick), std::memory_order_relaxed);
+    sampleStations();
+    if (tick == runEndTick / 2) markSteadyState();
+    const std::uint64_t reportEvery = static_cast<std::uint64_t>(reportInterval.count());
+    if (reportEvery > 0 && tick % reportEvery == 0) {
+        std::cout << snapshot() << std::flush;
+    }
+    pacer.waitNext();
+    std::lock_guard<std::mutex> lock(waitMutex);
+    return !stopRequested;
+}
+
+void Simulation::printPacingReport(std::ostream& os) const {
+    const PacingStats p = pacer.stats();
+    os << "Tick lateness (" << overrunPolicyName(overrunPolicy) << "): p50 " << p.p50LatenessMs
+       << " ms, p99 " << p.p99LatenessMs << " ms, max " << p.maxLatenessMs << " ms; overruns "
+       << p.overruns << " of " << p.ticks << " ticks";
+    if (p.skippedTicks > 0) os << ", " << p.skippedTicks << " deadlines skipped";
+    if (p.driftMs > 0) os << ", schedule " << p.driftMs << " ms behind";
+    os << "\n";
+}
+
+void Simulation::markSteadyState() {
+    memAtSteady = MemoryTracker::instance().countsAll();
+    steadyTick = simulatedSeconds.load(std::memory_order_relaxed);
+}
+
+void Simulation::printMemoryReport(std::ostream& os) const {
+    const MemCounts now = MemoryTracker::instance().countsAll();
+    const long ticks = std::max(1L, simulatedSeconds.load(std::memory_order_relaxed));
+    const long steadyTicks = steadyTick < 0 ? 0 : ticks - steadyTick;
+
+    os << "=== Memory by subsystem (" << ticks << " ticks) ===\n";
+    for (size_t i = 0; i < now.size(); ++i) {
+        if (static_cast<MemSubsystem>(i) == MemSubsystem::Test) continue;
+        const long long runAllocs = now[i].allocations - memAtStart[i].allocations;
+        os << MemoryTracker::name(static_cast<MemSubsystem>(i))
+           << ": live " << now[i].liveBytes << " B"
+           << ", peak " << now[i].peakBytes << " B"
+           << ", allocations " << runAllocs
+           << " (" << static_cast<double>(runAllocs) / ticks << "/tick";
+        if (steadyTicks > 0) {
+            os << ", steady " << static_cast<double>(now[i].allocations - memAtSteady[i].allocations) / steadyTicks << "/tick";
+        }
+        os << ")\n";
+    }
+}
+
+long long Simulation::steadyStateAllocations(MemSubsystem sub) const {
+    if (steadyTick < 0) return 0;
+    return MemoryTracker::instance().counts(sub).allocations - memAtSteady[static_cast<size_t>(sub)].allocations;
+}
+
+void Simulation::collectRunnerBatches() {
+    // drain this second's vehicles into per-kind batches
+    for (auto& batch : runnerBatches) batch.clear();
+    runQueue.drain([this](Vehicle* v) {
+        runnerBatches[static_cast<size_t>(v->getKind())].push_back(v);
+    });
+}
+
+void Simulation::runChunk(std::span<Vehicle* const> chunk) {
+    if (chunk.empty()) return;
+    // one compile-time kernel call per type-homogeneous chunk
+    dispatchKind(chunk.front()->getKind(), [&](auto kind) {
+        TickKernel<decltype(kind)::value>::runBatch(chunk);
+    });
+
+    for (Vehicle* v : chunk) {
+        if (v->needsCharge()) {
+            onDepleted(*v, currentTick());
+            needChargeQueue.push(v);
+        } else {
+            // requeue for next second
+            runQueue.push(v);
+        }
     }
-    VehicleStatsManager::getInstance().printAll();
+}
+
+void Simulation::dispatchAvailable() {
+    const size_t waiting = needChargeQueue.approxSize();
+    if (waiting == 0) return;
+    dispatchBatch(stationManager.tryAcquireUpTo(static_cast<int>(waiting)));
+}
+
+void Simulation::dispatchBatch(int stations) {
+    if (stations <= 0) return;
+    // this stage is the only consumer, so at least the depth it saw is still queued;
+    // give back any station that ends up unused (e.g., the queue was cleared)
+    dispatchScratch.clear();
+    const size_t got = needChargeQueue.tryPopBatch(dispatchScratch, static_cast<size_t>(stations));
+    stationManager.release(stations - static_cast<int>(got));
+    if (got == 0) return;
+    onStationsAcquired(dispatchScratch, currentTick());
+    chargeQueue.pushBatch(dispatchScratch);
+}
+
+void Simulation::chargerTick() {
+    // vehicles that just acquired a station: completion tick is known now
+    const std::uint64_t now = chargeWheel.currentTick();
+    while (Vehicle* v = chargeQueue.tryPop()) {
+        chargeWheel.schedule(now + v->ticksUntilCharged(), ChargeTimer{v, now});
+    }
+
+    // one simulated second of charging
+    chargeWheel.advance([this](ChargeTimer& t) {
+        Vehicle* v = t.vehicle;
+        v->chargeFor(static_cast<double>(chargeWheel.currentTick() - t.startTick));
+        // release station
+        stationManager.release();
+        // recorder charge time and increase test Vehicle cycle per tyoe, then push back to run queue
+        onCharged(*v, currentTick());
+        runQueue.push(v);
+    });
+    chargingVehicles.store(chargeWheel.size(), std::memory_order_relaxed);
+}
+
+void Simulation::drainChargeWheel() {
+    // stopped mid-charge: credit partial charging time so the final stats include it,
+    // and hand the stations back in case the pool is shared with other shards
+    const std::uint64_t now = chargeWheel.currentTick();
+    chargeWheel.forEach([this, now](ChargeTimer& t) {
+        t.vehicle->chargeFor(static_cast<double>(now - t.startTick));
+        stationManager.release();
+    });
+    chargeWheel.clear();
+    while (chargeQueue.tryPop()) stationManager.release();
+    chargingVehicles.store(0, std::memory_order_relaxed);
 }
 
 // Runner thread: run the vechicle in the queue and 1) requeue in runner or needCharge
 void Simulation::runnerThreadFunc() {
+    pacer.start();
     while (!stopFlag) {
-    	int size = runQueue.size();
-    	for (int i=0;i<size;i++){
-    	    if(stopFlag) break;
-    	    auto opt = runQueue.tryPop();
-
-            if (!opt) continue;
-            Vehicle* v =  *opt;
-            v->run();
-
-            if (v->needsCharge()) {
-                VehicleStatsManager::getInstance().record(v->getType(), *v,StatType::TotalTime);
-                v->resetRunningTime();
-                needChargeQueue.push(v);
-            } else {
-                // requeue for next second
-                runQueue.push(v);
-            }
+        {
+            StageCpuTimer timer(stageCpuNs[static_cast<size_t>(Stage::Runner)]);
+            TraceSpan span("runner tick", "stage", currentTick());
+            collectRunnerBatches();
+            for (auto& batch : runnerBatches) runChunk(batch);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(msTimeSlice));
+        simulatedSeconds.fetch_add(1, std::memory_order_relaxed);
+        sampleStations();
+        pacer.waitNext();
     }
 }
 
 // needCharge thread: check whether station is available and enqueue charge queue if any.
 void Simulation::needChargeDispatcherFunc() {
     while (!stopFlag) {
-        auto opt = needChargeQueue.tryPop();
+        const size_t waiting = needChargeQueue.approxSize();
 
-        if (!opt) {
+        if (waiting == 0) {
             std::this_thread::sleep_for(std::chrono::milliseconds(msTimeSlice));
             continue;
         }
-        Vehicle* v  = *opt;
-        // blocks until a station is available
-        stationManager.acquire(this->stopFlag);
-        // now vehicle holds a station; recored total charge cycle per type and push to chargingQueue for charger thread to process
-        if(stopFlag) break;
-        VehicleStatsManager::getInstance().record(v->getType(), *v,StatType::TotalChargeCycle);
-        chargeQueue.push(v);
+        // blocks until a station is available, then takes one per waiting vehicle if it can;
+        // vehicles stay queued meanwhile so snapshots still count them as waiting
+        const int stations = stationManager.acquireUpTo(static_cast<int>(waiting), this->stopFlag);
+        if (stopFlag) {
+            stationManager.release(stations);
+            break;
+        }
+        // now the batch holds stations; record total charge cycles per type and push to chargeQueue for the charger thread
+        StageCpuTimer timer(stageCpuNs[static_cast<size_t>(Stage::Dispatcher)]);
+        TraceSpan span("dispatch", "stage", stations);
+        dispatchBatch(stations);
     }
 }
 
-// Charger thread: charge the vehicle and requeue, or push to runner if charge is complete
+// Charger thread: schedule each newly charging vehicle's completion once, then expire only the due timers each tick
 void Simulation::chargerThreadFunc() {
+    chargerPacer.start();
     while (!stopFlag) {
-    	int size = chargeQueue.size();
-    	for (int i=0;i<size;i++){
-    	   if(stopFlag) break;
-           auto opt = chargeQueue.tryPop();
-            if (!opt) continue;
-            
-            Vehicle* v = *opt;
-            v->charge();
-            
-            if(v->isFullyCharged()){
-                // release station
-                stationManager.release();
-                // recorder charge time and increase test Vehicle cycle per tyoe, then push back to run queue
-                VehicleStatsManager::getInstance().record(v->getType(), *v,StatType::TotalChargeTime);
-                VehicleStatsManager::getInstance().record(v->getType(), *v,StatType::TotalTestVehicle);
-                v->resetChargingTime();
-                runQueue.push(v);
-            } else {
-                chargeQueue.push(v);
+        {
+            StageCpuTimer timer(stageCpuNs[static_cast<size_t>(Stage::Charger)]);
+            TraceSpan span("charger tick", "stage");
+            chargerTick();
+        }
+        chargerPacer.waitNext();
+    }
+    drainChargeWheel();
+}
+
+// Result slot of one branch, in an anonymous MAP_SHARED mapping created before the fork.
+// The branch fills it before exiting; the parent reads it after waitpid(), which orders the two.
+struct Simulation::BranchSlot {
+    bool done = false;                  ///< Written last by the branch
+    long ticks = 0;                     ///< Ticks the branch completed
+    int stations = 0;                   ///< Stations at the end of the branch
+    size_t vehicles = 0;                ///< Fleet size at the end of the branch
+    StationReport stationReport;        ///< Plain data, copied as is
+    SharedStatsSlot stats;              ///< Per-type stats
+};
+
+bool BranchSpec::parse(const std::string& text, BranchSpec& out) {
+    BranchSpec spec;
+    spec.name = text.empty() ? "baseline" : text;
+    std::istringstream in(text);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        if (item.empty()) continue;
+        try {
+            if (item.rfind("stations=", 0) == 0) {
+                spec.stations = std::stoi(item.substr(9));
+                if (spec.stations < 0) return false;
+                continue;
             }
+            const size_t plus = item.find('+');
+            if (plus == std::string::npos) return false;
+            const std::string type = item.substr(0, plus);
+            const int count = std::stoi(item.substr(plus + 1));
+            if (count < 0) return false;
+            bool known = false;
+            for (size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+                if (type == vehicleSpecs[k].type) {
+                    spec.addVehicles[k] += count;
+                    known = true;
+                }
+            }
+            if (!known) return false;
+        } catch (...) {
+            return false;
+        }
+    }
+    out = spec;
+    return true;
+}
+
+std::vector<BranchResult> Simulation::runBranches(std::chrono::seconds branchAt, std::chrono::seconds duration,
+                                                  const std::vector<BranchSpec>& branches) {
+    std::vector<BranchResult> results(branches.size());
+    for (size_t i = 0; i < branches.size(); ++i) results[i].name = branches[i].name;
+    if (branches.empty() || duration.count() <= 0) return results;
+
+    const size_t bytes = sizeof(BranchSlot) * branches.size();
+    void* map = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (map == MAP_FAILED) return results;
+    branchSlots = static_cast<BranchSlot*>(map);
+    for (size_t i = 0; i < branches.size(); ++i) new (&branchSlots[i]) BranchSlot();
+
+    // the prefix runs with these settings, and every branch inherits them
+    const ExecutionMode savedMode = mode;
+    const bool savedQuiet = quiet;
+    const std::string savedExport = cycleExportPath;
+    mode = ExecutionMode::Pipeline;
+    quiet = true;
+    cycleExportPath.clear();
+    pendingBranches = &branches;
+    // a branch needs at least one tick of its own
+    branchTick = static_cast<std::uint64_t>(std::clamp<long long>(branchAt.count(), 0, duration.count() - 1));
+
+    runSimulation(duration);
+
+    if (branchIndex >= 0) {
+        BranchSlot& slot = branchSlots[branchIndex];
+        slot.ticks = currentTick();
+        slot.stations = stationManager.getTotal();
+        slot.vehicles = vehicles.size();
+        slot.stationReport = stationMetrics.report();
+        slot.stats.publish(SharedStatsSlot::recordedStats(statsManager()));
+        slot.done = true;
+        std::cout.flush();
+        // skip the parent's atexit handlers and static destructors
+        ::_exit(0);
+    }
+
+    pendingBranches = nullptr;
+    mode = savedMode;
+    quiet = savedQuiet;
+    cycleExportPath = savedExport;
+    for (size_t i = 0; i < branches.size(); ++i) {
+        const BranchSlot& slot = branchSlots[i];
+        BranchResult& r = results[i];
+        r.ok = slot.done;
+        r.stations = slot.stations;
+        r.vehicles = slot.vehicles;
+        // a branch that died may have stopped mid-publish, leaving its slot torn or locked
+        if (slot.done) {
+            r.simulatedSeconds = slot.ticks;
+            r.stationReport = slot.stationReport;
+            r.ok = slot.stats.read(r.stats);
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(msTimeSlice));
+        branchSlots[i].~BranchSlot();
     }
+    ::munmap(map, bytes);
+    branchSlots = nullptr;
+    return results;
+}
+
+bool Simulation::forkBranches() {
+    const std::vector<BranchSpec>& branches = *pendingBranches;
+    pendingBranches = nullptr;
+    // fork() copies only the calling thread, so join the idle stage workers first; the tick is
+    // complete, so the fleet, queues, timers and stats are consistent and no lock is held
+    pool.reset();
+    // buffered output would otherwise be written once per process
+    std::cout.flush();
+    std::cerr.flush();
+
+    const size_t budget = std::max<size_t>(1, scaler.budget() / branches.size());
+    std::vector<pid_t> children(branches.size(), -1);
+    for (size_t i = 0; i < branches.size(); ++i) {
+        const pid_t pid = ::fork();
+        if (pid == 0) {
+            branchIndex = static_cast<int>(i);
+            cpuBudget = budget;
+            applyBranch(branches[i]);
+            return true;
+        }
+        children[i] = pid;
+    }
+    for (size_t i = 0; i < children.size(); ++i) {
+        if (children[i] < 0) continue;
+        int status = 0;
+        if (::waitpid(children[i], &status, 0) != children[i] || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            branchSlots[i].done = false;
+        }
+    }
+    return false;
+}
+
+void Simulation::applyBranch(const BranchSpec& spec) {
+    if (spec.stations >= 0) {
+        stationManager.setTotal(spec.stations);
+        stationMetrics.setStations(spec.stations);
+    }
+    const long tick = currentTick();
+    for (size_t k = 0; k < kBuiltinVehicleKinds; ++k) {
+        for (int n = 0; n < spec.addVehicles[k]; ++n) {
+            auto v = std::make_unique<Vehicle>(vehicleSpecs[k], static_cast<VehicleKind>(k));
+            v->setId(static_cast<std::uint32_t>(vehicles.size()));
+            v->setTimeSliceMs(msTimeSlice);
+            v->cycleStamps().runStart = tick;
+            statsManager().record(v->getType(), *v, StatType::TotalTestVehicle);
+            runQueue.push(v.get());
+            vehicles.push_back(std::move(v));
+        }
+    }
+    reserveDispatchScratch();
+}
+
+void Simulation::reserveDispatchScratch() {
+    // a dispatch takes at most one vehicle per station, so neither batch grows once the fleet is deployed
+    const size_t perDispatch = std::min(vehicles.size(), static_cast<size_t>(std::max(stationManager.getTotal(), 0)));
+    dispatchScratch.reserve(perDispatch);
+    for (auto& group : dispatchByKind) group.reserve(perDispatch);
+}
+
+void printBranchResults(std::ostream& os, const std::vector<BranchResult>& results) {
+    constexpr int labelWidth = 28;
+    constexpr int columnWidth = 16;
+    auto row = [&](const std::string& label, auto&& cell) {
+        os << std::left << std::setw(labelWidth) << label << std::right;
+        for (const auto& r : results) {
+            std::ostringstream text;
+            if (r.ok) cell(text, r);
+            else text << "-";
+            os << std::setw(columnWidth) << text.str();
+        }
+        os << "\n";
+    };
+    auto sum = [](const BranchResult& r, double VehicleStatsSnapshot::* field) {
+        double total = 0;
+        for (const auto& kv : r.stats) total += kv.second.*field;
+        return total;
+    };
+
+    os << "\n=== What-if branches ===\n";
+    os << std::left << std::setw(labelWidth) << "" << std::right;
+    for (const auto& r : results) os << std::setw(columnWidth) << r.name.substr(0, columnWidth - 1);
+    os << "\n";
+    os << std::left << std::setw(labelWidth) << "status" << std::right;
+    for (const auto& r : results) os << std::setw(columnWidth) << (r.ok ? "done" : "failed");
+    os << "\n";
+    row("ticks", [](std::ostream& o, const BranchResult& r) { o << r.simulatedSeconds; });
+    row("stations", [](std::ostream& o, const BranchResult& r) { o << r.stations; });
+    row("vehicles", [](std::ostream& o, const BranchResult& r) { o << r.vehicles; });
+    row("runs", [&](std::ostream& o, const BranchResult& r) { o << sum(r, &VehicleStatsSnapshot::totalTestVehicle); });
+    row("charges", [](std::ostream& o, const BranchResult& r) { o << r.stationReport.charges; });
+    row("charges/station-hour", [](std::ostream& o, const BranchResult& r) { o << std::fixed << std::setprecision(2) << r.stationReport.chargesPerStationHour; });
+    row("station utilization %", [](std::ostream& o, const BranchResult& r) { o << std::fixed << std::setprecision(1) << r.stationReport.utilizationPct; });
+    row("idle while queued %", [](std::ostream& o, const BranchResult& r) { o << std::fixed << std::setprecision(1) << r.stationReport.idleWhileQueuedPct; });
+    row("mean wait s", [](std::ostream& o, const BranchResult& r) { o << std::fixed << std::setprecision(1) << r.stationReport.meanWaitSeconds; });
+    row("p99 wait s", [](std::ostream& o, const BranchResult& r) { o << r.stationReport.p99WaitSeconds; });
+    row("distance miles", [&](std::ostream& o, const BranchResult& r) { o << std::fixed << std::setprecision(0) << sum(r, &VehicleStatsSnapshot::totalDistance); });
+    row("passenger miles", [&](std::ostream& o, const BranchResult& r) { o << std::fixed << std::setprecision(0) << sum(r, &VehicleStatsSnapshot::totalPassengersMiles); });
+    row("faults", [&](std::ostream& o, const BranchResult& r) { o << std::fixed << std::setprecision(1) << sum(r, &VehicleStatsSnapshot::totalFaults); });
 }
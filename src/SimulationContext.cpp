@@ -0,0 +1,36 @@
+#include "SimulationContext.h"
+
+SimulationContext::SimulationContext(const SimulationConfig& config)
+    : settings(config), sim(config.stations, config.timeSliceMs) {
+    sim.setStatsManager(statsManager);
+    sim.setQuiet(true);
+}
+
+void SimulationContext::apply() {
+    sim.setStations(settings.stations);
+    sim.setTimeSliceMs(settings.timeSliceMs);
+    sim.setExecutionMode(settings.mode);
+    sim.setCpuBudget(settings.cpuBudget);
+    sim.setOverrunPolicy(settings.overrun);
+    sim.setDeployment(settings.deployment ? settings.deployment(settings)
+                                          : std::make_unique<VehicleRandomDeployment>(settings.fleetSize, settings.seed));
+}
+
+const SimulationResult& SimulationContext::run() {
+    reset();
+    apply();
+    sim.runSimulation(settings.duration);
+
+    SimulationSnapshot snap = sim.snapshot();
+    last.simulatedSeconds = snap.simulatedSeconds;
+    last.wallSeconds = snap.wallSeconds;
+    last.stats = std::move(snap.stats);
+    last.stationReport = snap.stationReport;
+    last.stageCpuMs = snap.stageCpuMs;
+    return last;
+}
+
+void SimulationContext::reset() {
+    statsManager.resetAll();
+    last = SimulationResult();
+}
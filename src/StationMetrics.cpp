@@ -0,0 +1,56 @@
+#include "StationMetrics.h"
+#include <ostream>
+
+void StationMetrics::reset(int count) {
+    stations.store(count, std::memory_order_relaxed);
+    waitHistogram.clear();
+    for (auto* counter : {&waitTicks, &charges, &chargeTicks, &ticks, &stationTicks, &busyTicks, &idleQueuedTicks}) {
+        counter->store(0, std::memory_order_relaxed);
+    }
+}
+
+void StationMetrics::sampleTick(int busy, size_t waiting, std::uint64_t repeat) {
+    const int stations = this->stations.load(std::memory_order_relaxed);
+    ticks.fetch_add(repeat, std::memory_order_relaxed);
+    stationTicks.fetch_add(static_cast<std::uint64_t>(stations > 0 ? stations : 0) * repeat, std::memory_order_relaxed);
+    busyTicks.fetch_add(static_cast<std::uint64_t>(busy > 0 ? busy : 0) * repeat, std::memory_order_relaxed);
+    // a station left free while someone waits is dispatch lag, not spare capacity
+    if (busy < stations && waiting > 0) idleQueuedTicks.fetch_add(repeat, std::memory_order_relaxed);
+}
+
+StationReport StationMetrics::report() const {
+    StationReport r;
+    r.stations = stations.load(std::memory_order_relaxed);
+    r.ticks = ticks.load(std::memory_order_relaxed);
+    r.charges = charges.load(std::memory_order_relaxed);
+    r.waits = waitHistogram.count();
+    // station-ticks rather than ticks times stations, so a mid-run change of station count is weighted by its duration
+    const double available = static_cast<double>(stationTicks.load(std::memory_order_relaxed));
+    if (r.ticks > 0) {
+        r.idleWhileQueuedPct = 100.0 * static_cast<double>(idleQueuedTicks.load(std::memory_order_relaxed)) / static_cast<double>(r.ticks);
+    }
+    if (available > 0) {
+        r.utilizationPct = 100.0 * static_cast<double>(busyTicks.load(std::memory_order_relaxed)) / available;
+        r.chargesPerStationHour = static_cast<double>(r.charges) * 3600.0 / available;
+    }
+    if (r.charges > 0) r.meanChargeSeconds = static_cast<double>(chargeTicks.load(std::memory_order_relaxed)) / static_cast<double>(r.charges);
+    if (r.waits > 0) {
+        r.meanWaitSeconds = static_cast<double>(waitTicks.load(std::memory_order_relaxed)) / static_cast<double>(r.waits);
+        r.p50WaitSeconds = waitHistogram.percentile(0.50);
+        r.p90WaitSeconds = waitHistogram.percentile(0.90);
+        r.p99WaitSeconds = waitHistogram.percentile(0.99);
+        r.maxWaitSeconds = waitHistogram.max();
+    }
+    return r;
+}
+
+std::ostream& operator<<(std::ostream& os, const StationReport& r) {
+    os << "Stations: " << r.stations << ", utilization " << r.utilizationPct << "%, idle with vehicles waiting "
+       << r.idleWhileQueuedPct << "% of " << r.ticks << " ticks\n"
+       << "  charges: " << r.charges << " (" << r.chargesPerStationHour << " per station-hour, mean "
+       << r.meanChargeSeconds << " s each)\n"
+       << "  wait for a station: mean " << r.meanWaitSeconds << " s, p50 " << r.p50WaitSeconds << " s, p90 "
+       << r.p90WaitSeconds << " s, p99 " << r.p99WaitSeconds << " s, max " << r.maxWaitSeconds << " s ("
+       << r.waits << " acquired)\n";
+    return os;
+}
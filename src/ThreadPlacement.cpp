@@ -0,0 +1,58 @@
+#include "ThreadPlacement.h"
+#include <sstream>
+#include <string>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#include <cstring>
+#endif
+
+StagePlacement StagePlacement::parse(const std::string& spec) {
+    StagePlacement placement;
+    int* fields[] = {&placement.runnerCpu, &placement.dispatcherCpu, &placement.chargerCpu};
+    std::istringstream in(spec);
+    std::string token;
+    for (int* field : fields) {
+        if (!std::getline(in, token, ',')) break;
+        try { *field = std::stoi(token); }
+        catch (...) { *field = -1; }
+    }
+    return placement;
+}
+
+bool pinCurrentThread(int cpu) {
+    if (cpu < 0) return false;
+#ifdef __linux__
+    if (cpu >= CPU_SETSIZE) return false;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+int numaNodeOfCpu(int cpu) {
+    if (cpu < 0) return -1;
+#ifdef __linux__
+    // sysfs exposes the node as a "nodeN" link inside the cpu directory
+    std::string path = "/sys/devices/system/cpu/cpu" + std::to_string(cpu);
+    DIR* dir = opendir(path.c_str());
+    if (!dir) return -1;
+    int node = -1;
+    while (dirent* entry = readdir(dir)) {
+        if (std::strncmp(entry->d_name, "node", 4) == 0) {
+            try { node = std::stoi(entry->d_name + 4); }
+            catch (...) { node = -1; }
+            break;
+        }
+    }
+    closedir(dir);
+    return node;
+#else
+    return -1;
+#endif
+}
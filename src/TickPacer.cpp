@@ -0,0 +1,126 @@
+#include "TickPacer.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <thread>
+
+const char* overrunPolicyName(OverrunPolicy policy) {
+    switch (policy) {
+        case OverrunPolicy::Skip:     return "skip";
+        case OverrunPolicy::SlowDown: return "slowdown";
+        default:                      return "catchup";
+    }
+}
+
+OverrunPolicy parseOverrunPolicy(const char* name) {
+    if (std::strcmp(name, "skip") == 0) return OverrunPolicy::Skip;
+    if (std::strcmp(name, "slowdown") == 0) return OverrunPolicy::SlowDown;
+    return OverrunPolicy::CatchUp;
+}
+
+// ------------------------------------------
+// LatencyHistogram
+// ------------------------------------------
+std::size_t LatencyHistogram::bucketOf(std::uint64_t us) {
+    if (us < kSubBuckets) return static_cast<std::size_t>(us);
+    const int exp = std::bit_width(us) - 1;   // >= 4
+    const std::size_t sub = static_cast<std::size_t>(us >> (exp - 4)) & (kSubBuckets - 1);
+    return kSubBuckets + static_cast<std::size_t>(exp - 4) * kSubBuckets + sub;
+}
+
+std::uint64_t LatencyHistogram::upperBound(std::size_t bucket) {
+    if (bucket < kSubBuckets) return bucket;
+    const int exp = static_cast<int>((bucket - kSubBuckets) / kSubBuckets) + 4;
+    const std::uint64_t sub = (bucket - kSubBuckets) % kSubBuckets;
+    const std::uint64_t width = std::uint64_t{1} << (exp - 4);
+    return ((kSubBuckets + sub) << (exp - 4)) + (width - 1);
+}
+
+void LatencyHistogram::record(std::uint64_t us, std::uint64_t count) {
+    if (count == 0) return;
+    buckets[bucketOf(us)].fetch_add(count, std::memory_order_relaxed);
+    total.fetch_add(count, std::memory_order_relaxed);
+    if (us > largest.load(std::memory_order_relaxed)) largest.store(us, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::percentile(double q) const {
+    const std::uint64_t n = count();
+    if (n == 0) return 0;
+    const std::uint64_t target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * static_cast<double>(n))));
+    std::uint64_t seen = 0;
+    for (std::size_t b = 0; b < kBuckets; ++b) {
+        seen += buckets[b].load(std::memory_order_relaxed);
+        if (seen >= target) return std::min(upperBound(b), max());
+    }
+    return max();
+}
+
+void LatencyHistogram::clear() {
+    for (auto& b : buckets) b.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    largest.store(0, std::memory_order_relaxed);
+}
+
+// ------------------------------------------
+// TickPacer
+// ------------------------------------------
+TickPacer::TickPacer(std::chrono::microseconds period, OverrunPolicy policy)
+    : period(period), overrunPolicy(policy) {}
+
+void TickPacer::configure(std::chrono::microseconds newPeriod, OverrunPolicy policy) {
+    period = newPeriod;
+    overrunPolicy = policy;
+}
+
+void TickPacer::start() {
+    origin = Clock::now();
+    shift = Clock::duration::zero();
+    tick = 0;
+    lateness.clear();
+    overruns.store(0, std::memory_order_relaxed);
+    skipped.store(0, std::memory_order_relaxed);
+    shiftUs.store(0, std::memory_order_relaxed);
+}
+
+void TickPacer::waitNext() {
+    if (period.count() <= 0) return;
+    ++tick;
+    const Clock::time_point deadline = origin + shift + period * static_cast<std::int64_t>(tick);
+    Clock::time_point now = Clock::now();
+
+    if (now < deadline) {
+        std::this_thread::sleep_until(deadline);
+        now = Clock::now();
+    } else {
+        overruns.fetch_add(1, std::memory_order_relaxed);
+        const Clock::duration late = now - deadline;
+        if (overrunPolicy == OverrunPolicy::Skip) {
+            // drop every deadline already passed and wait for the next one in the grid's phase;
+            // the caller still runs one tick, so the schedule falls behind by whole periods
+            const std::int64_t missed = late / period + 1;
+            skipped.fetch_add(static_cast<std::uint64_t>(missed), std::memory_order_relaxed);
+            shift += period * missed;
+            std::this_thread::sleep_until(deadline + period * missed);
+        } else if (overrunPolicy == OverrunPolicy::SlowDown) {
+            // the next tick gets a whole period from now
+            shift += late;
+        }
+        shiftUs.store(std::chrono::duration_cast<std::chrono::microseconds>(shift).count(), std::memory_order_relaxed);
+    }
+
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(now - deadline).count();
+    lateness.record(us > 0 ? static_cast<std::uint64_t>(us) : 0);
+}
+
+PacingStats TickPacer::stats() const {
+    PacingStats s;
+    s.ticks = lateness.count();
+    s.overruns = overruns.load(std::memory_order_relaxed);
+    s.skippedTicks = skipped.load(std::memory_order_relaxed);
+    s.driftMs = shiftUs.load(std::memory_order_relaxed) / 1000.0;
+    s.p50LatenessMs = lateness.percentile(0.50) / 1000.0;
+    s.p99LatenessMs = lateness.percentile(0.99) / 1000.0;
+    s.maxLatenessMs = lateness.max() / 1000.0;
+    return s;
+}
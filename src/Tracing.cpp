@@ -0,0 +1,190 @@
+#include "Tracing.h"
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+
+namespace {
+// the calling thread's ring and the name given before it existed
+thread_local void* localRingPtr = nullptr;
+thread_local const char* pendingName = nullptr;
+
+void writeJsonString(std::ostream& os, const char* text) {
+    os << '"';
+    for (const char* c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') os << '\\';
+        os << *c;
+    }
+    os << '"';
+}
+
+// the format counts microseconds; keep nanosecond precision as three decimals
+void writeMicros(std::ostream& os, std::int64_t ns) {
+    os << ns / 1000 << '.' << std::setw(3) << std::setfill('0') << ns % 1000 << std::setfill(' ');
+}
+
+void separate(std::ostream& os, bool& first) {
+    if (!first) os << ",";
+    first = false;
+    os << "\n";
+}
+}
+
+thread_local TraceRecorder::RingReturn TraceRecorder::ringReturn;
+
+TraceRecorder::RingReturn::~RingReturn() {
+    if (!ring) return;
+    TraceRecorder& recorder = instance();
+    std::lock_guard<std::mutex> lock(recorder.mtx);
+    ring->free = true;
+}
+
+TraceRecorder& TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+void TraceRecorder::enable(std::size_t events) {
+    ringEvents.store(std::bit_ceil(events < 2 ? std::size_t{2} : events), std::memory_order_relaxed);
+    on.store(true, std::memory_order_relaxed);
+}
+
+std::int64_t TraceRecorder::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceRecorder::ThreadRing& TraceRecorder::localRing() {
+    if (localRingPtr) return *static_cast<ThreadRing*>(localRingPtr);
+    const std::size_t capacity = ringEvents.load(std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(mtx);
+    // a free ring sized by an earlier enable() is left for a thread that asks for that size
+    auto found = std::find_if(rings.begin(), rings.end(),
+                              [capacity](const auto& r) { return r->free && r->events.size() == capacity; });
+    ThreadRing* ring;
+    if (found != rings.end()) {
+        ring = found->get();
+        const std::uint64_t head = ring->head.load(std::memory_order_relaxed);
+        if (ring->from < head) ring->past.push_back(PastTrack{ring->from, ring->tid, ring->name.load(std::memory_order_relaxed)});
+        // forget owners whose events have all been overwritten
+        const std::uint64_t kept = head > capacity ? head - capacity : 0;
+        std::size_t gone = 0;
+        while (gone < ring->past.size() && (gone + 1 < ring->past.size() ? ring->past[gone + 1].from : head) <= kept) ++gone;
+        ring->past.erase(ring->past.begin(), ring->past.begin() + static_cast<std::ptrdiff_t>(gone));
+        ring->from = head;
+        ring->free = false;
+    } else {
+        rings.push_back(std::make_unique<ThreadRing>(capacity));
+        ring = rings.back().get();
+    }
+    ring->tid = nextTid++;
+    ring->name.store(pendingName, std::memory_order_relaxed);
+    localRingPtr = ring;
+    ringReturn.ring = ring;
+    return *ring;
+}
+
+void TraceRecorder::record(const char* name, const char* category, std::int64_t startNs, std::int64_t endNs,
+                           std::int64_t arg) {
+    ThreadRing& ring = localRing();
+    // single writer: publish the slot after filling it
+    const std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+    ring.events[head & (ring.events.size() - 1)] = TraceEvent{name, category, startNs, endNs - startNs, arg};
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void TraceRecorder::setThreadName(const char* name) {
+    pendingName = name;
+    if (localRingPtr) static_cast<ThreadRing*>(localRingPtr)->name.store(name, std::memory_order_relaxed);
+}
+
+void TraceRecorder::writeTrack(std::ostream& os, bool& first, const ThreadRing& ring, std::uint64_t from,
+                               std::uint64_t to, int tid, const char* name) const {
+    const int pid = static_cast<int>(::getpid());
+    separate(os, first);
+    os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << pid << ",\"tid\":" << tid << ",\"args\":{\"name\":";
+    if (name) writeJsonString(os, name);
+    else os << "\"thread " << tid << "\"";
+    os << "}}";
+
+    const std::uint64_t capacity = ring.events.size();
+    for (std::uint64_t i = from; i < to; ++i) {
+        const TraceEvent& e = ring.events[i & (capacity - 1)];
+        separate(os, first);
+        // complete ("X") events: start and duration in one record
+        os << "{\"name\":";
+        writeJsonString(os, e.name);
+        os << ",\"cat\":";
+        writeJsonString(os, e.category);
+        os << ",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":" << tid
+           << ",\"ts\":";
+        writeMicros(os, e.startNs);
+        os << ",\"dur\":";
+        writeMicros(os, e.durationNs);
+        if (e.arg >= 0) os << ",\"args\":{\"n\":" << e.arg << "}";
+        os << "}";
+    }
+}
+
+void TraceRecorder::writeChromeJson(std::ostream& os) const {
+    std::lock_guard<std::mutex> lock(mtx);
+    os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    for (const auto& ring : rings) {
+        const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        const std::uint64_t capacity = ring->events.size();
+        const std::uint64_t kept = head > capacity ? head - capacity : 0;
+        // earlier owners first, each up to where the next one took over
+        for (std::size_t t = 0; t < ring->past.size(); ++t) {
+            const PastTrack& track = ring->past[t];
+            const std::uint64_t end = t + 1 < ring->past.size() ? ring->past[t + 1].from : ring->from;
+            if (end > kept) writeTrack(os, first, *ring, std::max(track.from, kept), end, track.tid, track.name);
+        }
+        writeTrack(os, first, *ring, std::max(ring->from, kept), head, ring->tid,
+                   ring->name.load(std::memory_order_relaxed));
+    }
+    os << "\n]}\n";
+}
+
+bool TraceRecorder::writeChromeJson(const std::string& path) const {
+    std::ofstream out(path);
+    if (!out) return false;
+    writeChromeJson(out);
+    return static_cast<bool>(out);
+}
+
+std::size_t TraceRecorder::eventCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::size_t total = 0;
+    for (const auto& ring : rings) {
+        const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        total += static_cast<std::size_t>(head < ring->events.size() ? head : ring->events.size());
+    }
+    return total;
+}
+
+std::size_t TraceRecorder::droppedCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    std::size_t total = 0;
+    for (const auto& ring : rings) {
+        const std::uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head > ring->events.size()) total += static_cast<std::size_t>(head - ring->events.size());
+    }
+    return total;
+}
+
+std::size_t TraceRecorder::ringCount() const {
+    std::lock_guard<std::mutex> lock(mtx);
+    return rings.size();
+}
+
+void TraceRecorder::clear() {
+    std::lock_guard<std::mutex> lock(mtx);
+    for (auto& ring : rings) {
+        ring->head.store(0, std::memory_order_relaxed);
+        ring->from = 0;
+        ring->past.clear();
+    }
+}
@@ -1,6 +1,7 @@
 #include "Vehicle.h"
 #include "VehicleStatsManager.h"
 #include "VehicleStatsData.h"
+#include "MemoryTracking.h"
 #include <algorithm>
 #include <cmath>
 using namespace std;
@@ -15,32 +16,40 @@ Vehicle::Vehicle(const std::string& type, int speed, int capacity, double timeHo
       passengers(passenger),
       faultPerHour(fault),
       batteryRatio(1.0),
+      load(passenger),
       timeSliceMs(100)
 {
-    // registerStats be called by concrete vehicle constructors
+    // precompute per-tick thresholds once so run()/charge() do no math
+    const VehicleSpec spec{nullptr, speed, capacity, timeHours, energy, passenger, fault};
+    driveThreshold = spec.driveSeconds();
+    chargeThreshold = spec.chargeSeconds();
 }
 
-void Vehicle::registerStats() {
-    auto& vs = VehicleStatsManager::getInstance();
-    vs.setStatData(getType(), std::make_unique<VehicleStatsData>());
+Vehicle::Vehicle(const VehicleSpec& spec, VehicleKind k)
+    : Vehicle(spec.type, spec.cruiseSpeed, spec.batteryCapacity, spec.timeToCharge,
+              spec.energyUse, spec.passengers, spec.faultPerHour)
+{
+    kind = k;
+    energy = &energyTableFor(kind, load);
 }
 
-void Vehicle::run() {
-    double driveSec = 3600.0 * (this->getBatteryCapacity()/this->getEnergyUse() ) / this->getCruiseSpeed();
-    runningTime++;
-    if (runningTime >= driveSec) this->batteryRatio = 0.0;
+void Vehicle::setLoad(int passengersAboard) {
+    load = passengersAboard;
+    if (kind != VehicleKind::Custom) energy = &energyTableFor(kind, load);
 }
 
-void Vehicle::charge() {
-    double timeToChargeSec = std::max(1.0, getTimeToCharge() * 3600.0);
-    chargingTime++;
-    if (chargingTime >= timeToChargeSec) this->batteryRatio = 1.0;
+void* Vehicle::operator new(std::size_t size) {
+    void* p = ::operator new(size);
+    MemoryTracker::instance().onAlloc(MemSubsystem::Vehicles, size);
+    return p;
 }
 
-bool Vehicle::needsCharge() const {
-    return batteryRatio <= 0.0;
+void Vehicle::operator delete(void* p, std::size_t size) {
+    MemoryTracker::instance().onFree(MemSubsystem::Vehicles, size);
+    ::operator delete(p);
 }
 
-bool Vehicle::isFullyCharged() const {
-    return batteryRatio >= 1.0;
+void Vehicle::registerStats() {
+    auto& vs = VehicleStatsManager::getInstance();
+    vs.setStatData(getType(), std::make_unique<VehicleStatsData>());
 }
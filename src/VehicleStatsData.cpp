@@ -1,35 +1,91 @@
 #include "VehicleStatsData.h"
 #include "Vehicle.h"
-#include <iostream>
+#include "MemoryTracking.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
 
+void* VehicleStatsData::operator new(std::size_t size) {
+    void* p = ::operator new(size);
+    MemoryTracker::instance().onAlloc(MemSubsystem::StatsMap, size);
+    return p;
+}
+
+void VehicleStatsData::operator delete(void* p, std::size_t size) {
+    MemoryTracker::instance().onFree(MemSubsystem::StatsMap, size);
+    ::operator delete(p);
+}
+
 void VehicleStatsData::record(const Vehicle& v,StatType type) {
     std::lock_guard<std::mutex> lock(statsMutex);
+    beginWrite();
+    apply(v, type);
+    endWrite();
+}
+
+void VehicleStatsData::recordBatch(std::span<Vehicle* const> vehicles, StatType type) {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    beginWrite();
+    if (type == StatType::TotalChargeCycle || type == StatType::TotalTestVehicle) {
+        // pure counters: one update for the whole batch
+        add(type == StatType::TotalChargeCycle ? totalChargedVehicle : totalTestVehicle,
+            static_cast<double>(vehicles.size()));
+    } else {
+        for (const Vehicle* v : vehicles) apply(*v, type);
+    }
+    endWrite();
+}
+
+// passenger-miles of one record: loads differ between vehicles of a type, so each record counts its own
+static double passengerMiles(const Vehicle& v) {
+    return v.getCruiseEquivalentTime() * v.getLoad() * v.getCruiseSpeed() / 3600;
+}
+
+void VehicleStatsData::recordWeighted(const Vehicle& v, StatType type, std::uint64_t count) {
+    if (count == 0) return;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    beginWrite();
+    applyWeighted(v, type, static_cast<double>(count));
+    endWrite();
+}
+
+void VehicleStatsData::applyWeighted(const Vehicle& v, StatType type, double count) {
     switch (type) {
         case StatType::TotalTestVehicle:
-            totalTestVehicle++;
-            averageTime = totalTestVehicle!=0?totalTime / totalTestVehicle:0;
+            add(totalTestVehicle, count);
             break;
 
         case StatType::TotalTime:
-            totalTime += v.getRunningTime();
-            averageTime = totalTestVehicle!=0?totalTime / totalTestVehicle:0;
-            totalDistance=totalTime*v.getCruiseSpeed()/3600;
-            averageDistance = totalDistance/totalTestVehicle;
-            totalFaults=totalTime*v.getFaultPerHour()/3600;
-            totalPassengersMiles=totalTime*v.getPassengers()*v.getCruiseSpeed()/3600;
+            add(totalTime, v.getRunningTime() * count);
+            add(totalCruiseTime, v.getCruiseEquivalentTime() * count);
+            add(totalPassengerMiles, passengerMiles(v) * count);
+            runTime.addRepeated(v.getRunningTime(), count);
+            runDistance.addRepeated(v.getDistance(), count);
+            // derived metrics use the type's parameters, captured here and applied on read
+            cruiseSpeed.store(v.getCruiseSpeed(), std::memory_order_relaxed);
+            faultPerHour.store(v.getFaultPerHour(), std::memory_order_relaxed);
             break;
 
         case StatType::TotalChargeCycle:
-            totalChargedVehicle++;;
-	    averageChargeTime = totalChargedVehicle!=0?totalChargeTime / totalChargedVehicle:0;
+            add(totalChargedVehicle, count);
             break;
 
         case StatType::TotalChargeTime:
-	    totalChargeTime += v.getChargingTime();
-	    averageChargeTime = totalChargedVehicle!=0?totalChargeTime / totalChargedVehicle:0;	 
+            add(totalChargeTime, v.getChargingTime() * count);
+            chargeTime.addRepeated(v.getChargingTime(), count);
+            break;
+
+        case StatType::PartialTime:
+            // not a completed run: it counts toward the totals but is no sample of the run summaries
+            add(totalTime, v.getRunningTime() * count);
+            add(totalCruiseTime, v.getCruiseEquivalentTime() * count);
+            add(totalPassengerMiles, passengerMiles(v) * count);
+            cruiseSpeed.store(v.getCruiseSpeed(), std::memory_order_relaxed);
+            faultPerHour.store(v.getFaultPerHour(), std::memory_order_relaxed);
+            break;
+
+        case StatType::PartialChargeTime:
+            add(totalChargeTime, v.getChargingTime() * count);
             break;
 
         default:
@@ -37,21 +93,139 @@ void VehicleStatsData::record(const Vehicle& v,StatType type) {
     }
 }
 
-void VehicleStatsData::log(const std::string& type) const {
+void VehicleStatsData::apply(const Vehicle& v, StatType type) {
+    applyWeighted(v, type, 1);
+}
+
+void VehicleStatsData::merge(const BaseStats& other) {
+    const auto* from = dynamic_cast<const VehicleStatsData*>(&other);
+    if (!from) {
+        std::cerr << "VehicleStatsData::merge: other stats are a different collector; ignored\n";
+        return;
+    }
+    if (from == this) return;
+    const Accumulators add = from->read();
+
     std::lock_guard<std::mutex> lock(statsMutex);
+    Accumulators sum = read();
+    sum.totalTime += add.totalTime;
+    sum.totalCruiseTime += add.totalCruiseTime;
+    sum.totalTestVehicle += add.totalTestVehicle;
+    sum.totalChargedVehicle += add.totalChargedVehicle;
+    sum.totalChargeTime += add.totalChargeTime;
+    sum.totalPassengerMiles += add.totalPassengerMiles;
+    sum.runTime.merge(add.runTime);
+    sum.runDistance.merge(add.runDistance);
+    sum.chargeTime.merge(add.chargeTime);
+    // type parameters are the same for both; take them from whichever side has recorded a run
+    if (sum.cruiseSpeed == 0) {
+        sum.cruiseSpeed = add.cruiseSpeed;
+        sum.faultPerHour = add.faultPerHour;
+    }
+    beginWrite();
+    write(sum);
+    endWrite();
+}
 
-    // Format the log line
-    std::ostringstream oss;
+void VehicleStatsData::reset() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    beginWrite();
+    write(Accumulators{});
+    endWrite();
+}
+
+VehicleStatsData::Accumulators VehicleStatsData::read() const {
+    Accumulators a;
+    unsigned before;
+    do {
+        before = seq.load(std::memory_order_acquire);
+        if (before & 1) continue;   // writer active, retry
+        a.totalTime = totalTime.load(std::memory_order_relaxed);
+        a.totalCruiseTime = totalCruiseTime.load(std::memory_order_relaxed);
+        a.totalTestVehicle = totalTestVehicle.load(std::memory_order_relaxed);
+        a.totalChargedVehicle = totalChargedVehicle.load(std::memory_order_relaxed);
+        a.totalChargeTime = totalChargeTime.load(std::memory_order_relaxed);
+        a.totalPassengerMiles = totalPassengerMiles.load(std::memory_order_relaxed);
+        a.runTime = runTime.load();
+        a.runDistance = runDistance.load();
+        a.chargeTime = chargeTime.load();
+        a.cruiseSpeed = cruiseSpeed.load(std::memory_order_relaxed);
+        a.faultPerHour = faultPerHour.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((before & 1) || seq.load(std::memory_order_relaxed) != before);
+    return a;
+}
+
+void VehicleStatsData::write(const Accumulators& a) {
+    totalTime.store(a.totalTime, std::memory_order_relaxed);
+    totalCruiseTime.store(a.totalCruiseTime, std::memory_order_relaxed);
+    totalTestVehicle.store(a.totalTestVehicle, std::memory_order_relaxed);
+    totalChargedVehicle.store(a.totalChargedVehicle, std::memory_order_relaxed);
+    totalChargeTime.store(a.totalChargeTime, std::memory_order_relaxed);
+    totalPassengerMiles.store(a.totalPassengerMiles, std::memory_order_relaxed);
+    runTime.store(a.runTime);
+    runDistance.store(a.runDistance);
+    chargeTime.store(a.chargeTime);
+    cruiseSpeed.store(a.cruiseSpeed, std::memory_order_relaxed);
+    faultPerHour.store(a.faultPerHour, std::memory_order_relaxed);
+}
+
+VehicleStatsSnapshot VehicleStatsData::snapshot() const {
+    const Accumulators a = read();
+    VehicleStatsSnapshot snap;
+    snap.totalTime = a.totalTime;
+    snap.totalTestVehicle = a.totalTestVehicle;
+    snap.totalChargedVehicle = a.totalChargedVehicle;
+    snap.totalChargeTime = a.totalChargeTime;
+    snap.runTime = a.runTime;
+    snap.runDistance = a.runDistance;
+    snap.chargeTime = a.chargeTime;
+
+    snap.averageTime = snap.totalTestVehicle != 0 ? snap.totalTime / snap.totalTestVehicle : 0;
+    snap.totalDistance = a.totalCruiseTime * a.cruiseSpeed / 3600;
+    snap.averageDistance = snap.totalTestVehicle != 0 ? snap.totalDistance / snap.totalTestVehicle : 0;
+    snap.averageChargeTime = snap.totalChargedVehicle != 0 ? snap.totalChargeTime / snap.totalChargedVehicle : 0;
+    snap.totalFaults = snap.totalTime * a.faultPerHour / 3600;
+    snap.totalPassengersMiles = a.totalPassengerMiles;
+    return snap;
+}
+
+void mergeSnapshot(VehicleStatsSnapshot& into, const VehicleStatsSnapshot& from) {
+    into.totalTime += from.totalTime;
+    into.totalTestVehicle += from.totalTestVehicle;
+    into.totalDistance += from.totalDistance;
+    into.totalChargedVehicle += from.totalChargedVehicle;
+    into.totalChargeTime += from.totalChargeTime;
+    into.totalFaults += from.totalFaults;
+    into.totalPassengersMiles += from.totalPassengersMiles;
+    into.runTime.merge(from.runTime);
+    into.runDistance.merge(from.runDistance);
+    into.chargeTime.merge(from.chargeTime);
+
+    into.averageTime = into.totalTestVehicle != 0 ? into.totalTime / into.totalTestVehicle : 0;
+    into.averageDistance = into.totalTestVehicle != 0 ? into.totalDistance / into.totalTestVehicle : 0;
+    into.averageChargeTime = into.totalChargedVehicle != 0 ? into.totalChargeTime / into.totalChargedVehicle : 0;
+}
+
+void VehicleStatsData::log(const std::string& type) const {
+    const VehicleStatsSnapshot snap = snapshot();
+
+    // Format the log line; stream and string memory is attributed to log formatting
+    using LogString = std::basic_string<char, std::char_traits<char>, TrackingAllocator<char>>;
+    std::basic_ostringstream<char, std::char_traits<char>, TrackingAllocator<char>> oss(
+        LogString(TrackingAllocator<char>(MemSubsystem::LogFormatting)));
     oss << type
-        << " → averageTime: " << averageTime << " s"
-        << " totalTestVehicle: " << totalTestVehicle
-        << " totalChargedVehicle: " << totalChargedVehicle
-        << " averageDistance: " << averageDistance << " miles"
-        << " averageChargeTime: " << averageChargeTime << " s"
-        << " totalFaults: " << totalFaults
-        << " totalPassengersMiles: " << totalPassengersMiles <<" miles";
-
-    std::string line = oss.str();
+        << " → averageTime: " << snap.averageTime << " s"
+        << " totalTestVehicle: " << snap.totalTestVehicle
+        << " totalChargedVehicle: " << snap.totalChargedVehicle
+        << " averageDistance: " << snap.averageDistance << " miles"
+        << " averageChargeTime: " << snap.averageChargeTime << " s"
+        << " runTimeStdDev: " << snap.runTime.stddev() << " s"
+        << " chargeTimeStdDev: " << snap.chargeTime.stddev() << " s"
+        << " totalFaults: " << snap.totalFaults
+        << " totalPassengersMiles: " << snap.totalPassengersMiles <<" miles";
+
+    LogString line = oss.str();
 
     // console print ----
     std::cout << line << std::endl;
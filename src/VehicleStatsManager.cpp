@@ -1,5 +1,7 @@
 #include "VehicleStatsManager.h"
 #include "VehicleStatsData.h"
+#include "Vehicle.h"
+#include "Tracing.h"
 
 VehicleStatsManager& VehicleStatsManager::getInstance() {
     static VehicleStatsManager instance;
@@ -11,20 +13,83 @@ void VehicleStatsManager::record(const std::string& type, const Vehicle& v,StatT
     // check first if the type already is in the map, assume stat data will be same for one type.
     if (statsMap.find(type) == statsMap.end()) {
         statsMap[type] = std::make_unique<VehicleStatsData>();
+        publishRegistry();
     }
     statsMap[type]->record(v,statType);
 }
 
+void VehicleStatsManager::recordBatch(std::span<Vehicle* const> vehicles, StatType statType) {
+    TraceSpan span("stats batch", "stats", static_cast<std::int64_t>(vehicles.size()));
+    std::lock_guard<std::mutex> lock(statsMutex);
+    size_t first = 0;
+    while (first < vehicles.size()) {
+        const std::string& type = vehicles[first]->getType();
+        size_t last = first + 1;
+        while (last < vehicles.size() && vehicles[last]->getType() == type) ++last;
+        statsFor(type).recordBatch(vehicles.subspan(first, last - first), statType);
+        first = last;
+    }
+}
+
+void VehicleStatsManager::recordBatch(const std::string& type, std::span<Vehicle* const> vehicles, StatType statType) {
+    if (vehicles.empty()) return;
+    TraceSpan span("stats batch", "stats", static_cast<std::int64_t>(vehicles.size()));
+    std::lock_guard<std::mutex> lock(statsMutex);
+    statsFor(type).recordBatch(vehicles, statType);
+}
+
+void VehicleStatsManager::recordWeighted(const std::string& type, const Vehicle& v, StatType statType,
+                                         std::uint64_t count) {
+    if (count == 0) return;
+    std::lock_guard<std::mutex> lock(statsMutex);
+    statsFor(type).recordWeighted(v, statType, count);
+}
+
+BaseStats& VehicleStatsManager::statsFor(const std::string& type) {
+    auto it = statsMap.find(type);
+    if (it == statsMap.end()) {
+        it = statsMap.emplace(type, std::make_unique<VehicleStatsData>()).first;
+        publishRegistry();
+    }
+    return *it->second;
+}
+
 void VehicleStatsManager::setStatData(const std::string& type, std::unique_ptr<BaseStats> stats) {
     std::lock_guard<std::mutex> lock(statsMutex);
     if (statsMap.find(type) == statsMap.end()) {
         statsMap[type] = std::move(stats);
+        publishRegistry();
     }
 }
 
 void VehicleStatsManager::printAll() {
+    TraceSpan span("stats print", "stats");
     std::lock_guard<std::mutex> lock(statsMutex);
     for (const auto& kv : statsMap) {
         kv.second->log(kv.first);
     }
 }
+
+void VehicleStatsManager::resetAll() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    for (auto& kv : statsMap) kv.second->reset();
+}
+
+void VehicleStatsManager::publishRegistry() {
+    // entries are never erased, so the raw pointers stay valid for any reader
+    auto next = std::make_shared<StatsRegistry>();
+    next->reserve(statsMap.size());
+    for (const auto& kv : statsMap) {
+        next->emplace_back(kv.first, kv.second.get());
+    }
+    std::atomic_store(&registry, std::shared_ptr<const StatsRegistry>(std::move(next)));
+}
+
+std::map<std::string, VehicleStatsSnapshot> VehicleStatsManager::snapshotAll() const {
+    std::map<std::string, VehicleStatsSnapshot> result;
+    const auto current = std::atomic_load(&registry);
+    for (const auto& entry : *current) {
+        result[entry.first] = entry.second->snapshot();
+    }
+    return result;
+}
@@ -0,0 +1,105 @@
+#include "WorkerPool.h"
+#include "Tracing.h"
+#include <algorithm>
+#include <ctime>
+
+WorkerPool::WorkerPool(size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    active = threads;
+    activeMirror.store(threads, std::memory_order_relaxed);
+    workers.reserve(threads);
+    for (size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        stopping = true;
+    }
+    taskCv.notify_all();
+    parkCv.notify_all();
+    for (auto& t : workers) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void WorkerPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        tasks.push_back(std::move(task));
+        ++unfinished;
+    }
+    taskCv.notify_one();
+}
+
+void WorkerPool::setActiveWorkers(size_t count) {
+    count = std::min(count, workers.size());
+    bool grew;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        if (count == active) return;
+        grew = count > active;
+        active = count;
+        activeMirror.store(count, std::memory_order_relaxed);
+    }
+    // growing wakes parked workers; shrinking makes idle ones re-check and park
+    if (grew) parkCv.notify_all();
+    else taskCv.notify_all();
+}
+
+void WorkerPool::wait() {
+    std::unique_lock<std::mutex> lock(mtx);
+    while (unfinished > 0) {
+        if (tasks.empty()) {
+            doneCv.wait(lock, [this] { return unfinished == 0 || !tasks.empty(); });
+            continue;
+        }
+        // help out instead of idling
+        auto task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        runTask(task);
+        lock.lock();
+    }
+}
+
+void WorkerPool::workerLoop(size_t index) {
+    TraceRecorder::setThreadName("pool worker");
+    std::unique_lock<std::mutex> lock(mtx);
+    for (;;) {
+        if (!stopping && index >= active) {
+            parkCv.wait(lock, [this, index] { return stopping || index < active; });
+            continue;
+        }
+        taskCv.wait(lock, [this, index] { return stopping || !tasks.empty() || index >= active; });
+        if (!stopping && index >= active) continue;
+        if (tasks.empty()) return;   // stopping and drained
+        auto task = std::move(tasks.front());
+        tasks.pop_front();
+        lock.unlock();
+        runTask(task);
+        lock.lock();
+    }
+}
+
+void WorkerPool::runTask(std::function<void()>& task) {
+    task();
+    bool last;
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        last = --unfinished == 0;
+    }
+    if (last) doneCv.notify_all();
+}
+
+std::chrono::nanoseconds threadCpuTime() {
+#ifdef CLOCK_THREAD_CPUTIME_ID
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) == 0) {
+        return std::chrono::seconds(ts.tv_sec) + std::chrono::nanoseconds(ts.tv_nsec);
+    }
+#endif
+    return std::chrono::nanoseconds(0);
+}
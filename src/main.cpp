@@ -1,5 +1,14 @@
 #include "Simulation.h"
+#include "MetricsServer.h"
+#include "ShardedSimulation.h"
+#include "OutOfCoreFleet.h"
+#include "Tracing.h"
+#include "ParameterSweep.h"
+#include "CohortSimulation.h"
 #include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
 
 int main(int argc, char* argv[]) {
     // default simulated seconds
@@ -8,23 +17,230 @@ int main(int argc, char* argv[]) {
     int stations = 3;
     // real ms per simulated second for test
     int timeSliceMs = 10;
+    // live summary period in simulated seconds, 0 = off
+    int reportEverySec = 0;
+    // loopback Prometheus endpoint port, 0 = off
+    int metricsPort = 0;
+    // per-stage CPU pinning, unpinned by default
+    StagePlacement placement;
+    // vehicles in the fleet (split across shards when sharded)
+    int fleetSize = 20;
+    // worker processes sharing one station pool, 1 = single process
+    int shards = 1;
+    // per-cycle columnar export file, empty = off
+    std::string exportPath;
+    // memory-mapped fleet file for an out-of-core run, empty = in memory
+    std::string outOfCorePath;
+    // simulate identical vehicles as weighted cohorts instead of one by one
+    bool cohorts = false;
+    // most cores a pipeline run may use, 0 = all
+    int cpuBudget = 0;
+    // what the real-time clock does when a tick overruns its deadline
+    OverrunPolicy overrun = OverrunPolicy::CatchUp;
+    // dedicated stage threads (default), shared-pool pipeline or coroutine agents
+    ExecutionMode mode = ExecutionMode::Threads;
+    // Chrome trace-event timeline written at exit, empty = tracing off
+    std::string tracePath;
+    // simulated second at which what-if branches fork, and the branches themselves
+    int branchAtSec = 0;
+    std::vector<BranchSpec> branches;
+    // parameter grid of a sweep, its result cache (empty = in memory) and worker threads (0 = all cores)
+    std::string sweepSpec;
+    std::string sweepCachePath = "sweep_cache.tsv";
+    int sweepJobs = 0;
 
-    if (argc > 1) {
-        try { durationSec = std::stoi(argv[1]); }
+    // "--name value" options may appear anywhere; everything else is positional
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--report-every" && i + 1 < argc) {
+            try { reportEverySec = std::stoi(argv[++i]); }
+            catch (...) { reportEverySec = 0; }
+        } else if (arg == "--mode" && i + 1 < argc) {
+            std::string value = argv[++i];
+            if (value == "coroutine") mode = ExecutionMode::Coroutines;
+            else if (value == "pipeline") mode = ExecutionMode::Pipeline;
+            else mode = ExecutionMode::Threads;
+        } else if (arg == "--metrics-port" && i + 1 < argc) {
+            try { metricsPort = std::stoi(argv[++i]); }
+            catch (...) { metricsPort = 0; }
+        } else if (arg == "--fleet" && i + 1 < argc) {
+            try { fleetSize = std::stoi(argv[++i]); }
+            catch (...) { fleetSize = 20; }
+        } else if (arg == "--shards" && i + 1 < argc) {
+            try { shards = std::stoi(argv[++i]); }
+            catch (...) { shards = 1; }
+        } else if (arg == "--export-cycles" && i + 1 < argc) {
+            exportPath = argv[++i];
+        } else if (arg == "--out-of-core" && i + 1 < argc) {
+            outOfCorePath = argv[++i];
+        } else if (arg == "--cohorts") {
+            cohorts = true;
+        } else if (arg == "--cpu-budget" && i + 1 < argc) {
+            try { cpuBudget = std::stoi(argv[++i]); }
+            catch (...) { cpuBudget = 0; }
+        } else if (arg == "--overrun" && i + 1 < argc) {
+            overrun = parseOverrunPolicy(argv[++i]);
+        } else if (arg == "--branch-at" && i + 1 < argc) {
+            try { branchAtSec = std::stoi(argv[++i]); }
+            catch (...) { branchAtSec = 0; }
+        } else if (arg == "--branch" && i + 1 < argc) {
+            BranchSpec spec;
+            if (BranchSpec::parse(argv[++i], spec)) branches.push_back(spec);
+            else std::cout << "Ignoring malformed branch '" << argv[i] << "'\n";
+        } else if (arg == "--sweep" && i + 1 < argc) {
+            sweepSpec = argv[++i];
+        } else if (arg == "--sweep-cache" && i + 1 < argc) {
+            sweepCachePath = argv[++i];
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            try { sweepJobs = std::stoi(argv[++i]); }
+            catch (...) { sweepJobs = 0; }
+        } else if (arg == "--trace" && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (arg == "--track-memory") {
+            MemoryTracker::instance().enable();
+        } else if (arg == "--pin" && i + 1 < argc) {
+            placement = StagePlacement::parse(argv[++i]);
+        } else {
+            positional.push_back(arg);
+        }
+    }
+
+    if (positional.size() > 0) {
+        try { durationSec = std::stoi(positional[0]); }
         catch (...) { durationSec = 20; }
     }
-    if (argc > 2) {
-        try { stations = std::stoi(argv[2]); }
+    if (positional.size() > 1) {
+        try { stations = std::stoi(positional[1]); }
         catch (...) { stations = 3; }
     }
-    if (argc > 3) {
-        try { timeSliceMs = std::stoi(argv[3]); }
+    if (positional.size() > 2) {
+        try { timeSliceMs = std::stoi(positional[2]); }
         catch (...) { timeSliceMs = 100; }
     }
 
+    // the timeline is written however main returns, after the simulation below has stopped its threads
+    struct TraceDump {
+        std::string path;
+        ~TraceDump() {
+            if (path.empty()) return;
+            TraceRecorder& trace = TraceRecorder::instance();
+            trace.disable();
+            if (trace.writeChromeJson(path)) {
+                std::cout << "Wrote " << trace.eventCount() << " trace events to " << path;
+                if (trace.droppedCount() > 0) std::cout << " (" << trace.droppedCount() << " oldest overwritten)";
+                std::cout << "\n";
+            } else {
+                std::cout << "Cannot write trace file " << path << "\n";
+            }
+        }
+    } traceDump{tracePath};
+    if (!tracePath.empty()) TraceRecorder::instance().enable();
+
+    if (!sweepSpec.empty()) {
+        SweepGrid grid;
+        grid.duration = std::chrono::seconds(durationSec);
+        if (!SweepGrid::parse(sweepSpec, grid)) {
+            std::cout << "Malformed sweep '" << sweepSpec << "'\n";
+            return 1;
+        }
+        SweepCache cache(sweepCachePath);
+        ParameterSweep sweep(grid, cache, static_cast<size_t>(std::max(0, sweepJobs)));
+        std::cout << "Sweeping " << grid.points().size() << " configurations of " << durationSec
+                  << " simulated seconds (" << cache.size() << " results cached"
+                  << (sweepCachePath.empty() ? "" : " in " + sweepCachePath) << ")\n";
+        printSweepTable(std::cout, sweep.run());
+        const SweepSummary& summary = sweep.summary();
+        std::cout << summary.points << " points: " << summary.computed << " computed, " << summary.cached
+                  << " from cache in " << summary.wallSeconds << " s\n";
+        if (!cache.writable()) std::cout << "Cannot write sweep cache " << sweepCachePath << "\n";
+        return 0;
+    }
+
     std::cout << "Starting simulation for " << durationSec << " simulated seconds (real ms/slice=" << timeSliceMs << "), stations=" << stations << "\n";
 
+    if (shards > 1) {
+        ShardConfig config;
+        config.shards = shards;
+        config.fleetSize = fleetSize;
+        config.stations = stations;
+        config.timeSliceMs = timeSliceMs;
+        config.duration = std::chrono::seconds(durationSec);
+        std::cout << "Sharding " << fleetSize << " vehicles across " << shards << " worker processes\n";
+        ShardedSimulation sharded(config);
+        bool ok = sharded.run();
+        sharded.printResults(std::cout);
+        std::cout << (ok ? "Simulation completed.\n" : "Simulation failed: a shard did not finish.\n");
+        return ok ? 0 : 1;
+    }
+
+    if (!outOfCorePath.empty()) {
+        OutOfCoreConfig config;
+        config.path = outOfCorePath;
+        config.fleetSize = static_cast<std::uint64_t>(std::max(0, fleetSize));
+        config.stations = stations;
+        config.duration = std::chrono::seconds(durationSec);
+        OutOfCoreSimulation outOfCore(config);
+        bool ok = outOfCore.run();
+        if (ok) {
+            outOfCore.printResults(std::cout);
+            VehicleStatsManager::getInstance().printAll();
+        }
+        std::cout << (ok ? "Simulation completed.\n" : "Simulation failed: cannot create " + outOfCorePath + "\n");
+        return ok ? 0 : 1;
+    }
+
+    if (cohorts) {
+        CohortConfig config;
+        config.fleetSize = static_cast<std::uint64_t>(std::max(0, fleetSize));
+        config.stations = stations;
+        config.duration = std::chrono::seconds(durationSec);
+        CohortSimulation cohortSim(config);
+        cohortSim.run();
+        cohortSim.printResults(std::cout);
+        VehicleStatsManager::getInstance().printAll();
+        std::cout << "Simulation completed.\n";
+        return 0;
+    }
+
     Simulation sim(stations, timeSliceMs);
+    sim.setDeployment(std::make_unique<VehicleRandomDeployment>(fleetSize));
+    sim.setReportInterval(std::chrono::seconds(reportEverySec));
+    sim.setExecutionMode(mode);
+    sim.setCycleExport(exportPath);
+    sim.setOverrunPolicy(overrun);
+    sim.setCpuBudget(static_cast<size_t>(std::max(0, cpuBudget)));
+    if (cpuBudget > 0 && mode != ExecutionMode::Pipeline && branches.empty()) {
+        std::cout << "Ignoring --cpu-budget: it applies to --mode pipeline only\n";
+    }
+    if (placement.any() && (mode != ExecutionMode::Threads || !branches.empty())) {
+        // the pipeline's pool workers and the coroutine driver have no per-stage threads to pin
+        std::cout << "Ignoring --pin: stage pinning applies to --mode threads only\n";
+    } else if (placement.any()) {
+        std::cout << "Pinning runner/dispatcher/charger to cpus " << placement.runnerCpu << "/"
+                  << placement.dispatcherCpu << "/" << placement.chargerCpu << " (numa nodes "
+                  << numaNodeOfCpu(placement.runnerCpu) << "/" << numaNodeOfCpu(placement.dispatcherCpu) << "/"
+                  << numaNodeOfCpu(placement.chargerCpu) << ")\n";
+        sim.setPlacement(placement);
+    }
+    MetricsServer metrics([&sim] { return toPrometheus(sim.snapshot()); });
+    if (metricsPort > 0) {
+        if (metrics.start(static_cast<std::uint16_t>(metricsPort))) {
+            std::cout << "Serving metrics on http://127.0.0.1:" << metrics.port() << "/metrics\n";
+        } else {
+            std::cout << "Could not bind metrics port " << metricsPort << ", continuing without it\n";
+        }
+    }
+
+    if (!branches.empty()) {
+        std::cout << "Branching into " << branches.size() << " variants at t=" << branchAtSec << "s\n";
+        auto results = sim.runBranches(std::chrono::seconds(branchAtSec), std::chrono::seconds(durationSec), branches);
+        printBranchResults(std::cout, results);
+        bool ok = std::all_of(results.begin(), results.end(), [](const BranchResult& r) { return r.ok; });
+        std::cout << (ok ? "Simulation completed.\n" : "Simulation failed: a branch did not finish.\n");
+        return ok ? 0 : 1;
+    }
+
     sim.runSimulation(std::chrono::seconds(durationSec));
 
     std::cout << "Simulation completed.\n";
@@ -1,11 +1,34 @@
 #include "VehicleStatsManager.h"
 #include "VehicleStatsData.h"
 #include "ChargeStationManager.h"
+#include "ThreadSafeQueue.h"
+#include "BoundedQueue.h"
+#include "IntrusiveQueue.h"
 #include "Simulation.h"
 #include "Factories.h"
+#include "VehicleKernels.h"
+#include "TimingWheel.h"
+#include "ThreadPlacement.h"
+#include "MemoryTracking.h"
+#include "MetricsServer.h"
+#include "CycleExport.h"
+#include "EnergyModel.h"
+#include "ShardedSimulation.h"
+#include "StationMetrics.h"
+#include "OutOfCoreFleet.h"
+#include "SimulationContext.h"
+#include "Tracing.h"
+#include "ParameterSweep.h"
+#include "CohortSimulation.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
 #include <cassert>
 #include <thread>
 #include <iostream>
+#include <sstream>
+#include <fstream>
 
 struct VehicleParams {
     std::string type;
@@ -16,6 +39,19 @@ struct VehicleParams {
     int passengers;
     double faultPerHour;
 };
+
+/**
+ * @brief Scratch file path under /tmp unique to this process, unlinked when it goes out of scope.
+ */
+struct TempPath {
+    std::string path;   ///< /tmp/vehicle_sim_<pid>_<name>
+
+    explicit TempPath(const std::string& name)
+        : path("/tmp/vehicle_sim_" + std::to_string(::getpid()) + "_" + name) { ::unlink(path.c_str()); }
+    ~TempPath() { ::unlink(path.c_str()); }
+    TempPath(const TempPath&) = delete;
+    TempPath& operator=(const TempPath&) = delete;
+};
 // ------------------------------------------
 // VehicleStatsManager tests
 // ------------------------------------------
@@ -103,6 +139,11 @@ public:
     static void run() {
         std::cout << "[TEST] Vehicle factories..." << std::endl;
 
+        // building a vehicle leaves the process-wide stats alone: no lock taken, no stats allocated
+        MemoryTracker::ScopedEnable tracking;
+        auto& tracker = MemoryTracker::instance();
+        const long long statsAllocs = tracker.counts(MemSubsystem::StatsMap).allocations;
+
         AlphaFactory a; BravoFactory b; CharlieFactory c; DelaFactory d; EchoFactory e;
         auto va = a.createVehicle();
         auto vb = b.createVehicle();
@@ -115,6 +156,7 @@ public:
         assert(vc->getBatteryCapacity() ==220);
         assert(vd->getTimeToCharge() == 0.62);
         assert(ve->getFaultPerHour() == 0.61);
+        assert(tracker.counts(MemSubsystem::StatsMap).allocations == statsAllocs);
 
         std::cout << " FactoryTest passed\n";
     }
@@ -150,7 +192,8 @@ public:
         Vehicle* vp = v.get();
         sim.runQueue.push(vp);
         //runnerThread = std::thread(&Simulation::runnerThreadFunc, this);
-        vp->batteryRatio = 0.0;
+        // one runner tick away from an empty battery
+        vp->runFor(static_cast<double>(vp->ticksUntilDepleted() - 1));
         std::thread testThread = std::thread(&Simulation::runnerThreadFunc, &sim);
 	//sim.runnerThreadFunc();
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
@@ -165,6 +208,1538 @@ public:
     }
 };
 // ------------------------------------------
+// Compile-time tick kernel test
+// ------------------------------------------
+class VehicleKernelTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Vehicle tick kernels..." << std::endl;
+
+        static_assert(TickKernel<VehicleKind::Bravo>::driveSec == 3600.0 * (100 / 1.5) / 100,
+                      "Bravo drive threshold must fold at compile time");
+        static_assert(TickKernel<VehicleKind::Alpha>::chargeSec == 0.6 * 3600.0,
+                      "Alpha charge threshold must fold at compile time");
+
+        // kernel path and runtime fallback must agree tick for tick
+        BravoFactory b;
+        auto kernelVehicle = b.createVehicle();
+        const VehicleSpec& spec = specFor(VehicleKind::Bravo);
+        Vehicle runtimeVehicle(spec.type, spec.cruiseSpeed, spec.batteryCapacity, spec.timeToCharge,
+                               spec.energyUse, spec.passengers, spec.faultPerHour);
+        assert(kernelVehicle->getKind() == VehicleKind::Bravo);
+        assert(runtimeVehicle.getKind() == VehicleKind::Custom);
+        runtimeVehicle.setEnergyTable(energyTableFor(VehicleKind::Bravo, spec.passengers));
+
+        KindBatches batches;
+        batches[static_cast<size_t>(VehicleKind::Bravo)].push_back(kernelVehicle.get());
+        batches[static_cast<size_t>(VehicleKind::Custom)].push_back(&runtimeVehicle);
+        while (!kernelVehicle->needsCharge()) {
+            runKindBatches(batches);
+            assert(runtimeVehicle.needsCharge() == kernelVehicle->needsCharge());
+        }
+        assert(kernelVehicle->getRunningTime() >= TickKernel<VehicleKind::Bravo>::driveSec);
+
+        std::cout << " VehicleKernelTest passed\n";
+    }
+};
+// ------------------------------------------
+// VehicleStatsData snapshot test
+// ------------------------------------------
+class VehicleStatsSnapshotTest {
+public:
+    static void run() {
+        std::cout << "[TEST] VehicleStatsData snapshot..." << std::endl;
+
+        VehicleStatsData stats;
+        Vehicle v("Snap", 60, 100, 1.0, 2.0, 2, 0.1);
+        for (int i = 0; i < 10; ++i) v.advanceRun(1e9);
+        stats.record(v, StatType::TotalTestVehicle);
+
+        std::atomic<bool> done{false};
+        std::thread writer([&] {
+            for (int i = 0; i < 20000; ++i) stats.record(v, StatType::TotalTime);
+            done = true;
+        });
+
+        // reads never block the writer and always see a whole record
+        double lastTime = 0;
+        while (!done) {
+            VehicleStatsSnapshot snap = stats.snapshot();
+            assert(snap.totalTime >= lastTime);
+            assert(static_cast<long>(snap.totalTime) % 10 == 0);
+            lastTime = snap.totalTime;
+        }
+        writer.join();
+
+        VehicleStatsSnapshot snap = stats.snapshot();
+        assert(snap.totalTime == 200000);
+        assert(snap.averageTime == 200000);
+        assert(snap.totalDistance == 200000.0 * 60 / 3600);
+        // summed per record, so only equal up to rounding
+        assert(std::abs(snap.totalPassengersMiles - 200000.0 * 2 * 60 / 3600) < 1e-6);
+
+        // passenger-miles follow each record's own load, however loads mix within a type
+        VehicleStatsData mixed;
+        Vehicle full("Mixed", 60, 100, 1.0, 2.0, 4, 0.1);
+        Vehicle light("Mixed", 60, 100, 1.0, 2.0, 4, 0.1);
+        light.setLoad(1);
+        full.advanceRun(3600);
+        light.advanceRun(1800);
+        mixed.record(full, StatType::TotalTime);
+        mixed.record(light, StatType::TotalTime);
+        mixed.recordWeighted(light, StatType::PartialTime, 2);
+        const double expected = (full.getCruiseEquivalentTime() * 4 + 3 * light.getCruiseEquivalentTime() * 1) * 60 / 3600;
+        assert(std::abs(mixed.snapshot().totalPassengersMiles - expected) < 1e-9);
+
+        std::cout << " VehicleStatsSnapshotTest passed\n";
+    }
+};
+// ------------------------------------------
+// Live snapshot / early stop test
+// ------------------------------------------
+class SimulationSnapshotTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Simulation snapshot..." << std::endl;
+
+        Simulation sim(3, 1);
+        SimulationSnapshot seen;
+        std::thread monitor([&] {
+            // poll until the runner has ticked, then abort the long run
+            do {
+                std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                seen = sim.snapshot();
+            } while (seen.simulatedSeconds < 5);
+            sim.requestStop();
+        });
+
+        auto start = std::chrono::steady_clock::now();
+        sim.runSimulation(std::chrono::seconds(3600));
+        monitor.join();
+
+        assert(std::chrono::steady_clock::now() - start < std::chrono::seconds(60));
+        assert(seen.stationsTotal == 3);
+        assert(seen.runQueueDepth + seen.needChargeQueueDepth + seen.chargeQueueDepth <= 20);
+        assert(!seen.stats.empty());
+
+        std::cout << " SimulationSnapshotTest passed\n";
+    }
+};
+// ------------------------------------------
+// Hierarchical timing wheel test
+// ------------------------------------------
+class TimingWheelTest {
+public:
+    template<unsigned SlotBits, unsigned Levels>
+    static void check(std::uint64_t start, std::uint64_t horizon, std::uint64_t stride) {
+        HierarchicalTimingWheel<std::uint64_t, SlotBits, Levels> wheel(start);
+        size_t scheduled = 0;
+        for (std::uint64_t due = start + 1; due <= start + horizon; due += stride) {
+            wheel.schedule(due, due);
+            ++scheduled;
+        }
+        assert(wheel.size() == scheduled);
+
+        size_t expired = 0;
+        while (!wheel.empty()) {
+            wheel.advance([&](std::uint64_t& due) {
+                assert(due == wheel.currentTick());
+                ++expired;
+            });
+        }
+        assert(expired == scheduled);
+    }
+
+    static void run() {
+        std::cout << "[TEST] Timing wheel..." << std::endl;
+
+        // tiny wheel (span 16) exercises cascading and the overflow list
+        check<2, 2>(0, 100, 1);
+        check<2, 2>(13, 500, 7);
+        // default geometry across several levels
+        check<6, 4>(0, 300000, 997);
+        check<6, 4>(4095, 10000, 1);
+
+        std::cout << " TimingWheelTest passed\n";
+    }
+};
+// ------------------------------------------
+// Thread placement test
+// ------------------------------------------
+class ThreadPlacementTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Thread placement..." << std::endl;
+
+        StagePlacement p = StagePlacement::parse("0,2,x");
+        assert(p.runnerCpu == 0 && p.dispatcherCpu == 2 && p.chargerCpu == -1);
+        assert(p.any());
+        assert(!StagePlacement::parse("").any());
+
+        // unpinned and out-of-range requests are graceful no-ops
+        std::thread t([] {
+            assert(!pinCurrentThread(-1));
+            assert(!pinCurrentThread(1 << 20));
+        });
+        t.join();
+
+        std::cout << " ThreadPlacementTest passed\n";
+    }
+};
+// ------------------------------------------
+// Coroutine execution mode test
+// ------------------------------------------
+class CoroutineModeTest {
+public:
+    /** @brief Deploys identical runtime-specified vehicles of a test-only type. */
+    class FixedDeployment : public VehicleDeployment {
+    public:
+        explicit FixedDeployment(int count) : count(count) {}
+        std::vector<std::unique_ptr<Vehicle>> deployVehicles() override {
+            std::vector<std::unique_ptr<Vehicle>> result;
+            for (int i = 0; i < count; ++i) {
+                // drives 2400 s per charge, charges for 720 s
+                result.push_back(std::make_unique<Vehicle>("CoAgent", 100, 100, 0.2, 1.5, 5, 0.1));
+            }
+            return result;
+        }
+    private:
+        int count;
+    };
+
+    static void run() {
+        std::cout << "[TEST] Coroutine execution mode..." << std::endl;
+
+        // one station, two vehicles: the second waits for the first to finish charging
+        Simulation sim(1, 0);
+        sim.setExecutionMode(ExecutionMode::Coroutines);
+        sim.setDeployment(std::make_unique<FixedDeployment>(2));
+        sim.runSimulation(std::chrono::seconds(4000));
+
+        VehicleStatsSnapshot snap = VehicleStatsManager::getInstance().snapshotAll()["CoAgent"];
+        assert(snap.totalChargedVehicle == 2);
+        assert(snap.totalTestVehicle == 4);
+        // both drove 4000 s minus their charging and waiting time
+        assert(snap.totalTime == 2 * 4000 - 720 - (720 + 720));
+        assert(snap.totalChargeTime == 720 + 720);
+
+        SimulationSnapshot live = sim.snapshot();
+        assert(live.stationsAvailable == 1);
+        assert(live.runQueueDepth == 0 && live.chargeQueueDepth == 0);
+
+        std::cout << " CoroutineModeTest passed\n";
+    }
+};
+// ------------------------------------------
+// Shared worker pool test
+// ------------------------------------------
+class WorkerPoolTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Worker pool..." << std::endl;
+
+        WorkerPool pool(2);
+        std::atomic<int> done{0};
+        for (int round = 0; round < 50; ++round) {
+            for (int i = 0; i < 20; ++i) pool.submit([&] { done.fetch_add(1); });
+            pool.wait();
+            assert(done == (round + 1) * 20);
+        }
+
+        // pipeline mode runs the same vehicle lifecycle as the stage threads
+        Simulation sim(1, 0);
+        sim.setExecutionMode(ExecutionMode::Pipeline);
+        sim.setDeployment(std::make_unique<CoroutineModeTest::FixedDeployment>(2));
+        sim.runSimulation(std::chrono::seconds(4000));
+        SimulationSnapshot snap = sim.snapshot();
+        assert(snap.simulatedSeconds == 4000);
+        assert(snap.stationsAvailable == 1);
+
+        std::cout << " WorkerPoolTest passed\n";
+    }
+};
+// ------------------------------------------
+// Memory tracking test
+// ------------------------------------------
+class MemoryTrackingTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Memory tracking..." << std::endl;
+
+        // earlier tests tracked only within their own scope
+        auto& tracker = MemoryTracker::instance();
+        assert(!tracker.isEnabled());
+        MemoryTracker::ScopedEnable tracking;
+        {
+            MemoryTracker::ScopedEnable nested;
+        }
+        assert(tracker.isEnabled());
+
+        auto before = tracker.counts(MemSubsystem::Test);
+        {
+            ThreadSafeQueue<Vehicle*, TrackingAllocator<Vehicle*>> q{TrackingAllocator<Vehicle*>(MemSubsystem::Test)};
+            for (int i = 0; i < 1000; ++i) q.push(nullptr);
+            auto during = tracker.counts(MemSubsystem::Test);
+            assert(during.allocations > before.allocations);
+            assert(during.liveBytes >= before.liveBytes + static_cast<long long>(1000 * sizeof(Vehicle*)));
+            assert(during.peakBytes >= during.liveBytes);
+        }
+        // everything the queue allocated was credited back
+        assert(tracker.counts(MemSubsystem::Test).liveBytes == before.liveBytes);
+
+        auto vehiclesBefore = tracker.counts(MemSubsystem::Vehicles);
+        {
+            AlphaFactory a;
+            auto v = a.createVehicle();
+            assert(tracker.counts(MemSubsystem::Vehicles).liveBytes > vehiclesBefore.liveBytes);
+        }
+        assert(tracker.counts(MemSubsystem::Vehicles).liveBytes == vehiclesBefore.liveBytes);
+
+        // nothing allocated untracked was freed as tracked
+        for (const auto& c : tracker.countsAll()) assert(c.liveBytes >= 0);
+
+        std::cout << " MemoryTrackingTest passed\n";
+    }
+};
+// ------------------------------------------
+// Prometheus metrics endpoint test
+// ------------------------------------------
+class MetricsServerTest {
+public:
+    static std::string httpGet(std::uint16_t port) {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        assert(fd >= 0);
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = htons(port);
+        assert(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0);
+        const std::string request = "GET /metrics HTTP/1.0\r\n\r\n";
+        assert(::send(fd, request.data(), request.size(), 0) == static_cast<ssize_t>(request.size()));
+        std::string response;
+        char buf[1024];
+        ssize_t n;
+        while ((n = ::recv(fd, buf, sizeof(buf), 0)) > 0) response.append(buf, static_cast<size_t>(n));
+        ::close(fd);
+        return response;
+    }
+
+    static void run() {
+        std::cout << "[TEST] Metrics endpoint..." << std::endl;
+
+        SimulationSnapshot snap;
+        snap.simulatedSeconds = 42;
+        snap.stationsTotal = 3;
+        snap.stationsAvailable = 1;
+        snap.stats["Alpha"].totalChargedVehicle = 7;
+        snap.pacing.overruns = 4;
+
+        MetricsServer server([&snap] { return toPrometheus(snap); });
+        assert(server.start(0));
+        assert(server.port() != 0);
+
+        std::string response = httpGet(server.port());
+        assert(response.rfind("HTTP/1.0 200 OK", 0) == 0);
+        assert(response.find("vehiclesim_simulated_seconds 42\n") != std::string::npos);
+        assert(response.find("vehiclesim_stations_busy 2\n") != std::string::npos);
+        assert(response.find("vehiclesim_tick_overruns_total 4\n") != std::string::npos);
+        assert(response.find("vehiclesim_charge_cycles_total{type=\"Alpha\"} 7\n") != std::string::npos);
+        assert(response.find("# TYPE vehiclesim_queue_depth gauge") != std::string::npos);
+
+        server.stop();
+        assert(server.port() == 0);
+
+        std::cout << " MetricsServerTest passed\n";
+    }
+};
+// ------------------------------------------
+// Columnar cycle export test
+// ------------------------------------------
+class CycleExportTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Columnar cycle export..." << std::endl;
+        const TempPath cyclesFile("cycles_test.bin");
+        const std::string& path = cyclesFile.path;
+
+        // small row groups from several threads: every row lands in exactly one group
+        {
+            CycleExporter exporter(path, 16);
+            assert(exporter.isOpen());
+            std::vector<std::thread> producers;
+            for (int t = 0; t < 4; ++t) {
+                producers.emplace_back([&exporter, t] {
+                    for (int i = 0; i < 100; ++i) {
+                        CycleRow row;
+                        row.vehicleId = static_cast<std::uint32_t>(t * 1000 + i);
+                        row.type = t % 2 ? "Odd" : "Even";
+                        row.duration = i;
+                        exporter.append(row);
+                    }
+                });
+            }
+            for (auto& p : producers) p.join();
+            exporter.close();
+            assert(exporter.rowsWritten() == 400);
+        }
+        {
+            CycleFile file(path);
+            assert(file.isOpen());
+            assert(file.rowCount() == 400);
+            double durationSum = 0;
+            for (size_t g = 0; g < file.groupCount(); ++g) {
+                auto ids = file.column<std::uint32_t>(g, CycleColumn::VehicleId);
+                auto types = file.column<std::uint16_t>(g, CycleColumn::Type);
+                for (size_t r = 0; r < ids.size(); ++r) {
+                    assert(file.typeName(types[r]) == ((ids[r] / 1000) % 2 ? "Odd" : "Even"));
+                }
+                for (double d : file.column<double>(g, CycleColumn::Duration)) durationSum += d;
+            }
+            assert(durationSum == 4 * (99 * 100 / 2));
+        }
+
+        // one station, two vehicles: the second waits for the first's 720 s charge
+        Simulation sim(1, 0);
+        sim.setExecutionMode(ExecutionMode::Coroutines);
+        sim.setDeployment(std::make_unique<CoroutineModeTest::FixedDeployment>(2));
+        sim.setCycleExport(path);
+        sim.runSimulation(std::chrono::seconds(4000));
+        {
+            CycleFile file(path);
+            assert(file.isOpen());
+            assert(file.rowCount() == 2 && file.groupCount() == 1);
+            auto ids = file.column<std::uint32_t>(0, CycleColumn::VehicleId);
+            auto waits = file.column<std::int64_t>(0, CycleColumn::ChargeWait);
+            auto charge = file.column<double>(0, CycleColumn::ChargeTime);
+            auto duration = file.column<double>(0, CycleColumn::Duration);
+            auto distance = file.column<double>(0, CycleColumn::Distance);
+            assert(ids[0] == 0 && ids[1] == 1);
+            assert(waits[0] == 0 && waits[1] == 720);
+            assert(charge[0] == 720 && charge[1] == 720);
+            assert(duration[0] == 2401 && distance[0] == 2401 * 100 / 3600.0);
+            assert(file.column<std::int64_t>(0, CycleColumn::Start)[1] == 0);
+            assert(file.typeName(file.column<std::uint16_t>(0, CycleColumn::Type)[0]) == "CoAgent");
+        }
+
+        std::cout << " CycleExportTest passed\n";
+    }
+};
+// ------------------------------------------
+// Energy model test
+// ------------------------------------------
+class EnergyModelTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Energy model..." << std::endl;
+
+        // the flat table is the constant-rate model, exactly
+        const EnergyTable& flat = EnergyTable::flat();
+        for (std::uint64_t t : {0ull, 1ull, 255ull, 256ull, 2401ull, 1000000ull}) {
+            assert(flat.drainAt(t) == static_cast<double>(t));
+        }
+        assert(flat.ticksToDrain(3600.0 * (100 / 1.5) / 100) == 2401);
+
+        // the grid reproduces the spec at cruise speed and full load, and interpolates monotonically
+        const VehicleSpec& spec = specFor(VehicleKind::Alpha);
+        EnergyModel model(spec);
+        assert(std::abs(model.kwhPerMile(spec.cruiseSpeed, spec.passengers) - spec.energyUse) < 1e-9);
+        assert(model.kwhPerMile(spec.cruiseSpeed * 0.5, spec.passengers) < spec.energyUse);
+        assert(model.kwhPerMile(spec.cruiseSpeed, 0) < spec.energyUse);
+        const double mid = model.kwhPerMile(spec.cruiseSpeed * 0.77, 1.5);
+        assert(mid > model.kwhPerMile(spec.cruiseSpeed * 0.76, 1.5) && mid < model.kwhPerMile(spec.cruiseSpeed * 0.78, 1.5));
+
+        // state of charge falls continuously; the scheduled depletion tick matches tick-by-tick stepping
+        BravoFactory b;
+        auto full = b.createVehicle();
+        const long scheduled = full->ticksUntilDepleted();
+        double lastSoc = full->getStateOfCharge();
+        long ticks = 0;
+        while (!full->needsCharge()) {
+            full->advanceRun(TickKernel<VehicleKind::Bravo>::driveSec);
+            ++ticks;
+            assert(full->getStateOfCharge() < lastSoc);
+            lastSoc = full->getStateOfCharge();
+        }
+        assert(ticks == scheduled);
+        assert(full->getDistance() > 0 && full->getDistance() < full->getRunningTime() * full->getCruiseSpeed() / 3600.0);
+
+        // an empty vehicle is lighter and goes further on the same battery
+        auto empty = b.createVehicle();
+        empty->setLoad(0);
+        assert(empty->ticksUntilDepleted() > scheduled);
+
+        std::cout << " EnergyModelTest passed\n";
+    }
+};
+// ------------------------------------------
+// Bounded queue test
+// ------------------------------------------
+class BoundedQueueTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Bounded queue..." << std::endl;
+
+        MemoryTracker::ScopedEnable tracking;
+        auto& tracker = MemoryTracker::instance();
+        BoundedQueue<int, TrackingAllocator<int>> q{4, TrackingAllocator<int>(MemSubsystem::Test)};
+        assert(q.capacity() == 4);
+
+        // try/timed pushes report a full ring instead of growing it
+        auto before = tracker.counts(MemSubsystem::Test);
+        for (int i = 0; i < 4; ++i) assert(q.tryPush(i));
+        assert(!q.tryPush(4));
+        assert(!q.pushFor(4, std::chrono::milliseconds(5)));
+        assert(q.highWaterMark() == 4);
+
+        // FIFO across wrap-around, with no allocation in the steady state
+        for (int round = 0; round < 100; ++round) {
+            assert(*q.tryPop() == round);
+            q.push(round + 4);
+        }
+        assert(tracker.counts(MemSubsystem::Test).allocations == before.allocations);
+
+        // a blocked producer resumes once a consumer makes room
+        std::thread producer([&q] { q.push(1000); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        assert(q.size() == 4);
+        assert(q.pop() == 100);
+        producer.join();
+        assert(q.size() == 4);
+
+        // growing keeps queued elements in order
+        q.reserve(16);
+        assert(q.capacity() == 16);
+        for (int expect : {101, 102, 103, 1000}) assert(*q.tryPop() == expect);
+        assert(!q.tryPop());
+        assert(q.highWaterMark() == 4);
+
+        // a vehicle sits in one simulation queue at a time, so depth never exceeds the fleet
+        Simulation sim(1, 0);
+        sim.setDeployment(std::make_unique<VehicleRandomDeployment>(50));
+        sim.runSimulation(std::chrono::seconds(3000));
+        SimulationSnapshot snap = sim.snapshot();
+        assert(snap.runQueueHighWater == 50);
+        assert(snap.needChargeQueueHighWater <= 50 && snap.chargeQueueHighWater <= 1);
+
+        std::cout << " BoundedQueueTest passed\n";
+    }
+};
+// ------------------------------------------
+// Sharded multi-process test
+// ------------------------------------------
+class ShardedSimulationTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Sharded simulation..." << std::endl;
+
+        // merging adds totals and recomputes averages
+        VehicleStatsSnapshot a, b;
+        a.totalTime = 100; a.totalTestVehicle = 1;
+        b.totalTime = 300; b.totalTestVehicle = 3; b.totalChargedVehicle = 2; b.totalChargeTime = 40;
+        mergeSnapshot(a, b);
+        assert(a.totalTime == 400 && a.averageTime == 100 && a.averageChargeTime == 20);
+
+        // a writer that died mid-publish leaves the slot torn: reads give up and keep the last copy
+        SharedStatsSlot torn;
+        torn.publish({{"Alpha", a}});
+        std::map<std::string, VehicleStatsSnapshot> seen;
+        assert(torn.read(seen) && seen["Alpha"].totalTime == 400);
+        torn.seq.fetch_add(1);
+        torn.publish({{"Alpha", b}});
+        assert(!torn.read(seen) && seen["Alpha"].totalTime == 400);
+
+        // three processes, two vehicles each, contending for one shared station; wall-clock
+        // pacing keeps the shards in step, so all six vehicles deplete together at 2400 s
+        ShardConfig config;
+        config.shards = 3;
+        config.fleetSize = 6;
+        config.stations = 1;
+        config.timeSliceMs = 1;
+        config.duration = std::chrono::seconds(4000);
+        config.deployment = [](int n) { return std::make_unique<CoroutineModeTest::FixedDeployment>(n); };
+        ShardedSimulation sharded(config);
+        assert(sharded.run());
+
+        // each shard records its own fleet once, plus one run per completed charge; a shard may
+        // end while charging, but the shared pool lets it hold at most the one station
+        double completed = 0, acquired = 0;
+        int lowWater = config.stations;
+        for (int i = 0; i < config.shards; ++i) {
+            auto status = sharded.shardStatus(i);
+            assert(status.state == ShardedSimulation::ShardState::Done);
+            assert(status.simulatedSeconds == 4000 && status.vehicles == 2);
+            // an acquire never took the pool below zero
+            assert(status.stationsLowWater >= 0 && status.stationsLowWater <= config.stations);
+            lowWater = std::min(lowWater, status.stationsLowWater);
+            auto shard = sharded.shardStats(i);
+            assert(shard.size() == 1);
+            const VehicleStatsSnapshot& own = shard["CoAgent"];
+            const double charges = own.totalTestVehicle - status.vehicles;
+            assert(charges >= 0 && (own.totalChargedVehicle == charges || own.totalChargedVehicle == charges + 1));
+            completed += charges;
+            acquired += own.totalChargedVehicle;
+        }
+        // every station taken from the shared pool was given back
+        assert(sharded.stationsAvailable() == 1);
+
+        // one station serves two 720 s charges between 2400 s and 4000 s, one more for shard start-up
+        // skew; with a pool per shard every shard would complete two
+        assert(completed >= 1 && completed <= 3 && acquired <= completed + config.shards);
+        assert(lowWater == 0);
+
+        // only the workers' records are merged, and they add up to the shards'
+        auto merged = sharded.mergedStats();
+        assert(merged.size() == 1);
+        const VehicleStatsSnapshot& snap = merged["CoAgent"];
+        assert(snap.totalTestVehicle == config.fleetSize + completed && snap.totalChargedVehicle == acquired);
+        assert(snap.totalTime <= 6 * 4000.0);
+
+        std::cout << " ShardedSimulationTest passed\n";
+    }
+};
+// ------------------------------------------
+// Batched charge dispatch test
+// ------------------------------------------
+class BatchDispatchTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Batched charge dispatch..." << std::endl;
+
+        // stations: take what is free, up to the request, in one step
+        ChargeStationManager stations(3);
+        assert(stations.tryAcquireUpTo(5) == 3);
+        assert(stations.tryAcquireUpTo(1) == 0);
+        stations.release(2);
+        assert(stations.getAvailable() == 2);
+        std::atomic<bool> stop{false};
+        assert(stations.acquireUpTo(4, stop) == 2);
+        // blocks while none is free, then takes as many as it can
+        std::thread releaser([&stations] {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            stations.release(3);
+        });
+        assert(stations.acquireUpTo(2, stop) == 2);
+        releaser.join();
+        assert(stations.getAvailable() == 1);
+        stop = true;
+        assert(stations.acquireUpTo(1, stop) == 0);
+
+        // queues: batches keep FIFO order and wrap around the ring
+        BoundedQueue<int> q(4);
+        std::vector<int> in{1, 2, 3}, out;
+        q.pushBatch(in);
+        assert(q.tryPopBatch(out, 2) == 2 && out == std::vector<int>({1, 2}));
+        q.pushBatch(std::vector<int>{4, 5, 6});
+        assert(q.size() == 4 && q.highWaterMark() == 4);
+        assert(q.tryPopBatch(out, 10) == 4 && out == std::vector<int>({1, 2, 3, 4, 5, 6}));
+        assert(q.tryPopBatch(out, 10) == 0);
+
+        // bulk stats match per-vehicle records
+        Vehicle a("BatchAgent", 100, 100, 0.2, 1.5, 5, 0.1), b = a;
+        std::vector<Vehicle*> pair{&a, &b};
+        VehicleStatsData data;
+        data.recordBatch(pair, StatType::TotalChargeCycle);
+        data.recordBatch(pair, StatType::TotalTestVehicle);
+        data.record(a, StatType::TotalChargeCycle);
+        assert(data.snapshot().totalChargedVehicle == 3 && data.snapshot().totalTestVehicle == 2);
+
+        // ten vehicles deplete on the same tick; the four stations go to the first four in one batch
+        auto before = VehicleStatsManager::getInstance().snapshotAll()["CoAgent"];
+        Simulation sim(4, 0);
+        sim.setDeployment(std::make_unique<CoroutineModeTest::FixedDeployment>(10));
+        sim.runSimulation(std::chrono::seconds(3000));
+        auto after = VehicleStatsManager::getInstance().snapshotAll()["CoAgent"];
+        assert(after.totalChargedVehicle - before.totalChargedVehicle == 4);
+        SimulationSnapshot snap = sim.snapshot();
+        assert(snap.needChargeQueueHighWater == 10 && snap.chargeQueueHighWater == 4);
+        assert(snap.stationsAvailable == 4);
+
+        std::cout << " BatchDispatchTest passed\n";
+    }
+};
+// ------------------------------------------
+// Mergeable stats summaries test
+// ------------------------------------------
+class StatsMergeTest {
+public:
+    static bool near(double a, double b) { return std::fabs(a - b) <= 1e-9 * std::max(1.0, std::fabs(b)); }
+
+    static void run() {
+        std::cout << "[TEST] Mergeable stats summaries..." << std::endl;
+
+        // a tree of partial summaries matches one summary over every sample
+        RunningSummary whole, parts[4];
+        for (int x = 1; x <= 100; ++x) {
+            whole.add(x);
+            parts[x % 4].add(x);
+        }
+        parts[0].merge(parts[1]);
+        parts[2].merge(parts[3]);
+        parts[0].merge(parts[2]);
+        assert(parts[0].count == 100 && near(parts[0].mean, 50.5) && near(parts[0].variance(), 841.0 + 2.0 / 3));
+        assert(near(whole.variance(), parts[0].variance()));
+        assert(parts[0].min == 1 && parts[0].max == 100);
+        RunningSummary empty;
+        empty.merge(whole);
+        whole.merge(RunningSummary{});
+        assert(empty.count == 100 && whole.count == 100 && empty.min == 1);
+
+        // per-thread stats reduced with merge() equal one shared instance
+        Vehicle v("MergeAgent", 60, 100, 1.0, 2.0, 2, 0.1);
+        VehicleStatsData shared, threads[2];
+        for (int run = 1; run <= 6; ++run) {
+            v.resetRunningTime();
+            for (int t = 0; t < run * 10; ++t) v.advanceRun(1e9);
+            shared.record(v, StatType::TotalTime);
+            shared.record(v, StatType::TotalTestVehicle);
+            threads[run % 2].record(v, StatType::TotalTime);
+            threads[run % 2].record(v, StatType::TotalTestVehicle);
+        }
+        VehicleStatsData merged;
+        merged.merge(threads[0]);
+        merged.merge(threads[1]);
+        merged.merge(merged);   // self-merge is a no-op
+
+        // a collector without merge or reset keeps the defaults; a mismatched merge is reported and ignored
+        class CountingStats : public BaseStats {
+        public:
+            int records = 0;
+            void record(const Vehicle&, StatType) override { ++records; }
+            void log(const std::string&) const override {}
+        };
+        CountingStats counting;
+        counting.record(v, StatType::TotalTime);
+        counting.reset();
+        std::ostringstream reported;
+        std::streambuf* cerrBuf = std::cerr.rdbuf(reported.rdbuf());
+        counting.merge(counting);
+        merged.merge(counting);
+        std::cerr.rdbuf(cerrBuf);
+        assert(counting.records == 1 && merged.snapshot().totalTime == 210);
+        assert(reported.str().find("not supported") != std::string::npos);
+        assert(reported.str().find("different collector") != std::string::npos);
+        const VehicleStatsSnapshot a = shared.snapshot(), b = merged.snapshot();
+        assert(a.totalTime == b.totalTime && a.totalTestVehicle == b.totalTestVehicle && b.totalTime == 210);
+        assert(near(a.totalDistance, b.totalDistance) && near(a.totalPassengersMiles, b.totalPassengersMiles));
+        assert(b.runTime.count == 6 && near(b.runTime.mean, 35) && near(b.runTime.variance(), a.runTime.variance()));
+        assert(b.runTime.min == 10 && b.runTime.max == 60);
+        assert(b.runDistance.max == 1.0 && b.chargeTime.count == 0);
+
+        // snapshots merge the same way, in any order
+        VehicleStatsSnapshot left = threads[0].snapshot(), right = threads[1].snapshot();
+        mergeSnapshot(left, threads[1].snapshot());
+        mergeSnapshot(right, threads[0].snapshot());
+        assert(left.totalTime == 210 && right.totalTime == 210 && left.averageTime == 35);
+        assert(near(left.runTime.variance(), right.runTime.variance()));
+
+        merged.reset();
+        assert(merged.snapshot().totalTime == 0 && merged.snapshot().runTime.count == 0);
+
+        // a cycle cut short by the end of a run counts toward the totals but is no summary sample
+        v.resetRunningTime();
+        for (int t = 0; t < 5; ++t) v.advanceRun(1e9);
+        merged.record(v, StatType::PartialTime);
+        merged.record(v, StatType::PartialChargeTime);
+        assert(merged.snapshot().totalTime == 5 && merged.snapshot().runTime.count == 0);
+        assert(merged.snapshot().chargeTime.count == 0);
+
+        // an in-phase fleet that ends the run driving again: one completed run and charge per vehicle
+        class AlphaFleet : public VehicleDeployment {
+        public:
+            std::vector<std::unique_ptr<Vehicle>> deployVehicles() override {
+                std::vector<std::unique_ptr<Vehicle>> fleet;
+                for (int i = 0; i < 10; ++i) fleet.push_back(std::make_unique<Vehicle>(vehicleSpecs[0], VehicleKind::Alpha));
+                return fleet;
+            }
+        };
+        Vehicle alpha(vehicleSpecs[0], VehicleKind::Alpha);
+        const long drive = alpha.ticksUntilDepleted();
+        alpha.runFor(static_cast<double>(drive));
+        const long charge = alpha.ticksUntilCharged();
+        VehicleStatsManager inPhaseStats;
+        Simulation inPhase(10, 0);
+        inPhase.setQuiet(true);
+        inPhase.setStatsManager(inPhaseStats);
+        inPhase.setExecutionMode(ExecutionMode::Coroutines);
+        inPhase.setDeployment(std::make_unique<AlphaFleet>());
+        inPhase.runSimulation(std::chrono::seconds(drive + charge + drive / 2));
+        const VehicleStatsSnapshot cycle = inPhaseStats.snapshotAll().at("Alpha");
+        assert(cycle.chargeTime.count == cycle.totalChargedVehicle && cycle.totalChargedVehicle == 10);
+        assert(cycle.chargeTime.min > 0 && near(cycle.chargeTime.mean, cycle.averageChargeTime));
+        assert(cycle.runTime.count == 10 && cycle.runTime.min == drive && cycle.totalTestVehicle == 20);
+
+        // in a contended run every summary sample is a completed cycle, whatever is cut short at the end
+        VehicleStatsManager contendedStats;
+        Simulation contended(3, 0);
+        contended.setQuiet(true);
+        contended.setStatsManager(contendedStats);
+        contended.setDeployment(std::make_unique<VehicleRandomDeployment>(50, 7));
+        contended.runSimulation(std::chrono::seconds(20000));
+        double completedCharges = 0;
+        for (const auto& [type, snap] : contendedStats.snapshotAll()) {
+            assert(snap.runTime.count > 0 && snap.runTime.min > 0);
+            assert(snap.chargeTime.count == 0 || snap.chargeTime.min > 0);
+            assert(snap.chargeTime.count <= snap.totalChargedVehicle && snap.runTime.count <= snap.totalTestVehicle);
+            completedCharges += snap.chargeTime.count;
+        }
+        assert(completedCharges > 0 && completedCharges == static_cast<double>(contended.snapshot().stationReport.charges));
+
+        std::cout << " StatsMergeTest passed\n";
+    }
+};
+// ------------------------------------------
+// Deadline pacing test
+// ------------------------------------------
+class TickPacerTest {
+public:
+    using Ms = std::chrono::duration<double, std::milli>;
+
+    /** @brief Paces 10 ticks of 2 ms with one 7 ms stall in tick 2; returns the wall time taken. */
+    static double pacedRun(TickPacer& pacer) {
+        auto start = std::chrono::steady_clock::now();
+        pacer.start();
+        for (int t = 0; t < 10; ++t) {
+            if (t == 2) std::this_thread::sleep_for(std::chrono::milliseconds(7));
+            pacer.waitNext();
+        }
+        return Ms(std::chrono::steady_clock::now() - start).count();
+    }
+
+    static void run() {
+        std::cout << "[TEST] Deadline pacing..." << std::endl;
+
+        // percentiles are exact below 16 us and within a bucket width above
+        LatencyHistogram h;
+        assert(h.percentile(0.99) == 0);
+        for (std::uint64_t us = 1; us <= 1000; ++us) h.record(us);
+        assert(h.count() == 1000 && h.max() == 1000);
+        assert(h.percentile(0.50) >= 500 && h.percentile(0.50) <= 500 * 1.07);
+        assert(h.percentile(0.99) >= 990 && h.percentile(0.99) <= 1000);
+        assert(h.percentile(0.001) == 1);
+
+        assert(parseOverrunPolicy("skip") == OverrunPolicy::Skip);
+        assert(parseOverrunPolicy("slowdown") == OverrunPolicy::SlowDown);
+        assert(parseOverrunPolicy("bogus") == OverrunPolicy::CatchUp);
+
+        // work time does not add to the period: ten ticks take ten periods, stall included
+        TickPacer catchUp(std::chrono::milliseconds(2), OverrunPolicy::CatchUp);
+        double ms = pacedRun(catchUp);
+        PacingStats p = catchUp.stats();
+        assert(ms >= 20 && p.ticks == 10 && p.overruns >= 1 && p.skippedTicks == 0 && p.driftMs == 0);
+        assert(p.maxLatenessMs >= 4);
+
+        // skip drops the deadlines missed during the stall: still ten ticks, now behind by whole periods
+        TickPacer skip(std::chrono::milliseconds(2), OverrunPolicy::Skip);
+        ms = pacedRun(skip);
+        p = skip.stats();
+        assert(p.ticks == 10 && p.skippedTicks >= 2 && p.driftMs >= 4 && ms >= 20 + p.driftMs - 0.5);
+        assert(p.driftMs == 2.0 * static_cast<double>(p.skippedTicks));
+
+        // slow down shifts every later deadline by the overrun
+        TickPacer slow(std::chrono::milliseconds(2), OverrunPolicy::SlowDown);
+        ms = pacedRun(slow);
+        p = slow.stats();
+        assert(p.overruns >= 1 && p.skippedTicks == 0 && p.driftMs >= 4 && ms >= 24);
+
+        // a zero period neither sleeps nor measures
+        TickPacer off;
+        off.start();
+        off.waitNext();
+        assert(off.stats().ticks == 0);
+
+        // every real-time mode reports its clock's pacing
+        for (ExecutionMode mode : {ExecutionMode::Pipeline, ExecutionMode::Threads}) {
+            Simulation sim(1, 1);
+            sim.setQuiet(true);
+            sim.setExecutionMode(mode);
+            sim.setOverrunPolicy(OverrunPolicy::SlowDown);
+            sim.setDeployment(std::make_unique<CoroutineModeTest::FixedDeployment>(2));
+            sim.runSimulation(std::chrono::seconds(40));
+            const PacingStats run = sim.snapshot().pacing;
+            assert(run.ticks >= 5 && run.p50LatenessMs <= run.p99LatenessMs && run.p99LatenessMs <= run.maxLatenessMs);
+        }
+
+        std::cout << " TickPacerTest passed\n";
+    }
+};
+// ------------------------------------------
+// Adaptive worker scaling test
+// ------------------------------------------
+class AdaptiveScalerTest {
+public:
+    /** @brief A window in which the runner spends 1 us per vehicle on @p depth vehicles each tick. */
+    static StageSample window(size_t depth, size_t needCharge = 0, size_t charging = 0) {
+        StageSample s;
+        s.ticks = 8;
+        s.vehiclesRun = depth * 8;
+        s.runnerCpuMs = depth * 8 * 1e-3;
+        s.runDepth = depth;
+        s.needChargeDepth = needCharge;
+        s.chargeDepth = charging;
+        return s;
+    }
+
+    static void run() {
+        std::cout << "[TEST] Adaptive worker scaling..." << std::endl;
+
+        ScalerConfig config;
+        config.cpuBudget = 6;
+        config.targetTickMs = 1.0;
+        config.minVehiclesPerWorker = 100;
+        AdaptiveScaler scaler(config);
+        assert(scaler.budget() == 6 && scaler.current().total() == 1);
+
+        // 4000 vehicles at 1 us each need four 1 ms workers, granted at once
+        assert(scaler.update(window(4000)).runner == 4);
+        assert(scaler.nsPerVehicle() > 999 && scaler.nsPerVehicle() < 1001);
+
+        // the budget caps the runner, and serial stages take their share of it
+        assert(scaler.update(window(20000, 5, 3)).runner == 4);
+        assert(scaler.current().dispatcher == 1 && scaler.current().charger == 1 && scaler.current().total() == 6);
+
+        // a small dip inside the hysteresis band keeps the allocation
+        for (int i = 0; i < 10; ++i) assert(scaler.update(window(3000)).runner == 4);
+
+        // a sustained lull releases one worker per shrinkWindows windows
+        for (int i = 0; i < config.shrinkWindows - 1; ++i) assert(scaler.update(window(1500)).runner == 4);
+        assert(scaler.update(window(1500)).runner == 3);
+        assert(scaler.peak() == 6);
+
+        // a run queue too small to split gets one worker right away
+        assert(scaler.update(window(100)).runner == 1 && scaler.current().total() == 1);
+
+        // parked pool workers take no tasks; the waiting thread runs them all
+        WorkerPool pool(3);
+        pool.setActiveWorkers(0);
+        assert(pool.activeWorkers() == 0);
+        std::vector<std::thread::id> ran(16);
+        for (size_t i = 0; i < ran.size(); ++i) pool.submit([&ran, i] { ran[i] = std::this_thread::get_id(); });
+        pool.wait();
+        for (auto id : ran) assert(id == std::this_thread::get_id());
+        pool.setActiveWorkers(10);
+        assert(pool.activeWorkers() == 3);
+        std::atomic<int> done{0};
+        for (int i = 0; i < 16; ++i) pool.submit([&done] { ++done; });
+        pool.wait();
+        assert(done == 16);
+
+        // a small fleet under a budget of two never uses more than it needs
+        Simulation sim(3, 0);
+        sim.setQuiet(true);
+        sim.setCpuBudget(2);
+        sim.setDeployment(std::make_unique<VehicleRandomDeployment>(50));
+        sim.runSimulation(std::chrono::seconds(3000));
+        SimulationSnapshot snap = sim.snapshot();
+        assert(snap.runnerWorkers == 1 && snap.workersInUse >= 1 && snap.workersInUse <= 2);
+
+        std::cout << " AdaptiveScalerTest passed\n";
+    }
+};
+// ------------------------------------------
+// Intrusive queue test
+// ------------------------------------------
+class IntrusiveQueueTest {
+public:
+    struct Node {
+        int value = 0;
+        IntrusiveLink<Node> link;
+    };
+
+    static void run() {
+        std::cout << "[TEST] Intrusive queue..." << std::endl;
+
+        std::vector<Node> nodes(8);
+        for (int i = 0; i < 8; ++i) nodes[i].value = i;
+
+        // FIFO through single pushes and pops, with the high-water mark tracked
+        IntrusiveQueue<Node, &Node::link, NullLock> q;
+        assert(q.empty() && q.tryPop() == nullptr);
+        for (int i = 0; i < 3; ++i) q.push(&nodes[i]);
+        assert(q.size() == 3 && q.approxSize() == 3 && q.highWaterMark() == 3);
+        assert(q.tryPop()->value == 0);
+        q.push(&nodes[0]);
+        for (int expect : {1, 2, 0}) assert(q.tryPop()->value == expect);
+        assert(q.tryPop() == nullptr && q.highWaterMark() == 3);
+
+        // a batch is spliced in order behind what is queued; a bounded batch pop takes the oldest
+        q.push(&nodes[7]);
+        std::vector<Node*> batch{&nodes[3], &nodes[4], &nodes[5]};
+        q.pushBatch(batch);
+        std::vector<Node*> out;
+        assert(q.tryPopBatch(out, 2) == 2);
+        assert(out[0]->value == 7 && out[1]->value == 3 && q.size() == 2);
+        assert(q.tryPopBatch(out, 10) == 2 && out.size() == 4 && out[3]->value == 5);
+        assert(q.empty() && q.tryPopBatch(out, 10) == 0);
+
+        // drain detaches everything first, so the callback may requeue into the same queue
+        for (int i = 0; i < 4; ++i) q.push(&nodes[i]);
+        std::vector<int> seen;
+        assert(q.drain([&](Node* n) { seen.push_back(n->value); q.push(n); }) == 4);
+        assert((seen == std::vector<int>{0, 1, 2, 3}) && q.size() == 4);
+        q.clear();
+        q.resetHighWater();
+        assert(q.empty() && q.highWaterMark() == 0);
+
+        // concurrent producers and a consumer neither lose nor duplicate elements
+        const int perProducer = 20000;
+        std::vector<Node> many(4 * perProducer);
+        IntrusiveQueue<Node, &Node::link> shared;
+        std::vector<std::thread> producers;
+        for (int p = 0; p < 4; ++p) {
+            producers.emplace_back([&, p] {
+                for (int i = 0; i < perProducer; ++i) shared.push(&many[p * perProducer + i]);
+            });
+        }
+        std::vector<char> taken(many.size(), 0);
+        for (size_t got = 0; got < many.size(); ) {
+            if (Node* n = shared.tryPop()) {
+                taken[n - many.data()]++;
+                ++got;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        for (auto& t : producers) t.join();
+        assert(shared.empty());
+        for (char c : taken) assert(c == 1);
+
+        // the stage queues own no storage; the stages' scratch batches stop growing once the run is warm
+        MemoryTracker::ScopedEnable tracking;
+        auto& tracker = MemoryTracker::instance();
+        const MemSubsystem scratch[] = {MemSubsystem::RunnerScratch, MemSubsystem::DispatchScratch, MemSubsystem::ChargeTimers};
+        std::array<long long, 3> before{};
+        for (size_t i = 0; i < 3; ++i) before[i] = tracker.counts(scratch[i]).allocations;
+        Simulation sim(2, 0);
+        sim.setDeployment(std::make_unique<VehicleRandomDeployment>(40));
+        sim.runSimulation(std::chrono::seconds(3000));
+        for (size_t i = 0; i < 3; ++i) assert(tracker.counts(scratch[i]).allocations > before[i]);
+        assert(sim.steadyStateAllocations(MemSubsystem::RunnerScratch) == 0);
+        assert(sim.steadyStateAllocations(MemSubsystem::DispatchScratch) == 0);
+        assert(sim.snapshot().runQueueHighWater == 40);
+
+        std::cout << " IntrusiveQueueTest passed\n";
+    }
+};
+// ------------------------------------------
+// Station metrics test
+// ------------------------------------------
+class StationMetricsTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Station metrics..." << std::endl;
+
+        // 2 stations over 4 ticks: 5 busy station-ticks, one tick idle with a vehicle waiting
+        StationMetrics m;
+        m.reset(2);
+        m.sampleTick(2, 3);
+        m.sampleTick(2, 1);
+        m.sampleTick(1, 1);
+        m.sampleTick(0, 0);
+        for (std::uint64_t wait : {0, 2, 4, 10}) m.recordWait(wait);
+        m.recordCharge(3600);
+        m.recordCharge(1800);
+        StationReport r = m.report();
+        assert(r.stations == 2 && r.ticks == 4);
+        assert(r.utilizationPct == 62.5 && r.idleWhileQueuedPct == 25.0);
+        assert(r.waits == 4 && r.meanWaitSeconds == 4.0);
+        assert(r.p50WaitSeconds == 2 && r.maxWaitSeconds == 10 && r.p99WaitSeconds == 10);
+        assert(r.charges == 2 && r.meanChargeSeconds == 2700.0);
+        assert(r.chargesPerStationHour == 2 * 3600.0 / 8);
+        m.reset(2);
+        assert(m.report().ticks == 0 && m.report().waits == 0 && m.report().utilizationPct == 0);
+
+        // a contended pool keeps its stations busy; every acquire is a recorded wait in every mode
+        for (ExecutionMode mode : {ExecutionMode::Pipeline, ExecutionMode::Coroutines}) {
+            VehicleStatsManager::getInstance().resetAll();
+            Simulation sim(1, 0);
+            sim.setQuiet(true);
+            sim.setExecutionMode(mode);
+            sim.setDeployment(std::make_unique<VehicleRandomDeployment>(10));
+            sim.runSimulation(std::chrono::seconds(20000));
+            SimulationSnapshot snap = sim.snapshot();
+            const StationReport& st = snap.stationReport;
+            double charged = 0;
+            for (const auto& kv : snap.stats) charged += kv.second.totalChargedVehicle;
+            assert(st.stations == 1 && st.ticks == 20000);
+            assert(st.utilizationPct > 50 && st.utilizationPct <= 100);
+            assert(static_cast<double>(st.waits) == charged);
+            assert(st.charges > 0 && st.charges <= st.waits && st.chargesPerStationHour > 0);
+            assert(st.p50WaitSeconds <= st.p99WaitSeconds && st.p99WaitSeconds <= st.maxWaitSeconds);
+        }
+
+        std::cout << " StationMetricsTest passed\n";
+    }
+};
+// ------------------------------------------
+// Out-of-core fleet test
+// ------------------------------------------
+class OutOfCoreTest {
+public:
+    /** @brief Deploys built-in vehicles cycling through the kinds in id order. */
+    class CyclicDeployment : public VehicleDeployment {
+    public:
+        explicit CyclicDeployment(int count) : count(count) {}
+        std::vector<std::unique_ptr<Vehicle>> deployVehicles() override {
+            std::vector<std::unique_ptr<Vehicle>> result;
+            for (int i = 0; i < count; ++i) {
+                const size_t k = static_cast<size_t>(i) % kBuiltinVehicleKinds;
+                result.push_back(std::make_unique<Vehicle>(vehicleSpecs[k], static_cast<VehicleKind>(k)));
+            }
+            return result;
+        }
+    private:
+        int count;
+    };
+
+    static void run() {
+        std::cout << "[TEST] Out-of-core fleet..." << std::endl;
+        const TempPath fleetFile("fleet_test.bin");
+        const std::string& path = fleetFile.path;
+
+        // records persist through the mapping; the last chunk holds the remainder
+        {
+            FleetFile file = FleetFile::create(path, 1000, 256);
+            assert(file.isOpen() && file.size() == 1000 && file.chunkCount() == 4);
+            assert(file.chunk(0).size() == 256 && file.chunk(3).size() == 232);
+            file[999].due = 42;
+            file[999].kind = VehicleKind::Echo;
+            file.flush();
+        }
+        {
+            FleetFile file = FleetFile::open(path);
+            assert(file.isOpen() && file.chunkSize() == 256);
+            assert(file.chunk(3).back().due == 42 && file.chunk(3).back().kind == VehicleKind::Echo);
+        }
+
+        // with a station per vehicle nothing waits, so the lifecycle matches coroutine mode exactly
+        const int fleet = 600;
+        auto& stats = VehicleStatsManager::getInstance();
+        stats.resetAll();
+        Simulation sim(fleet, 0);
+        sim.setQuiet(true);
+        sim.setExecutionMode(ExecutionMode::Coroutines);
+        sim.setDeployment(std::make_unique<CyclicDeployment>(fleet));
+        sim.runSimulation(std::chrono::seconds(20000));
+        const auto inMemory = stats.snapshotAll();
+
+        stats.resetAll();
+        OutOfCoreConfig config;
+        config.path = path;
+        config.fleetSize = fleet;
+        config.stations = fleet;
+        config.duration = std::chrono::seconds(20000);
+        config.chunkRecords = 256;
+        config.kindOf = [](std::uint64_t id) { return static_cast<VehicleKind>(id % kBuiltinVehicleKinds); };
+        OutOfCoreSimulation outOfCore(config);
+        assert(outOfCore.run());
+        const auto streamed = stats.snapshotAll();
+        for (const auto& [type, expect] : inMemory) {
+            const VehicleStatsSnapshot& got = streamed.at(type);
+            assert(got.totalTestVehicle == expect.totalTestVehicle);
+            assert(got.totalChargedVehicle == expect.totalChargedVehicle);
+            assert(std::abs(got.totalTime - expect.totalTime) <= 1e-6 * expect.totalTime);
+            assert(std::abs(got.totalChargeTime - expect.totalChargeTime) <= 1e-6 * expect.totalChargeTime);
+            assert(std::abs(got.totalDistance - expect.totalDistance) <= 1e-6 * expect.totalDistance);
+        }
+
+        // chunks with nothing due are skipped, and only chunks with a phase change are written
+        const OutOfCoreStats& s = outOfCore.stats();
+        assert(s.ticks == 20000 && s.chunkScans + s.chunkSkips == 20000 * 3);
+        assert(s.chunkSkips > s.chunkScans && s.dirtyChunks == s.chunkScans);
+        assert(s.waitQueueHighWater <= static_cast<size_t>(fleet));
+        assert(outOfCore.stationReport().waits == static_cast<std::uint64_t>(streamed.at("Alpha").totalChargedVehicle
+            + streamed.at("Bravo").totalChargedVehicle + streamed.at("Charlie").totalChargedVehicle
+            + streamed.at("Dela").totalChargedVehicle + streamed.at("Echo").totalChargedVehicle));
+
+        // a contended pool queues ids, never more than the fleet
+        stats.resetAll();
+        config.stations = 2;
+        config.kindOf = nullptr;
+        OutOfCoreSimulation contended(config);
+        assert(contended.run());
+        assert(contended.stats().waitQueueHighWater > 0 && contended.stationReport().utilizationPct > 50);
+
+        std::cout << " OutOfCoreTest passed\n";
+    }
+};
+
+// ------------------------------------------
+// What-if branch test
+// ------------------------------------------
+class BranchTest {
+public:
+    static void run() {
+        std::cout << "[TEST] What-if branches..." << std::endl;
+
+        BranchSpec spec;
+        assert(BranchSpec::parse("Bravo+2,stations=3", spec));
+        assert(spec.stations == 3 && spec.addVehicles[static_cast<size_t>(VehicleKind::Bravo)] == 2);
+        assert(BranchSpec::parse("", spec) && spec.stations == -1 && spec.name == "baseline");
+        assert(!BranchSpec::parse("stations=x", spec));
+        assert(!BranchSpec::parse("Zulu+1", spec));
+
+        std::vector<BranchSpec> branches(3);
+        assert(BranchSpec::parse("", branches[0]));
+        assert(BranchSpec::parse("stations=4", branches[1]));
+        assert(BranchSpec::parse("Alpha+10", branches[2]));
+
+        // one contended station, so more stations must shorten the wait
+        auto& stats = VehicleStatsManager::getInstance();
+        stats.resetAll();
+        Simulation sim(1, 0);
+        sim.setDeployment(std::make_unique<OutOfCoreTest::CyclicDeployment>(20));
+        auto results = sim.runBranches(std::chrono::seconds(5000), std::chrono::seconds(20000), branches);
+        assert(results.size() == 3);
+        for (const auto& r : results) assert(r.ok && r.simulatedSeconds == 20000);
+        assert(results[0].stations == 1 && results[1].stations == 4 && results[2].stations == 1);
+        assert(results[0].vehicles == 20 && results[2].vehicles == 30);
+
+        // every branch includes the shared prefix: the baseline's waits are all there before the fork too
+        const StationReport& base = results[0].stationReport;
+        const StationReport& more = results[1].stationReport;
+        assert(base.waits > 0 && more.charges >= base.charges);
+        assert(more.meanWaitSeconds <= base.meanWaitSeconds);
+        assert(results[2].stats.at("Alpha").totalTestVehicle >= results[0].stats.at("Alpha").totalTestVehicle + 10);
+
+        // the parent stopped at the branch point
+        assert(sim.snapshot().simulatedSeconds == 5000);
+
+        std::ostringstream table;
+        printBranchResults(table, results);
+        assert(table.str().find("stations=4") != std::string::npos);
+
+        std::cout << " BranchTest passed\n";
+    }
+};
+
+// ------------------------------------------
+// Embeddable context test
+// ------------------------------------------
+class SimulationContextTest {
+public:
+    static double total(const SimulationResult& r, double VehicleStatsSnapshot::* field) {
+        double sum = 0;
+        for (const auto& kv : r.stats) sum += kv.second.*field;
+        return sum;
+    }
+
+    static void run() {
+        std::cout << "[TEST] Simulation context..." << std::endl;
+        const auto globalBefore = VehicleStatsManager::getInstance().snapshotAll();
+
+        // one worker keeps the dispatch order, and so the result, deterministic
+        SimulationConfig config;
+        config.stations = 2;
+        config.fleetSize = 30;
+        config.duration = std::chrono::seconds(5000);
+        config.cpuBudget = 1;
+        config.seed = 7;
+        SimulationContext ctx(config);
+        const SimulationResult first = ctx.run();
+        const SimulationResult again = ctx.run();
+        SimulationContext other(config);
+        const SimulationResult fresh = other.run();
+
+        // a rerun starts from a clean slate and matches a fresh context
+        assert(first.simulatedSeconds == 5000 && total(first, &VehicleStatsSnapshot::totalTestVehicle) >= 30);
+        for (const SimulationResult* r : {&again, &fresh}) {
+            assert(r->simulatedSeconds == first.simulatedSeconds);
+            assert(total(*r, &VehicleStatsSnapshot::totalTestVehicle) == total(first, &VehicleStatsSnapshot::totalTestVehicle));
+            assert(total(*r, &VehicleStatsSnapshot::totalChargedVehicle) == total(first, &VehicleStatsSnapshot::totalChargedVehicle));
+            assert(std::abs(total(*r, &VehicleStatsSnapshot::totalDistance) - total(first, &VehicleStatsSnapshot::totalDistance)) < 1e-6);
+            assert(r->stationReport.charges == first.stationReport.charges);
+        }
+
+        // reconfiguring the same context changes the next run only
+        config.stations = 30;
+        ctx.configure(config);
+        const SimulationResult& wide = ctx.run();
+        assert(wide.stationReport.stations == 30 && wide.stationReport.meanWaitSeconds <= first.stationReport.meanWaitSeconds);
+        assert(wide.stationReport.charges >= first.stationReport.charges);
+
+        ctx.reset();
+        assert(ctx.result().simulatedSeconds == 0 && ctx.result().stats.empty());
+        for (const auto& kv : ctx.stats().snapshotAll()) assert(kv.second.totalTestVehicle == 0);
+
+        // none of it reached the process-wide stats
+        const auto globalAfter = VehicleStatsManager::getInstance().snapshotAll();
+        for (const auto& [type, snap] : globalAfter) {
+            auto it = globalBefore.find(type);
+            const double before = it == globalBefore.end() ? 0 : it->second.totalTestVehicle;
+            assert(snap.totalTestVehicle == before);
+        }
+
+        std::cout << " SimulationContextTest passed\n";
+    }
+};
+
+// ------------------------------------------
+// Timeline tracing test
+// ------------------------------------------
+class TracingTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Timeline tracing..." << std::endl;
+        TraceRecorder& trace = TraceRecorder::instance();
+
+        // disabled spans record nothing
+        const size_t before = trace.eventCount();
+        { TraceSpan span("ignored", "test"); }
+        assert(trace.eventCount() == before);
+
+        // a full ring keeps the newest events of its thread
+        trace.enable(256);
+        std::thread writer([] {
+            TraceRecorder::setThreadName("trace test");
+            for (int i = 0; i < 1000; ++i) { TraceSpan span("test span", "test", i); }
+        });
+        writer.join();
+        assert(trace.droppedCount() >= 1000 - 256);
+
+        // the exited writer's ring goes to the next thread, whose events get their own track
+        const size_t rings = trace.ringCount();
+        std::thread reuser([] {
+            TraceRecorder::setThreadName("trace reuse");
+            TraceSpan span("reuse span", "test");
+        });
+        reuser.join();
+        assert(trace.ringCount() == rings);
+        trace.enable();
+
+        // a blocked acquire is a station wait
+        ChargeStationManager stations(1);
+        std::atomic<bool> stop{false};
+        stations.acquire(stop);
+        std::thread waiter([&] { stations.acquire(stop); stations.release(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        stations.release();
+        waiter.join();
+
+        // a pipeline run records stage, queue and stats spans
+        Simulation sim(1, 0);
+        sim.setQuiet(true);
+        sim.setDeployment(std::make_unique<OutOfCoreTest::CyclicDeployment>(20));
+        sim.runSimulation(std::chrono::seconds(5000));
+        trace.disable();
+
+        std::ostringstream json;
+        trace.writeChromeJson(json);
+        const std::string out = json.str();
+        assert(out.rfind("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", 0) == 0);
+        assert(out.find("]}") != std::string::npos);
+        for (const char* expect : {"\"trace test\"", "\"test span\"", "\"trace reuse\"", "\"reuse span\"",
+                                   "\"station wait\"", "\"runner chunk\"", "\"dispatch\"", "\"charger tick\"",
+                                   "\"queue drain\"", "\"queue pop batch\"", "\"stats batch\"", "\"ph\":\"X\""}) {
+            assert(out.find(expect) != std::string::npos);
+        }
+        assert(out.find("\"ignored\"") == std::string::npos);
+
+        trace.clear();
+        assert(trace.eventCount() == 0 && trace.droppedCount() == 0);
+        std::cout << " TracingTest passed\n";
+    }
+};
+// ------------------------------------------
+// Parameter sweep test
+// ------------------------------------------
+class ParameterSweepTest {
+public:
+    static void run() {
+        std::cout << "[TEST] Parameter sweep with result cache..." << std::endl;
+
+        TypeMix mix;
+        assert(TypeMix::parse("Alpha:3+Echo:1", mix));
+        assert(mix.weights[0] == 3 && mix.weights[4] == 1 && mix.weights[1] == 0);
+        assert(TypeMix::parse("uniform", mix) && mix.weights[2] == 1);
+        assert(!TypeMix::parse("Zulu:1", mix) && !TypeMix::parse("Alpha:0", mix) && !TypeMix::parse("Alpha", mix));
+
+        SweepGrid grid;
+        grid.duration = std::chrono::seconds(20000);
+        assert(SweepGrid::parse("stations=1,4;fleet=10,30;mix=uniform|Echo:1;seeds=7", grid));
+        assert(grid.points().size() == 8);
+        assert(!SweepGrid::parse("stations=0", grid) && !SweepGrid::parse("seeds=0", grid));
+        assert(!SweepGrid::parse("colour=red", grid) && grid.points().size() == 8);
+
+        // the key covers every input but the mix's label
+        SweepPoint a = grid.points()[0];
+        SweepPoint b = a;
+        b.mix.name = "renamed";
+        assert(a.key() == b.key());
+        b.seed = 8;
+        assert(a.key() != b.key());
+
+        const TempPath cacheFile("sweep_test.tsv");
+        const std::string& path = cacheFile.path;
+        std::vector<SweepRow> first;
+        {
+            SweepCache cache(path);
+            ParameterSweep sweep(grid, cache, 2);
+            first = sweep.run();
+            assert(sweep.summary().computed == 8 && sweep.summary().cached == 0);
+            assert(cache.writable() && cache.size() == 8);
+        }
+        for (const SweepRow& row : first) assert(!row.cached && row.metrics.runs > 0);
+        // more stations shorten the wait of the same fleet
+        assert(first[0].metrics.charges > 0 && first[0].metrics.meanWaitSeconds > first[4].metrics.meanWaitSeconds);
+
+        // a fresh run of a point reproduces its cached result
+        SimulationContext context;
+        const SweepMetrics again = ParameterSweep::simulate(first[3].point, context);
+        assert(again.runs == first[3].metrics.runs && again.charges == first[3].metrics.charges &&
+               again.passengerMiles == first[3].metrics.passengerMiles);
+
+        // reloaded from disk, an overlapping sweep computes only its new points
+        SweepGrid wider = grid;
+        assert(SweepGrid::parse("stations=1,2,4", wider));
+        SweepCache reloaded(path);
+        assert(reloaded.size() == 8);
+        ParameterSweep overlap(wider, reloaded, 2);
+        const auto& rows = overlap.run();
+        assert(rows.size() == 12 && overlap.summary().computed == 4 && overlap.summary().cached == 8);
+        for (const SweepRow& row : rows) {
+            assert(row.cached == (row.point.stations != 2));
+            if (row.point.stations != 1) continue;
+            const SweepRow& before = first[&row - &rows[0]];
+            assert(row.metrics.runs == before.metrics.runs && row.metrics.charges == before.metrics.charges &&
+                   row.metrics.meanWaitSeconds == before.metrics.meanWaitSeconds);
+        }
+
+        // a torn trailing record is skipped and the next append still parses
+        { std::ofstream torn(path, std::ios::app); torn << "deadbeef\tv1 stations=9"; }
+        {
+            SweepCache cache(path);
+            assert(cache.size() == 12);
+            SweepGrid one = grid;
+            assert(SweepGrid::parse("stations=9;fleet=5;mix=uniform", one));
+            ParameterSweep sweep(one, cache, 1);
+            sweep.run();
+            assert(sweep.summary().computed == 1);
+        }
+        assert(SweepCache(path).size() == 13);
+
+        std::ostringstream table;
+        printSweepTable(table, rows);
+        assert(table.str().find("Echo:1") != std::string::npos && table.str().find("cache") != std::string::npos);
+        std::cout << " ParameterSweepTest passed\n";
+    }
+};
+
+// ------------------------------------------
+// Cohort aggregation test
+// ------------------------------------------
+class CohortTest {
+public:
+    // runs the same fleet out of core and as cohorts, each into its own stats
+    static void compare(const OutOfCoreConfig& base, std::function<VehicleKind(std::uint64_t)> kindOf,
+                        CohortStats* cohortStats) {
+        VehicleStatsManager streamedStats, cohortStatsSink;
+        OutOfCoreConfig streamedConfig = base;
+        streamedConfig.kindOf = kindOf;
+        streamedConfig.stats = &streamedStats;
+        OutOfCoreSimulation outOfCore(streamedConfig);
+        assert(outOfCore.run());
+
+        CohortConfig config;
+        config.fleetSize = base.fleetSize;
+        config.stations = base.stations;
+        config.duration = base.duration;
+        config.kindOf = kindOf;
+        config.stats = &cohortStatsSink;
+        CohortSimulation cohorts(config);
+        cohorts.run();
+        *cohortStats = cohorts.stats();
+
+        const auto expect = streamedStats.snapshotAll();
+        const auto got = cohortStatsSink.snapshotAll();
+        assert(got.size() == expect.size());
+        for (const auto& [type, e] : expect) {
+            const VehicleStatsSnapshot& g = got.at(type);
+            assert(g.totalTestVehicle == e.totalTestVehicle && g.totalChargedVehicle == e.totalChargedVehicle);
+            assert(std::abs(g.totalTime - e.totalTime) <= 1e-9 * e.totalTime);
+            assert(std::abs(g.totalChargeTime - e.totalChargeTime) <= 1e-9 * e.totalChargeTime);
+            assert(std::abs(g.totalPassengersMiles - e.totalPassengersMiles) <= 1e-9 * e.totalPassengersMiles);
+            assert(g.runTime.count == e.runTime.count && g.chargeTime.count == e.chargeTime.count);
+            assert(std::abs(g.runTime.mean - e.runTime.mean) <= 1e-9 * e.runTime.mean);
+            assert(g.runTime.min == e.runTime.min && g.runTime.max == e.runTime.max);
+        }
+        const StationReport a = outOfCore.stationReport();
+        const StationReport b = cohorts.stationReport();
+        assert(a.ticks == b.ticks && a.charges == b.charges && a.waits == b.waits);
+        assert(a.utilizationPct == b.utilizationPct && a.idleWhileQueuedPct == b.idleWhileQueuedPct);
+        assert(a.meanWaitSeconds == b.meanWaitSeconds && a.p99WaitSeconds == b.p99WaitSeconds &&
+               a.maxWaitSeconds == b.maxWaitSeconds);
+    }
+
+    static void run() {
+        std::cout << "[TEST] Cohort aggregation..." << std::endl;
+
+        // a weighted record equals recording the same vehicle count times
+        RunningSummary repeated, weighted;
+        for (int i = 0; i < 7; ++i) repeated.add(2.5);
+        repeated.add(4);
+        weighted.addRepeated(2.5, 7);
+        weighted.addRepeated(4, 1);
+        weighted.addRepeated(9, 0);
+        assert(weighted.count == repeated.count && weighted.min == 2.5 && weighted.max == 4);
+        assert(std::abs(weighted.mean - repeated.mean) < 1e-12 && std::abs(weighted.m2 - repeated.m2) < 1e-9);
+
+        Vehicle v(vehicleSpecs[0], VehicleKind::Alpha);
+        v.runFor(30);
+        v.chargeFor(12);
+        VehicleStatsManager one, many;
+        for (int i = 0; i < 5; ++i) {
+            one.record("Alpha", v, StatType::TotalTime);
+            one.record("Alpha", v, StatType::TotalChargeTime);
+            one.record("Alpha", v, StatType::TotalChargeCycle);
+        }
+        many.recordWeighted("Alpha", v, StatType::TotalTime, 5);
+        many.recordWeighted("Alpha", v, StatType::TotalChargeTime, 5);
+        many.recordWeighted("Alpha", v, StatType::TotalChargeCycle, 5);
+        many.recordWeighted("Alpha", v, StatType::TotalTestVehicle, 0);
+        const VehicleStatsSnapshot a = one.snapshotAll().at("Alpha");
+        const VehicleStatsSnapshot b = many.snapshotAll().at("Alpha");
+        assert(a.totalChargedVehicle == b.totalChargedVehicle && a.runDistance.count == b.runDistance.count);
+        assert(std::abs(a.totalTime - b.totalTime) < 1e-9 && std::abs(a.totalDistance - b.totalDistance) < 1e-9);
+        assert(std::abs(a.totalChargeTime - b.totalChargeTime) < 1e-9 && a.totalFaults == b.totalFaults);
+
+        const TempPath fleetFile("cohort_test.bin");
+        OutOfCoreConfig base;
+        base.path = fleetFile.path;
+        base.duration = std::chrono::seconds(40000);
+        CohortStats s;
+
+        // a homogeneous, contended fleet: cohorts split at the stations and merge as phases line up
+        base.fleetSize = 400;
+        base.stations = 30;
+        compare(base, [](std::uint64_t) { return VehicleKind::Bravo; }, &s);
+        assert(s.splits > 0 && s.merges > 0 && s.ticks == 40000 && s.eventTicks < s.ticks);
+        assert(s.vehicleSteps > 10 * s.cohortSteps);
+
+        // a mixed fleet with a station per vehicle never splits: one cohort per kind
+        base.fleetSize = 600;
+        base.stations = 600;
+        compare(base, [](std::uint64_t id) { return static_cast<VehicleKind>(id % kBuiltinVehicleKinds); }, &s);
+        assert(s.splits == 0 && s.peakCohorts == kBuiltinVehicleKinds);
+        assert(s.vehicleSteps == 120 * s.cohortSteps);
+
+        // a mixed contended fleet: FIFO within a tick is by cohort, so only totals are comparable
+        CohortConfig config;
+        config.fleetSize = 5000;
+        config.stations = 40;
+        config.duration = std::chrono::seconds(30000);
+        VehicleStatsManager sink;
+        config.stats = &sink;
+        CohortSimulation mixed(config);
+        mixed.run();
+        const StationReport report = mixed.stationReport();
+        double runs = 0;
+        for (const auto& kv : sink.snapshotAll()) runs += kv.second.totalTestVehicle;
+        assert(runs >= 5000 && report.charges > 0 && report.utilizationPct > 90);
+        assert(mixed.stats().peakCohorts < 5000 / 10);
+        std::cout << " CohortTest passed\n";
+    }
+};
+// ------------------------------------------
 // Test Runner
 // ------------------------------------------
 int main() {
@@ -174,6 +1749,31 @@ int main() {
     FactoryTest::run();
     SimulationIntegrationTest::run();
     RunnerLogicTest::run();
+    VehicleKernelTest::run();
+    VehicleStatsSnapshotTest::run();
+    SimulationSnapshotTest::run();
+    TimingWheelTest::run();
+    ThreadPlacementTest::run();
+    CoroutineModeTest::run();
+    WorkerPoolTest::run();
+    MemoryTrackingTest::run();
+    MetricsServerTest::run();
+    CycleExportTest::run();
+    EnergyModelTest::run();
+    BoundedQueueTest::run();
+    ShardedSimulationTest::run();
+    BatchDispatchTest::run();
+    StatsMergeTest::run();
+    TickPacerTest::run();
+    AdaptiveScalerTest::run();
+    IntrusiveQueueTest::run();
+    StationMetricsTest::run();
+    OutOfCoreTest::run();
+    BranchTest::run();
+    SimulationContextTest::run();
+    TracingTest::run();
+    ParameterSweepTest::run();
+    CohortTest::run();
 
     std::cout << "\n All tests passed successfully!\n";
     return 0;